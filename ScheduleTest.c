@@ -674,8 +674,6 @@ void _lf_initialize_trigger_objects() {
     _lf_reaction_instances[3] = &(scheduletest_sink_self[0]->_lf__reaction_1);
     _lf_reaction_instances[4] = &(scheduletest_sink_self[0]->_lf__reaction_2);
 
-    bool reactor_reached_stop_tag[3] = { false };
-
     // Initialize the scheduler
     size_t num_reactions_per_level[3] = 
         {3, 1, 1};
@@ -683,9 +681,9 @@ void _lf_initialize_trigger_objects() {
         .num_reactions_per_level = &num_reactions_per_level[0],
         .num_reactions_per_level_size = (size_t) 3,
         .reactor_self_instances = &_lf_reactor_self_instances[0],
-        .num_reactor_self_instances = 3,
+        .num_reactor_self_instances = 4,
         .reaction_instances = _lf_reaction_instances,
-        .reactor_reached_stop_tag = &reactor_reached_stop_tag[0],
+        .num_reaction_instances = 5,
     };
     lf_sched_init(
         (size_t)_lf_number_of_workers,
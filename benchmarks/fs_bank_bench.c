@@ -0,0 +1,165 @@
+/**
+ * @file fs_bank_bench.c
+ * @brief Measure the size of the schedule file of a bank of identical
+ * reactors and how long the FS scheduler takes to load it, with the bank
+ * written as one template or as a copy per member.
+ *
+ * Each member of the bank has a reactor and `reactions` reactions of its own
+ * and is run by a worker of its own:
+ *
+ *  0: BIT  r + 3
+ *  1: EXE  0
+ *     ...
+ *  r: EXE  r - 1
+ *  r + 1: ADV2 0, period
+ *  r + 2: JMP  0
+ *  r + 3: STP
+ *
+ * As a template, every worker runs these very instructions, and the bases of
+ * member m select its reactions (m * r onwards) and its reactor (m). As
+ * copies, every worker has instructions of its own with the indices of the
+ * member's reactions and reactor in the operands, which is what a schedule
+ * file held before it had bases. Both load the same program, so they have
+ * the same fingerprint.
+ *
+ * Loading maps, checks, verifies, and decodes the file (see
+ * `lf_sched_init()`); the workers are not started.
+ *
+ * Usage: fs_bank_bench [template|copies] [members] [reactions]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "static_schedule_file.h"
+#include "util.h"
+
+#define FS_BANK_PERIOD MSEC(10)     // Logical time per hyperperiod.
+
+extern lf_mutex_t mutex;
+
+static void _fs_bank_reaction(void* self) {}
+
+/**
+ * @brief Write the instructions of one member, whose reactions start at
+ * `first_reaction` and whose reactor is `reactor`, to `s`.
+ */
+static void _fs_bank_member(inst_t* s, size_t reactions, size_t first_reaction, size_t reactor) {
+    s[0] = (inst_t) { .op = BIT, .rs1 = reactions + 3, .rs2 = -1 };
+    for (size_t i = 0; i < reactions; i++) {
+        s[1 + i] = (inst_t) { .op = EXE, .rs1 = first_reaction + i, .rs2 = -1 };
+    }
+    s[reactions + 1] = (inst_t) { .op = ADV2, .rs1 = reactor, .rs2 = FS_BANK_PERIOD };
+    s[reactions + 2] = (inst_t) { .op = JMP, .rs1 = 0, .rs2 = 1 };
+    s[reactions + 3] = (inst_t) { .op = STP, .rs1 = -1, .rs2 = -1 };
+}
+
+/** How the bank is written. */
+typedef struct {
+    bool template;
+    size_t reactions;   // Per member.
+} fs_bank_layout_t;
+
+/**
+ * @brief Write the schedule of member `m` in the layout `arg` points to (see
+ * `fs_bench_use_schedules()`). As a template, every member gets the
+ * instructions of member 0, which the file then holds once.
+ */
+static size_t _fs_bank_write_schedule(inst_t* s, size_t m, void* arg) {
+    const fs_bank_layout_t* layout = (const fs_bank_layout_t*)arg;
+    if (layout->template) {
+        _fs_bank_member(s, layout->reactions, 0, 0);
+    } else {
+        _fs_bank_member(s, layout->reactions, m * layout->reactions, m);
+    }
+    return layout->reactions + 4;
+}
+
+int main(int argc, const char* argv[]) {
+    bool template = argc <= 1 || strcmp(argv[1], "copies") != 0;
+    size_t members = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+    size_t reactions = argc > 3 ? strtoull(argv[3], NULL, 10) : 8;
+    if (members == 0 || reactions == 0) {
+        fprintf(stderr, "There must be at least one member with at least one reaction.\n");
+        return 1;
+    }
+
+    // With copies, the bases stay 0.
+    size_t* reaction_bases = calloc(members, sizeof(size_t));
+    size_t* reactor_bases = calloc(members, sizeof(size_t));
+    if (reaction_bases == NULL || reactor_bases == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t m = 0; template && m < members; m++) {
+        reaction_bases[m] = m * reactions;
+        reactor_bases[m] = m;
+    }
+    static_schedule_t schedule = {
+        .num_workers = members,
+        .reaction_bases = reaction_bases,
+        .reactor_bases = reactor_bases,
+        .num_counters = 0,
+        .num_reactions = members * reactions,
+        .num_reactors = members,
+        .wait_policy = WAIT_HYBRID,
+    };
+    fs_bank_layout_t layout = { .template = template, .reactions = reactions };
+    char* path = fs_bench_use_schedules(schedule, reactions + 4, _fs_bank_write_schedule, &layout);
+    free(reaction_bases);
+    free(reactor_bases);
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        lf_print_error_and_exit("Cannot read %s.", path);
+    }
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    size_t num_reactions = members * reactions;
+    self_base_t** reactors = calloc(members, sizeof(self_base_t*));
+    reaction_t** reaction_instances = calloc(num_reactions, sizeof(reaction_t*));
+    self_base_t* reactor_storage = calloc(members, sizeof(self_base_t));
+    reaction_t* reaction_storage = calloc(num_reactions, sizeof(reaction_t));
+    if (reactors == NULL || reaction_instances == NULL || reactor_storage == NULL || reaction_storage == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t m = 0; m < members; m++) {
+        reactors[m] = &reactor_storage[m];
+    }
+    for (size_t i = 0; i < num_reactions; i++) {
+        reaction_t* reaction = &reaction_storage[i];
+        reaction->function = _fs_bank_reaction;
+        reaction->self = reactors[i / reactions];
+        reaction->name = "bank_reaction";
+        reaction->status = inactive;
+        reaction->deadline = NEVER;
+        reaction_instances[i] = reaction;
+    }
+
+    lf_mutex_init(&mutex);
+    sched_params_t params = (sched_params_t) {
+        .reactor_self_instances = reactors,
+        .num_reactor_self_instances = members,
+        .reaction_instances = reaction_instances,
+        .num_reaction_instances = num_reactions,
+    };
+    instant_t start = lf_time_physical();
+    lf_sched_init(members, &params);
+    interval_t elapsed = lf_time_physical() - start;
+    unlink(path);
+    lf_sched_free();
+
+    printf("layout=%s members=%zu reactions=%zu file_bytes=%lld load_ms=%.3f\n",
+           template ? "template" : "copies", members, reactions, (long long)st.st_size, elapsed / 1e6);
+
+    free(reactor_storage);
+    free(reaction_storage);
+    free(path);
+    return 0;
+}
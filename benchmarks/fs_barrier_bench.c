@@ -0,0 +1,104 @@
+/**
+ * @file fs_barrier_bench.c
+ * @brief Measure how long the workers of the FS scheduler take to get
+ * through SAC.
+ *
+ * Every worker runs the same loop without reactions:
+ *
+ *  0: BIT  4
+ *  1: ADV2 w, period
+ *  2: SAC
+ *  3: JMP  0
+ *  4: STP
+ *
+ * so a hyperperiod is one SAC plus four cheap instructions per worker. The
+ * schedule is built at run time for the requested number of workers and
+ * loaded through a schedule file, like one given with `--schedule`.
+ * `scripts/bench_barrier.sh` runs it for a range of worker counts.
+ *
+ * Usage: fs_barrier_bench [workers] [hyperperiods] [spin|hybrid|block]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "static_schedule_file.h"
+#include "util.h"
+
+#define FS_BARRIER_PERIOD MSEC(10)      // Logical time per hyperperiod.
+#define FS_BARRIER_SCHEDULE_LENGTH 5
+
+/**
+ * @brief Write the schedule of worker `w` (see `fs_bench_use_schedules()`).
+ */
+static size_t _fs_barrier_write_schedule(inst_t* s, size_t w, void* arg) {
+    s[0] = (inst_t) { .op = BIT,  .rs1 = 4,     .rs2 = -1 };
+    s[1] = (inst_t) { .op = ADV2, .rs1 = w,     .rs2 = FS_BARRIER_PERIOD };
+    s[2] = (inst_t) { .op = SAC,  .rs1 = -1,    .rs2 = -1 };
+    s[3] = (inst_t) { .op = JMP,  .rs1 = 0,     .rs2 = 1 };
+    s[4] = (inst_t) { .op = STP,  .rs1 = -1,    .rs2 = -1 };
+    return FS_BARRIER_SCHEDULE_LENGTH;
+}
+
+int main(int argc, const char* argv[]) {
+    size_t num_workers = argc > 1 ? strtoull(argv[1], NULL, 10) : 4;
+    size_t hyperperiods = argc > 2 ? strtoull(argv[2], NULL, 10) : 100000;
+    const char* policy_name = argc > 3 ? argv[3] : "hybrid";
+    wait_policy_t policy;
+    if (strcmp(policy_name, "spin") == 0) {
+        policy = WAIT_SPIN;
+    } else if (strcmp(policy_name, "hybrid") == 0) {
+        policy = WAIT_HYBRID;
+    } else if (strcmp(policy_name, "block") == 0) {
+        policy = WAIT_BLOCK;
+    } else {
+        fprintf(stderr, "Usage: %s [workers] [hyperperiods] [spin|hybrid|block]\n", argv[0]);
+        return 1;
+    }
+    if (num_workers == 0) {
+        fprintf(stderr, "There must be at least one worker.\n");
+        return 1;
+    }
+
+    static_schedule_t schedule = {
+        .num_workers = num_workers,
+        .num_counters = 0,
+        .num_reactions = 0,
+        .num_reactors = num_workers,
+        .wait_policy = policy,
+    };
+    char* path = fs_bench_use_schedules(schedule, FS_BARRIER_SCHEDULE_LENGTH, _fs_barrier_write_schedule, NULL);
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    self_base_t** reactors = calloc(num_workers, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(1, sizeof(reaction_t*));
+    self_base_t* reactor_storage = calloc(num_workers, sizeof(self_base_t));
+    if (reactors == NULL || reactions == NULL || reactor_storage == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t w = 0; w < num_workers; w++) {
+        reactors[w] = &reactor_storage[w];
+    }
+
+    fs_bench_init(num_workers, reactors, num_workers, reactions, 0, hyperperiods * FS_BARRIER_PERIOD, false);
+    // The schedule is mapped now.
+    unlink(path);
+
+    interval_t elapsed = fs_bench_run_workers(num_workers, NULL);
+    lf_sched_free();
+
+    printf("policy=%s workers=%zu cores=%d hyperperiods=%zu elapsed_ms=%.3f ns_per_sac=%.2f\n",
+           policy_name, num_workers, lf_available_cores(), hyperperiods, elapsed / 1e6,
+           (double)elapsed / hyperperiods);
+
+    free(reactor_storage);
+    free(path);
+    return 0;
+}
@@ -0,0 +1,334 @@
+/**
+ * @file fs_bench.c
+ * @brief A harness for benchmarking the fully static (FS) scheduler.
+ *
+ * See fs_bench.h.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "util.h"
+#include "worker_placement.h"
+
+extern const inst_t* static_schedules[];
+extern lf_mutex_t mutex;
+
+////////////////////// Generated-code hooks //////////////////////
+// The runtime expects these to be provided by the generated program.
+
+void _lf_set_default_command_line_options(void) {}
+void _lf_initialize_trigger_objects(void) {}
+void _lf_trigger_startup_reactions(void) {}
+void _lf_initialize_timers(void) {}
+void logical_tag_complete(tag_t tag_to_send) {}
+bool _lf_trigger_shutdown_reactions(void) { return false; }
+void terminate_execution(void) {}
+
+#ifdef MODAL_REACTORS
+reactor_mode_state_t** fs_bench_mode_states = NULL;
+int fs_bench_num_mode_states = 0;
+
+void _lf_initialize_modes(void) {
+    _lf_initialize_mode_states(fs_bench_mode_states, fs_bench_num_mode_states);
+}
+
+void _lf_handle_mode_changes(void) {
+    _lf_process_mode_changes(fs_bench_mode_states, fs_bench_num_mode_states, NULL, 0, NULL, 0);
+}
+
+void _lf_handle_mode_triggered_reactions(void) {
+    _lf_handle_mode_startup_reset_reactions(NULL, 0, NULL, 0, fs_bench_mode_states, fs_bench_num_mode_states);
+}
+#endif
+
+////////////////////// Harness //////////////////////
+
+/** How long each reaction body busy-waits. */
+static interval_t _fs_bench_reaction_cost = 0;
+
+/** Reactions executed by each worker, or NULL. */
+static size_t* _fs_bench_reactions_by_worker;
+
+/** Reactions handed back to the worker loop by all workers. */
+static size_t _fs_bench_returns;
+
+/** Run-lists handed back to the worker loop by all workers. */
+static size_t _fs_bench_run_lists;
+
+/**
+ * Reactions executed by the current worker. Counted in the reaction body
+ * since superinstructions run reactions without returning them.
+ */
+static _Thread_local size_t _fs_bench_reactions_run;
+
+/**
+ * A reaction body that busy-waits for `_fs_bench_reaction_cost`.
+ */
+static void _fs_bench_reaction(void* self) {
+    _fs_bench_reactions_run++;
+    if (_fs_bench_reaction_cost <= 0) return;
+    instant_t until = lf_time_physical() + _fs_bench_reaction_cost;
+    while (lf_time_physical() < until);
+}
+
+/**
+ * The worker loop. Mirrors `_lf_worker_do_work()` without the deadline and
+ * STP handling.
+ */
+static void* _fs_bench_worker(void* arg) {
+    int worker_number = (int)(intptr_t)arg;
+    reaction_t* run_list[LF_SCHED_MAX_RUN_LIST];
+    size_t count;
+    size_t returns = 0;
+    size_t run_lists = 0;
+    lf_worker_place((size_t)worker_number);
+    _fs_bench_reactions_run = 0;
+    while ((count = lf_sched_get_ready_reactions(worker_number, run_list, LF_SCHED_MAX_RUN_LIST)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            run_list[i]->function(run_list[i]->self);
+        }
+        lf_sched_done_with_reactions(worker_number, run_list, count);
+        returns += count;
+        run_lists++;
+    }
+    if (_fs_bench_reactions_by_worker != NULL) {
+        _fs_bench_reactions_by_worker[worker_number] += _fs_bench_reactions_run;
+    }
+    __atomic_fetch_add(&_fs_bench_returns, returns, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&_fs_bench_run_lists, run_lists, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/**
+ * Walk one iteration of a worker's schedule loop, i.e., the instructions from
+ * pc 0 up to and including the JMP back to the head of the loop, assuming
+ * that BIT is not taken.
+ *
+ * @param schedule The worker's schedule.
+ * @param advance_by_reactor Accumulates the tag advancement of each reactor.
+ * @return The number of instructions in one iteration.
+ */
+static size_t _fs_bench_walk_loop(const inst_t* schedule, interval_t* advance_by_reactor) {
+    for (size_t pc = 0; ; pc++) {
+        switch (schedule[pc].op) {
+            case ADV:
+            case ADV2:
+                advance_by_reactor[schedule[pc].rs1] += schedule[pc].rs2;
+                break;
+            case JMP:
+                return pc + 1;
+            case STP:
+                lf_print_error_and_exit("Schedule reaches STP without looping.");
+            default:
+                break;
+        }
+    }
+}
+
+/**
+ * Count the instructions that a worker dispatches in one iteration of its
+ * schedule loop, in which a superinstruction counts once, like
+ * `_fs_bench_walk_loop()`.
+ */
+static size_t _fs_bench_dispatches_per_loop(const inst_t* schedule) {
+    size_t dispatches = 1;
+    for (size_t pc = 0; schedule[pc].op != JMP; pc++) {
+#if FS_FUSE
+        // The scheduler fuses the decoded program the same way. The loop
+        // ends with a JMP, so every instruction before it has a successor.
+        unsigned int next = schedule[pc + 1].op;
+        unsigned int after = next == JMP ? JMP : schedule[pc + 2].op;
+        pc += inst_length(inst_fuse(schedule[pc].op, next, after)) - 1;
+#endif
+        dispatches++;
+    }
+    return dispatches;
+}
+
+interval_t fs_bench_run_workers(size_t num_workers, size_t* reactions_by_worker) {
+    _fs_bench_reactions_by_worker = reactions_by_worker;
+    _fs_bench_returns = 0;
+    _fs_bench_run_lists = 0;
+    lf_thread_t* threads = malloc(num_workers * sizeof(lf_thread_t));
+    instant_t begin = lf_time_physical();
+    for (size_t i = 0; i < num_workers; i++) {
+        if (lf_thread_create(&threads[i], _fs_bench_worker, (void*)(intptr_t)i) != 0) {
+            lf_print_error_and_exit("Could not start worker %zu.", i);
+        }
+    }
+    for (size_t i = 0; i < num_workers; i++) {
+        lf_thread_join(threads[i], NULL);
+    }
+    instant_t end = lf_time_physical();
+    free(threads);
+    return end - begin;
+}
+
+void fs_bench_init(size_t num_workers, self_base_t** reactors, size_t num_reactors,
+                   reaction_t** reactions, size_t num_reactions, interval_t duration, bool in_real_time) {
+    lf_mutex_init(&mutex);
+    sched_params_t params = (sched_params_t) {
+        .reactor_self_instances = reactors,
+        .num_reactor_self_instances = num_reactors,
+        .reaction_instances = reactions,
+        .num_reaction_instances = num_reactions,
+    };
+    lf_sched_init(num_workers, &params);
+    // Before the start time, so that locking the memory does not delay the
+    // first release.
+    lf_worker_placement_init(num_workers);
+
+    // Start logical time now. Unless the run is in real time, put the
+    // physical start time so far back that every DU release is in the past.
+    start_time = lf_time_physical();
+    physical_start_time = in_real_time ? start_time : FS_BENCH_PHYSICAL_START_TIME;
+    stop_tag = (tag_t) { .time = start_time + duration - 1, .microstep = 0 };
+    // The second call initializes the reactor tags to the start time.
+    lf_sched_init(num_workers, NULL);
+}
+
+void fs_bench_run(size_t num_workers, size_t hyperperiods,
+                  interval_t reaction_cost, fs_bench_result_t* result) {
+    _fs_bench_reaction_cost = reaction_cost;
+    _fs_bench_reactions_by_worker = calloc(num_workers, sizeof(size_t));
+
+    // Count the instructions each worker executes: every loop iteration, plus
+    // the final (taken) BIT and the STP it branches to.
+    interval_t advance_by_reactor[FS_BENCH_NUM_REACTORS] = { 0 };
+    size_t instructions = 0;
+    size_t dispatches = 0;
+    for (size_t i = 0; i < num_workers; i++) {
+        instructions += hyperperiods * _fs_bench_walk_loop(static_schedules[i], advance_by_reactor) + 2;
+        dispatches += hyperperiods * _fs_bench_dispatches_per_loop(static_schedules[i]) + 2;
+    }
+
+    // Every reactor that is advanced at all must advance by the same amount
+    // per loop iteration; otherwise no stop tag ends all workers' loops at the
+    // same iteration.
+    interval_t loop_advance = 0;
+    for (size_t i = 0; i < FS_BENCH_NUM_REACTORS; i++) {
+        if (advance_by_reactor[i] == 0) continue;
+        if (loop_advance != 0 && advance_by_reactor[i] != loop_advance) {
+            lf_print_error_and_exit("Reactors advance by different amounts per loop iteration.");
+        }
+        loop_advance = advance_by_reactor[i];
+    }
+    if (loop_advance == 0) {
+        lf_print_error_and_exit("The schedule never advances any reactor.");
+    }
+
+    // Build the program.
+    self_base_t** reactors = calloc(FS_BENCH_NUM_REACTORS, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(FS_BENCH_NUM_REACTIONS, sizeof(reaction_t*));
+    for (size_t i = 0; i < FS_BENCH_NUM_REACTORS; i++) {
+        reactors[i] = calloc(1, sizeof(self_base_t));
+        // Reactors that are never advanced (e.g., main) do not hold up BIT.
+        reactors[i]->reached_stop_tag = (advance_by_reactor[i] == 0);
+    }
+    const int reactor_of_reaction[FS_BENCH_NUM_REACTIONS] = { 1, 2, 3, 3, 3 };
+    for (size_t i = 0; i < FS_BENCH_NUM_REACTIONS; i++) {
+        reactions[i] = calloc(1, sizeof(reaction_t));
+        reactions[i]->function = _fs_bench_reaction;
+        reactions[i]->self = reactors[reactor_of_reaction[i]];
+        reactions[i]->name = "bench_reaction";
+        reactions[i]->status = inactive;
+        reactions[i]->deadline = NEVER;
+    }
+
+    fs_bench_init(num_workers, reactors, FS_BENCH_NUM_REACTORS, reactions, FS_BENCH_NUM_REACTIONS,
+                  hyperperiods * loop_advance, false);
+
+    interval_t elapsed = fs_bench_run_workers(num_workers, _fs_bench_reactions_by_worker);
+
+    result->num_workers = num_workers;
+    result->hyperperiods = hyperperiods;
+    result->instructions = instructions;
+    result->dispatches = dispatches;
+    result->reactions = 0;
+    for (size_t i = 0; i < num_workers; i++) {
+        result->reactions += _fs_bench_reactions_by_worker[i];
+    }
+    result->returns = _fs_bench_returns;
+    result->run_lists = _fs_bench_run_lists;
+    result->elapsed = elapsed;
+
+    lf_sched_free();
+    free(_fs_bench_reactions_by_worker);
+    _fs_bench_reactions_by_worker = NULL;
+}
+
+char* fs_bench_use_schedule_file(const static_schedule_t* schedule) {
+    char* path = strdup("/tmp/fs_bench_schedule_XXXXXX");
+    if (path == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        lf_print_error_and_exit("Cannot create a temporary schedule file.");
+    }
+    close(fd);
+    const char* error;
+    if (static_schedule_write(path, schedule, &error) != 0) {
+        lf_print_error_and_exit("Cannot write %s: %s.", path, error);
+    }
+    static_schedule_file = path;
+    return path;
+}
+
+char* fs_bench_use_schedules(static_schedule_t schedule, size_t max_length,
+                             fs_bench_schedule_writer_t writer, void* arg) {
+    size_t num_workers = schedule.num_workers;
+    inst_t* instructions = calloc(num_workers * max_length, sizeof(inst_t));
+    const inst_t** schedules = calloc(num_workers, sizeof(inst_t*));
+    size_t* lengths = calloc(num_workers, sizeof(size_t));
+    if (instructions == NULL || schedules == NULL || lengths == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t w = 0; w < num_workers; w++) {
+        inst_t* s = &instructions[w * max_length];
+        lengths[w] = writer(s, w, arg);
+        schedules[w] = s;
+        if (w == 0 || lengths[w] != lengths[w - 1]) continue;
+        // Share the instructions of the worker before if they are the same.
+        const inst_t* previous = schedules[w - 1];
+        size_t pc = 0;
+        while (pc < lengths[w] && s[pc].op == previous[pc].op && s[pc].rs1 == previous[pc].rs1
+                && s[pc].rs2 == previous[pc].rs2) {
+            pc++;
+        }
+        if (pc == lengths[w]) schedules[w] = previous;
+    }
+    schedule.schedules = schedules;
+    schedule.schedule_lengths = lengths;
+    char* path = fs_bench_use_schedule_file(&schedule);
+    free(instructions);
+    free(schedules);
+    free(lengths);
+    return path;
+}
+
+void fs_bench_print_result(const char* label, const fs_bench_result_t* result) {
+    // Workers run concurrently, so normalize by the total worker time.
+    double worker_ns = (double)result->elapsed * result->num_workers;
+    printf("%s workers=%zu hyperperiods=%zu instructions=%zu dispatches=%zu reactions=%zu "
+           "returns=%zu run_lists=%zu elapsed_ms=%.3f ns_per_inst=%.2f ns_per_reaction=%.2f\n",
+           label,
+           result->num_workers,
+           result->hyperperiods,
+           result->instructions,
+           result->dispatches,
+           result->reactions,
+           result->returns,
+           result->run_lists,
+           result->elapsed / 1e6,
+           worker_ns / result->instructions,
+           result->reactions ? worker_ns / result->reactions : 0.0);
+}
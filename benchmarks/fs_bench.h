@@ -0,0 +1,174 @@
+/**
+ * @file fs_bench.h
+ * @brief A harness for benchmarking the fully static (FS) scheduler.
+ *
+ * The harness stands in for the code that the Lingua Franca compiler would
+ * generate: it provides the generated-code hooks the runtime links against
+ * and builds reaction and reactor tables with the layout assumed by
+ * `schedules/v*.c`:
+ *
+ * reaction array:
+ * [0=source.0, 1=source2.0, 2=sink.0, 3=sink.1, 4=sink.2]
+ *
+ * reactor array:
+ * [0=main, 1=source, 2=source2, 3=sink]
+ *
+ * It then drives the scheduler from one thread per worker, exactly like
+ * `_lf_worker_do_work()` (i.e., a run-list at a time), but with reaction
+ * bodies that only burn a fixed amount of time. Physical time is never waited
+ * on (DU releases are always in the past) so a run measures the scheduler
+ * itself.
+ *
+ * The scheduler instance can only be initialized once per process, so each
+ * benchmark executable performs a single run.
+ */
+#ifndef FS_BENCH_H
+#define FS_BENCH_H
+
+#include <stddef.h>
+
+#include "lf_types.h"
+#include "static_schedule_file.h"
+#include "tag.h"
+
+#define FS_BENCH_NUM_REACTIONS 5
+#define FS_BENCH_NUM_REACTORS 4
+
+/**
+ * @brief The physical start time that benchmarks run with.
+ *
+ * DU releases are offsets from the physical start time, and physical time
+ * counts from boot rather than from the epoch. A start time of 0 would put
+ * the releases of later iterations in the future on a machine that has not
+ * been up for long, so put it far enough in the past that no run reaches it.
+ */
+#define FS_BENCH_PHYSICAL_START_TIME (NEVER / 2)
+
+/**
+ * @brief The outcome of one benchmark run.
+ */
+typedef struct {
+    size_t      num_workers;
+    size_t      hyperperiods;   // Iterations of the schedule loop per worker.
+    size_t      instructions;   // Instructions executed by all workers.
+    size_t      dispatches;     // Instructions dispatched, counting a superinstruction once.
+    size_t      reactions;      // Reactions executed by all workers.
+    size_t      returns;        // Reactions handed back to the worker loop.
+    size_t      run_lists;      // Run-lists the reactions were handed back in.
+    interval_t  elapsed;        // Wall-clock duration of the run.
+} fs_bench_result_t;
+
+/**
+ * @brief Run the linked-in static schedule for a number of hyperperiods.
+ *
+ * The stop tag is chosen such that the BIT instruction at the head of every
+ * worker's loop branches to STP after exactly `hyperperiods` iterations.
+ *
+ * @param num_workers The number of workers (one schedule per worker).
+ * @param hyperperiods The number of iterations of the schedule loop.
+ * @param reaction_cost How long each reaction body busy-waits.
+ * @param result Where to store the measurements.
+ */
+void fs_bench_run(size_t num_workers, size_t hyperperiods,
+                  interval_t reaction_cost, fs_bench_result_t* result);
+
+/**
+ * @brief Run the scheduler on one thread per worker until every worker has
+ * reached STP.
+ *
+ * The scheduler must have been initialized with `lf_sched_init()`. This is
+ * what `fs_bench_run()` does after building the program, and it can be used
+ * by benchmarks that build programs of their own.
+ *
+ * @param num_workers The number of workers.
+ * @param reactions_by_worker If not NULL, an array in which the entry of each
+ *  worker is incremented for every harness reaction the worker executes,
+ *  including those run by superinstructions.
+ * @return The wall-clock duration of the run.
+ */
+interval_t fs_bench_run_workers(size_t num_workers, size_t* reactions_by_worker);
+
+/**
+ * @brief Write a set of schedules to a temporary file and have the scheduler
+ * load it as if it had been given with `--schedule`.
+ *
+ * Benchmarks whose schedules depend on their arguments (e.g., the number of
+ * workers) use this instead of a compiled-in schedule.
+ *
+ * @param schedule The schedules to write.
+ * @return The name of the file. The caller removes the file once the
+ *  scheduler is initialized and frees the name.
+ */
+char* fs_bench_use_schedule_file(const static_schedule_t* schedule);
+
+/**
+ * @brief Write the instructions of one worker for `fs_bench_use_schedules()`.
+ *
+ * @param s Room for the `max_length` instructions given to
+ *  `fs_bench_use_schedules()`.
+ * @param worker The worker.
+ * @param arg The argument given to `fs_bench_use_schedules()`.
+ * @return The number of instructions written.
+ */
+typedef size_t (*fs_bench_schedule_writer_t)(inst_t* s, size_t worker, void* arg);
+
+/**
+ * @brief Build the schedules of `schedule.num_workers` workers with `writer`
+ * and load them with `fs_bench_use_schedule_file()`.
+ *
+ * A worker whose instructions are the same as those of the worker before it
+ * shares them in the file, like the members of a bank written as one
+ * template.
+ *
+ * @param schedule Everything but the schedules and their lengths.
+ * @param max_length The most instructions that `writer` writes per worker.
+ * @param writer Called once for every worker.
+ * @param arg Passed to `writer`.
+ * @return The name of the file. The caller removes the file once the
+ *  scheduler is initialized and frees the name.
+ */
+char* fs_bench_use_schedules(static_schedule_t schedule, size_t max_length,
+                             fs_bench_schedule_writer_t writer, void* arg);
+
+/**
+ * @brief Initialize the scheduler for a program and start logical time, such
+ * that the BIT at the head of every worker's loop branches to STP once the
+ * reactors have advanced by `duration`.
+ *
+ * This is what `fs_bench_run()` does after building the program, and what
+ * `fs_bench_run_workers()` expects to have been done. The workers are placed
+ * as set with worker_placement.h.
+ *
+ * @param num_workers The number of workers.
+ * @param reactors The reactors, which `lf_sched_free()` frees the array of.
+ * @param num_reactors The number of reactors.
+ * @param reactions The reactions, which `lf_sched_free()` frees the array of.
+ * @param num_reactions The number of reactions.
+ * @param duration How far logical time runs.
+ * @param in_real_time If true, physical time starts with logical time, so DU
+ *  waits for its releases. Otherwise, the physical start time is
+ *  `FS_BENCH_PHYSICAL_START_TIME`, so every release is in the past.
+ */
+void fs_bench_init(size_t num_workers, self_base_t** reactors, size_t num_reactors,
+                   reaction_t** reactions, size_t num_reactions, interval_t duration, bool in_real_time);
+
+#ifdef MODAL_REACTORS
+/**
+ * @brief The mode states of the modal reactors, enclosing modes first, that
+ * the generated-code hooks for modes hand to the runtime. A benchmark with
+ * modal reactors sets them before it initializes the modes with
+ * `_lf_initialize_modes()`. None by default.
+ */
+extern reactor_mode_state_t** fs_bench_mode_states;
+extern int fs_bench_num_mode_states;
+#endif
+
+/**
+ * @brief Print a result as a single line of `key=value` pairs.
+ *
+ * @param label Printed at the start of the line (e.g., the schedule name).
+ * @param result The result to print.
+ */
+void fs_bench_print_result(const char* label, const fs_bench_result_t* result);
+
+#endif // FS_BENCH_H
@@ -0,0 +1,20 @@
+/**
+ * @file fs_bench_no_schedule.c
+ * @brief The compiled-in schedule of benchmarks that build their schedules at
+ * run time and load them from a schedule file (see
+ * `fs_bench_use_schedules()`).
+ *
+ * The runtime links against a compiled-in schedule, which these benchmarks
+ * never use.
+ */
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scheduler_instructions.h"
+
+const inst_t* static_schedules[1];
+const size_t schedule_lengths[1];
+const size_t num_schedules = 0;
+const size_t num_counters = 0;
+const wait_policy_t wait_policy = WAIT_HYBRID;
+volatile uint32_t hyperperiod_iterations[1];
@@ -0,0 +1,135 @@
+/**
+ * @file fs_context_bench.c
+ * @brief Measure how the FS scheduler scales with the number of workers when
+ * the workers share nothing but the cache lines of their execution contexts.
+ *
+ * Every worker runs a loop of its own, with a reaction and a reactor of its
+ * own, and never synchronizes with the others:
+ *
+ *  0: BIT  4
+ *  1: EXE  w
+ *  2: ADV2 w, period
+ *  3: JMP  0
+ *  4: STP
+ *
+ * The EXE hands the reaction back to the worker loop, so every hyperperiod
+ * writes the worker's pc, iteration, and epoch back to its context (see
+ * `lf_sched_worker_context_t`). The reactions and reactors are padded to
+ * cache lines of their own, so if the time per hyperperiod grows with the
+ * number of workers, it is because the contexts share lines. Build with
+ * -DFS_CONTEXT_ALIGNMENT=8 to pack the contexts into one array;
+ * `scripts/bench_context.sh` compares the two for a range of worker counts.
+ *
+ * The schedule is built at run time and loaded through a schedule file, like
+ * one given with `--schedule`.
+ *
+ * Usage: fs_context_bench [workers] [hyperperiods]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "static_schedule_file.h"
+#include "util.h"
+
+#define FS_CONTEXT_PERIOD MSEC(10)      // Logical time per hyperperiod.
+#define FS_CONTEXT_SCHEDULE_LENGTH 5
+#define FS_CONTEXT_PADDING 128          // What reactions and reactors are padded to.
+
+#ifdef FS_CONTEXT_ALIGNMENT
+#define FS_CONTEXT_STRINGIFY(x) #x
+#define FS_CONTEXT_TO_STRING(x) FS_CONTEXT_STRINGIFY(x)
+#define FS_CONTEXT_ALIGNMENT_NAME FS_CONTEXT_TO_STRING(FS_CONTEXT_ALIGNMENT)
+#else
+#define FS_CONTEXT_ALIGNMENT_NAME "default"
+#endif
+
+/** A reaction in cache lines of its own. */
+typedef struct {
+    _Alignas(FS_CONTEXT_PADDING) reaction_t reaction;
+} fs_context_reaction_t;
+
+/** A reactor in cache lines of its own. */
+typedef struct {
+    _Alignas(FS_CONTEXT_PADDING) self_base_t reactor;
+} fs_context_reactor_t;
+
+static void _fs_context_reaction(void* self) {}
+
+/**
+ * @brief Write the schedule of worker `w` (see `fs_bench_use_schedules()`).
+ */
+static size_t _fs_context_write_schedule(inst_t* s, size_t w, void* arg) {
+    s[0] = (inst_t) { .op = BIT,  .rs1 = 4,     .rs2 = -1 };
+    s[1] = (inst_t) { .op = EXE,  .rs1 = w,     .rs2 = -1 };
+    s[2] = (inst_t) { .op = ADV2, .rs1 = w,     .rs2 = FS_CONTEXT_PERIOD };
+    s[3] = (inst_t) { .op = JMP,  .rs1 = 0,     .rs2 = 1 };
+    s[4] = (inst_t) { .op = STP,  .rs1 = -1,    .rs2 = -1 };
+    return FS_CONTEXT_SCHEDULE_LENGTH;
+}
+
+int main(int argc, const char* argv[]) {
+    size_t num_workers = argc > 1 ? strtoull(argv[1], NULL, 10) : 4;
+    size_t hyperperiods = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000000;
+    if (num_workers == 0) {
+        fprintf(stderr, "There must be at least one worker.\n");
+        return 1;
+    }
+
+    static_schedule_t schedule = {
+        .num_workers = num_workers,
+        .num_counters = 0,
+        .num_reactions = num_workers,
+        .num_reactors = num_workers,
+        .wait_policy = WAIT_HYBRID,
+    };
+    char* path = fs_bench_use_schedules(schedule, FS_CONTEXT_SCHEDULE_LENGTH, _fs_context_write_schedule, NULL);
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    self_base_t** reactors = calloc(num_workers, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(num_workers, sizeof(reaction_t*));
+    fs_context_reactor_t* reactor_storage = aligned_alloc(_Alignof(fs_context_reactor_t),
+                                                          num_workers * sizeof(fs_context_reactor_t));
+    fs_context_reaction_t* reaction_storage = aligned_alloc(_Alignof(fs_context_reaction_t),
+                                                            num_workers * sizeof(fs_context_reaction_t));
+    if (reactors == NULL || reactions == NULL || reactor_storage == NULL || reaction_storage == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    memset(reactor_storage, 0, num_workers * sizeof(fs_context_reactor_t));
+    memset(reaction_storage, 0, num_workers * sizeof(fs_context_reaction_t));
+    for (size_t w = 0; w < num_workers; w++) {
+        reactors[w] = &reactor_storage[w].reactor;
+        reaction_t* reaction = &reaction_storage[w].reaction;
+        reaction->function = _fs_context_reaction;
+        reaction->self = reactors[w];
+        reaction->name = "context_reaction";
+        reaction->status = inactive;
+        reaction->deadline = NEVER;
+        reactions[w] = reaction;
+    }
+
+    fs_bench_init(num_workers, reactors, num_workers, reactions, num_workers, hyperperiods * FS_CONTEXT_PERIOD,
+                  false);
+    // The schedule is mapped now.
+    unlink(path);
+
+    interval_t elapsed = fs_bench_run_workers(num_workers, NULL);
+    lf_sched_free();
+
+    printf("context_alignment=%s workers=%zu cores=%d hyperperiods=%zu elapsed_ms=%.3f "
+           "ns_per_hyperperiod=%.2f\n",
+           FS_CONTEXT_ALIGNMENT_NAME, num_workers, lf_available_cores(), hyperperiods, elapsed / 1e6,
+           (double)elapsed / hyperperiods);
+
+    free(reactor_storage);
+    free(reaction_storage);
+    free(path);
+    return 0;
+}
@@ -0,0 +1,263 @@
+/**
+ * @file fs_counter_stress.c
+ * @brief Stress the counters of the FS scheduler with a pipeline that spans
+ * many workers.
+ *
+ * Each of `FS_STRESS_WORKERS` workers runs one stage of a pipeline per
+ * hyperperiod. Stage w waits (WU) until stage w - 1 has written its output
+ * port and incremented its counter (INC2), checks the whole port, and writes
+ * its own. All workers then increment a shared counter (INC) and wait until
+ * everybody has done so before they meet in SAC. The ports are plain memory,
+ * so a stage that sees a stale or partially written port means that the
+ * counters do not order memory as documented in scheduler_instructions.h.
+ * Every stage knows which values to expect, so the run is deterministic and
+ * any mismatch is counted as an error.
+ *
+ * With `pipelined`, the schedules have no SAC, and nobody waits on the
+ * shared counter. Instead, each stage waits until the next stage has read
+ * all of its earlier outputs before it writes its port again, so stages can
+ * be in different hyperperiods (epochs) at the same time. Since BIT then
+ * sees the stop tag only when the last stage gets there, earlier stages may
+ * run up to one hyperperiod per stage behind them past it.
+ *
+ * Build with -DFS_COUNTER_ALIGNMENT=8 to pack the counters instead of giving
+ * each its own cache line; `scripts/bench_counters.sh` compares the two.
+ *
+ * Usage: fs_counter_stress [hyperperiods] [pipelined]
+ *
+ * Exits with status 1 if any stage saw unexpected values.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "util.h"
+
+#define FS_STRESS_WORKERS 8
+#define FS_STRESS_PAYLOAD 32            // 64-bit words per port.
+#define FS_STRESS_PERIOD MSEC(10)       // Logical time per hyperperiod.
+#define FS_STRESS_SCHEDULE_LENGTH 10
+
+#ifdef FS_COUNTER_ALIGNMENT
+#define FS_STRESS_STRINGIFY(x) #x
+#define FS_STRESS_TO_STRING(x) FS_STRESS_STRINGIFY(x)
+#define FS_STRESS_COUNTER_ALIGNMENT FS_STRESS_TO_STRING(FS_COUNTER_ALIGNMENT)
+#else
+#define FS_STRESS_COUNTER_ALIGNMENT "cache_line"
+#endif
+
+/** The counter that every worker increments with INC. */
+#define FS_STRESS_SHARED_COUNTER (FS_STRESS_WORKERS + 1)
+
+/** The counter that stage w increments once it has read its input. */
+#define FS_STRESS_ACK_COUNTER(w) (FS_STRESS_WORKERS + 2 + (w))
+
+extern lf_mutex_t mutex;
+
+////////////////////// Schedule //////////////////////
+// Filled in by _fs_stress_build_schedules().
+
+static inst_t _fs_stress_schedules[FS_STRESS_WORKERS][FS_STRESS_SCHEDULE_LENGTH];
+
+const inst_t* static_schedules[FS_STRESS_WORKERS];
+
+const size_t schedule_lengths[] = {
+    FS_STRESS_SCHEDULE_LENGTH, FS_STRESS_SCHEDULE_LENGTH,
+    FS_STRESS_SCHEDULE_LENGTH, FS_STRESS_SCHEDULE_LENGTH,
+    FS_STRESS_SCHEDULE_LENGTH, FS_STRESS_SCHEDULE_LENGTH,
+    FS_STRESS_SCHEDULE_LENGTH, FS_STRESS_SCHEDULE_LENGTH,
+};
+
+_Static_assert(sizeof(schedule_lengths) / sizeof(schedule_lengths[0]) == FS_STRESS_WORKERS,
+               "There should be one schedule length per worker.");
+
+const size_t num_schedules = FS_STRESS_WORKERS;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
+volatile uint32_t hyperperiod_iterations[FS_STRESS_WORKERS];
+
+// Counter w (0 < w < FS_STRESS_WORKERS) signals that stage w - 1 is done.
+// Counter 0 is never incremented, and counter FS_STRESS_WORKERS is
+// incremented by the last stage but never waited on. The acknowledgements
+// of the pipelined schedule follow the shared counter; the last one is never
+// incremented.
+const size_t num_counters = 2 * FS_STRESS_WORKERS + 3;
+
+/**
+ * Build the schedule of every worker:
+ *
+ *  0: BIT  9                   Stop after the last hyperperiod.
+ *  1: WU   w, 1                Wait for the previous stage (not for stage 0).
+ *  2: EXE  w                   Run stage w.
+ *  3: INC2 w + 1, 1            Signal the next stage.
+ *  4: INC  shared, 1
+ *  5: WU   shared, workers     Wait until every stage has run.
+ *  6: ADV2 w, period
+ *  7: SAC
+ *  8: JMP  0
+ *  9: STP
+ *
+ * or, pipelined:
+ *
+ *  0: BIT  9
+ *  1: WU   w, 1                Wait for the previous stage (not for stage 0).
+ *  2: WU   ack w + 1, 0        Wait until the next stage has read every earlier output.
+ *  3: EXE  w
+ *  4: INC2 w + 1, 1
+ *  5: INC2 ack w, 1            Signal that the input has been read.
+ *  6: INC  shared, 1
+ *  7: ADV2 w, period
+ *  8: JMP  0
+ *  9: STP
+ */
+static void _fs_stress_build_schedules(bool pipelined) {
+    for (size_t w = 0; w < FS_STRESS_WORKERS; w++) {
+        inst_t* s = _fs_stress_schedules[w];
+        static_schedules[w] = s;
+        if (pipelined) {
+            s[0] = (inst_t) { .op = BIT,  .rs1 = 9,                              .rs2 = -1 };
+            s[1] = (inst_t) { .op = WU,   .rs1 = w,                              .rs2 = w > 0 ? 1 : 0 };
+            s[2] = (inst_t) { .op = WU,   .rs1 = FS_STRESS_ACK_COUNTER(w + 1),   .rs2 = 0 };
+            s[3] = (inst_t) { .op = EXE,  .rs1 = w,                              .rs2 = -1 };
+            s[4] = (inst_t) { .op = INC2, .rs1 = w + 1,                          .rs2 = 1 };
+            s[5] = (inst_t) { .op = INC2, .rs1 = FS_STRESS_ACK_COUNTER(w),       .rs2 = 1 };
+            s[6] = (inst_t) { .op = INC,  .rs1 = FS_STRESS_SHARED_COUNTER,       .rs2 = 1 };
+            s[7] = (inst_t) { .op = ADV2, .rs1 = w,                              .rs2 = FS_STRESS_PERIOD };
+            s[8] = (inst_t) { .op = JMP,  .rs1 = 0,                              .rs2 = 1 };
+            s[9] = (inst_t) { .op = STP,  .rs1 = -1,                             .rs2 = -1 };
+            continue;
+        }
+        s[0] = (inst_t) { .op = BIT,  .rs1 = 9,                          .rs2 = -1 };
+        s[1] = (inst_t) { .op = WU,   .rs1 = w,                          .rs2 = w > 0 ? 1 : 0 };
+        s[2] = (inst_t) { .op = EXE,  .rs1 = w,                          .rs2 = -1 };
+        s[3] = (inst_t) { .op = INC2, .rs1 = w + 1,                      .rs2 = 1 };
+        s[4] = (inst_t) { .op = INC,  .rs1 = FS_STRESS_SHARED_COUNTER,   .rs2 = 1 };
+        s[5] = (inst_t) { .op = WU,   .rs1 = FS_STRESS_SHARED_COUNTER,   .rs2 = FS_STRESS_WORKERS };
+        s[6] = (inst_t) { .op = ADV2, .rs1 = w,                          .rs2 = FS_STRESS_PERIOD };
+        s[7] = (inst_t) { .op = SAC,  .rs1 = -1,                         .rs2 = -1 };
+        s[8] = (inst_t) { .op = JMP,  .rs1 = 0,                          .rs2 = 1 };
+        s[9] = (inst_t) { .op = STP,  .rs1 = -1,                         .rs2 = -1 };
+    }
+}
+
+////////////////////// Stages //////////////////////
+
+typedef struct {
+    _Alignas(64) uint64_t values[FS_STRESS_PAYLOAD];
+} fs_stress_port_t;
+
+/** The reactor of a stage. */
+typedef struct {
+    self_base_t         base;           // Must come first.
+    size_t              stage;
+    uint64_t            executions;
+    const fs_stress_port_t* in;         // NULL for stage 0.
+    fs_stress_port_t*   out;
+    size_t              errors;
+} fs_stress_stage_t;
+
+/**
+ * Check the input port, if any, and write the output port.
+ *
+ * In execution i (from 0), stage 0 writes i + 1 + k to word k of its port,
+ * and every other stage writes what it read plus 1.
+ */
+static void _fs_stress_stage(void* self) {
+    fs_stress_stage_t* stage = self;
+    uint64_t value = stage->executions + 1;
+    if (stage->in != NULL) {
+        // Stage w receives the value of stage 0 plus w - 1.
+        uint64_t expected = value + stage->stage - 1;
+        for (size_t k = 0; k < FS_STRESS_PAYLOAD; k++) {
+            if (stage->in->values[k] != expected + k) {
+                stage->errors++;
+                break;
+            }
+        }
+        value = stage->in->values[0] + 1;
+    }
+    for (size_t k = 0; k < FS_STRESS_PAYLOAD; k++) {
+        stage->out->values[k] = value + k;
+    }
+    stage->executions++;
+}
+
+int main(int argc, const char* argv[]) {
+    size_t hyperperiods = 100000;
+    if (argc > 1) {
+        hyperperiods = strtoull(argv[1], NULL, 10);
+    }
+    bool pipelined = argc > 2 && strcmp(argv[2], "pipelined") == 0;
+    _fs_stress_build_schedules(pipelined);
+
+    fs_stress_port_t* ports = aligned_alloc(_Alignof(fs_stress_port_t),
+                                            FS_STRESS_WORKERS * sizeof(fs_stress_port_t));
+    // The scheduler frees these two arrays in lf_sched_free().
+    self_base_t** reactors = calloc(FS_STRESS_WORKERS, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(FS_STRESS_WORKERS, sizeof(reaction_t*));
+    fs_stress_stage_t* stages = calloc(FS_STRESS_WORKERS, sizeof(fs_stress_stage_t));
+    reaction_t* reaction_storage = calloc(FS_STRESS_WORKERS, sizeof(reaction_t));
+    if (ports == NULL || reactors == NULL || reactions == NULL
+            || stages == NULL || reaction_storage == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t w = 0; w < FS_STRESS_WORKERS; w++) {
+        stages[w].stage = w;
+        stages[w].in = w > 0 ? &ports[w - 1] : NULL;
+        stages[w].out = &ports[w];
+        reactors[w] = &stages[w].base;
+        reactions[w] = &reaction_storage[w];
+        reactions[w]->function = _fs_stress_stage;
+        reactions[w]->self = &stages[w];
+        reactions[w]->name = "stage";
+        reactions[w]->status = inactive;
+        reactions[w]->deadline = NEVER;
+    }
+
+    lf_mutex_init(&mutex);
+    sched_params_t params = (sched_params_t) {
+        .reactor_self_instances = reactors,
+        .num_reactor_self_instances = FS_STRESS_WORKERS,
+        .reaction_instances = reactions,
+        .num_reaction_instances = FS_STRESS_WORKERS,
+    };
+    lf_sched_init(FS_STRESS_WORKERS, &params);
+    start_time = lf_time_physical();
+    physical_start_time = FS_BENCH_PHYSICAL_START_TIME;
+    stop_tag = (tag_t) { .time = start_time + hyperperiods * FS_STRESS_PERIOD - 1, .microstep = 0 };
+    // The second call initializes the reactor tags to the start time.
+    lf_sched_init(FS_STRESS_WORKERS, NULL);
+
+    interval_t elapsed = fs_bench_run_workers(FS_STRESS_WORKERS, NULL);
+    lf_sched_free();
+
+    size_t errors = 0;
+    for (size_t w = 0; w < FS_STRESS_WORKERS; w++) {
+        errors += stages[w].errors;
+        // Pipelined, stage w may run ahead of the last stage by one
+        // hyperperiod per stage in between.
+        size_t max_executions = hyperperiods + (pipelined ? FS_STRESS_WORKERS - 1 - w : 0);
+        if (stages[w].executions < hyperperiods || stages[w].executions > max_executions) {
+            lf_print_error("Stage %zu ran %llu times instead of %zu.",
+                           w, (unsigned long long)stages[w].executions, hyperperiods);
+            errors++;
+        }
+    }
+    printf("counter_alignment=%s mode=%s workers=%d hyperperiods=%zu elapsed_ms=%.3f "
+           "ns_per_hyperperiod=%.2f errors=%zu\n",
+           FS_STRESS_COUNTER_ALIGNMENT, pipelined ? "pipelined" : "sac", FS_STRESS_WORKERS,
+           hyperperiods, elapsed / 1e6, (double)elapsed / hyperperiods, errors);
+
+    free(ports);
+    free(stages);
+    free(reaction_storage);
+    return errors == 0 ? 0 : 1;
+}
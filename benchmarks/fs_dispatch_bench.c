@@ -0,0 +1,45 @@
+/**
+ * @file fs_dispatch_bench.c
+ * @brief Measure the dispatch cost of the FS scheduler VM.
+ *
+ * Runs the linked-in schedule with empty reactions and reports the time per
+ * executed instruction. Build once with the default switch-based engine and
+ * once with -DFS_THREADED_DISPATCH=1 to compare the two;
+ * `scripts/bench_dispatch.sh` does both for every `schedules/v*.c`.
+ * `scripts/bench_fusion.sh` likewise compares builds with and without
+ * superinstructions (-DFS_FUSE=0), and `scripts/bench_compiled.sh` compares
+ * the interpreter with schedules compiled to C (-DFS_COMPILED=ON), which run
+ * every reaction without returning it to the worker loop.
+ *
+ * Usage: fs_dispatch_bench_vN [hyperperiods]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "fs_bench.h"
+#include "scheduler_instructions.h"
+
+#if defined(FS_COMPILED)
+#define ENGINE "compiled"
+#elif defined(FS_THREADED_DISPATCH)
+#define ENGINE "threaded"
+#else
+#define ENGINE "switch"
+#endif
+
+#if FS_FUSE
+#define FUSE "1"
+#else
+#define FUSE "0"
+#endif
+
+int main(int argc, const char* argv[]) {
+    size_t hyperperiods = 100000;
+    if (argc > 1) {
+        hyperperiods = strtoull(argv[1], NULL, 10);
+    }
+    fs_bench_result_t result;
+    fs_bench_run(NUMBER_OF_WORKERS, hyperperiods, 0, &result);
+    fs_bench_print_result("engine=" ENGINE " fuse=" FUSE " schedule=" FS_BENCH_SCHEDULE, &result);
+    return 0;
+}
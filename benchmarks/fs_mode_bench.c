@@ -0,0 +1,281 @@
+/**
+ * @file fs_mode_bench.c
+ * @brief Measure what the reactions of inactive modes cost the FS scheduler
+ * with a segment per mode behind BNM, compared with polling every reaction
+ * with EIT, and check that mode transitions take effect at the next
+ * hyperperiod.
+ *
+ * Every worker has a modal reactor of its own with `modes` modes of
+ * `reactions` reactions each, and a controller reaction outside the modes
+ * that requests a transition to the next mode every `switch every`
+ * hyperperiods. With `bnm`, each mode is a segment that BNM skips while the
+ * mode is inactive:
+ *
+ *  0: BIT  n
+ *  1: BNM  k + 1, (0, 0)         for every mode m:
+ *  2: EXE  (0, 0)                  BNM past the segment, (m, 0)
+ *  .: EXE  (0, 1)                  EXE (m, r)     for every reaction r
+ *  .: ...
+ *  k: EXE  controller
+ *  .: ADV2 w, period
+ *  .: SAC
+ *  .: JMP  0, 1
+ *  n: STP
+ *
+ * With `eit`, the controller runs first and triggers all reactions of its
+ * reactor through an output, and the runtime suppresses those of inactive
+ * modes, as with the dynamic schedulers. The schedule polls every reaction
+ * with EIT.
+ *
+ * No DU waits for physical time, so the benchmark reports how long a
+ * hyperperiod takes. It also checks that the mode reactions run once per
+ * hyperperiod and reaction of one mode, and counts the runs in a hyperperiod
+ * where their reactor is not in the mode it should be in, given that a
+ * transition requested in hyperperiod h applies from h + 1 on. Both variants
+ * must have none.
+ *
+ * Needs MODAL_REACTORS.
+ *
+ * Usage: fs_mode_bench [bnm|eit] [workers] [hyperperiods] [modes] [reactions] [switch every]
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "util.h"
+
+#define FS_MODE_PERIOD MSEC(1)
+
+void _lf_trigger_reaction(reaction_t* reaction, int worker_number);
+
+/** The shape of the program. */
+static size_t _fs_mode_num_modes;
+static size_t _fs_mode_reactions_per_mode;
+static size_t _fs_mode_switch_every;
+static bool _fs_mode_poll;
+
+/** A reactor per worker, with its modes. */
+static self_base_t* _fs_mode_reactors;
+static reactor_mode_t* _fs_mode_modes;
+
+/**
+ * Reactions run, reactions run outside the mode that should be active, and
+ * transitions requested, by reactor. Only the reactor's worker writes them.
+ */
+static size_t* _fs_mode_runs;
+static size_t* _fs_mode_wrong;
+static size_t* _fs_mode_transitions;
+
+/**
+ * The output of each controller, which triggers its mode reactions. It is
+ * never present (see `_fs_mode_controller()`).
+ */
+static bool _fs_mode_absent;
+static bool* _fs_mode_produced = &_fs_mode_absent;
+static trigger_t** _fs_mode_outputs;
+
+/** The reactions of each reactor: those of the modes, then the controller. */
+static size_t _fs_mode_reactions_per_reactor() {
+    return _fs_mode_num_modes * _fs_mode_reactions_per_mode + 1;
+}
+
+/** The hyperperiod that a reactor is in. */
+static size_t _fs_mode_hyperperiod(self_base_t* reactor) {
+    return (size_t)((atomic_load_explicit(&reactor->tag_time, memory_order_relaxed) - start_time) / FS_MODE_PERIOD);
+}
+
+/** The mode a reactor is in. */
+static size_t _fs_mode_current(self_base_t* reactor) {
+    return reactor->_lf__mode_state.current_mode - &_fs_mode_modes[(reactor - _fs_mode_reactors) * _fs_mode_num_modes];
+}
+
+static void _fs_mode_reaction(void* self) {
+    self_base_t* reactor = (self_base_t*)self;
+    size_t r = reactor - _fs_mode_reactors;
+    size_t expected = _fs_mode_hyperperiod(reactor) / _fs_mode_switch_every % _fs_mode_num_modes;
+    _fs_mode_runs[r]++;
+    if (_fs_mode_current(reactor) != expected) _fs_mode_wrong[r]++;
+}
+
+static void _fs_mode_controller(void* self) {
+    self_base_t* reactor = (self_base_t*)self;
+    size_t r = reactor - _fs_mode_reactors;
+    if (_fs_mode_poll) {
+        // What setting the output does once the reaction returns. The benchmark
+        // workers call reactions directly, without that, so the controller does
+        // it itself and leaves the output absent, so that a fused EXE, which
+        // does it, does not do it again.
+        trigger_t* output = _fs_mode_outputs[r];
+        for (int i = 0; i < output->number_of_reactions; i++) {
+            _lf_trigger_reaction(output->reactions[i], (int)r);
+        }
+    }
+    if (_fs_mode_hyperperiod(reactor) % _fs_mode_switch_every == _fs_mode_switch_every - 1) {
+        reactor_mode_t* modes = &_fs_mode_modes[r * _fs_mode_num_modes];
+        // What _LF_SET_MODE does.
+        reactor->_lf__mode_state.next_mode = &modes[(_fs_mode_current(reactor) + 1) % _fs_mode_num_modes];
+        reactor->_lf__mode_state.mode_change = reset_transition;
+        _fs_mode_transitions[r]++;
+    }
+}
+
+/**
+ * @brief Write the schedule of worker `w` (see `fs_bench_use_schedules()`).
+ */
+static size_t _fs_mode_write_schedule(inst_t* s, size_t w, void* arg) {
+    size_t per_reactor = _fs_mode_reactions_per_reactor();
+    long long int first = w * per_reactor;
+    long long int controller = first + per_reactor - 1;
+    size_t n = 1;
+    if (_fs_mode_poll) {
+        s[n++] = (inst_t) { .op = EXE, .rs1 = controller, .rs2 = -1 };
+    }
+    for (size_t m = 0; m < _fs_mode_num_modes; m++) {
+        long long int mode_first = first + m * _fs_mode_reactions_per_mode;
+        if (!_fs_mode_poll) {
+            long long int next = n + 1 + _fs_mode_reactions_per_mode;
+            s[n++] = (inst_t) { .op = BNM, .rs1 = next, .rs2 = mode_first };
+        }
+        for (size_t i = 0; i < _fs_mode_reactions_per_mode; i++) {
+            s[n++] = (inst_t) { .op = _fs_mode_poll ? EIT : EXE, .rs1 = mode_first + i, .rs2 = -1 };
+        }
+    }
+    if (!_fs_mode_poll) {
+        s[n++] = (inst_t) { .op = EXE, .rs1 = controller, .rs2 = -1 };
+    }
+    s[n++] = (inst_t) { .op = ADV2, .rs1 = w,           .rs2 = FS_MODE_PERIOD };
+    s[n++] = (inst_t) { .op = SAC,  .rs1 = -1,          .rs2 = -1 };
+    s[n++] = (inst_t) { .op = JMP,  .rs1 = 0,           .rs2 = 1 };
+    s[0] = (inst_t) { .op = BIT,    .rs1 = n,           .rs2 = -1 };
+    s[n++] = (inst_t) { .op = STP,  .rs1 = -1,          .rs2 = -1 };
+    return n;
+}
+
+int main(int argc, const char* argv[]) {
+    const char* variant = argc > 1 ? argv[1] : "bnm";
+    size_t num_workers = argc > 2 ? strtoull(argv[2], NULL, 10) : 1;
+    size_t hyperperiods = argc > 3 ? strtoull(argv[3], NULL, 10) : 100000;
+    _fs_mode_num_modes = argc > 4 ? strtoull(argv[4], NULL, 10) : 4;
+    _fs_mode_reactions_per_mode = argc > 5 ? strtoull(argv[5], NULL, 10) : 8;
+    _fs_mode_switch_every = argc > 6 ? strtoull(argv[6], NULL, 10) : 10;
+    _fs_mode_poll = strcmp(variant, "eit") == 0;
+    if ((!_fs_mode_poll && strcmp(variant, "bnm") != 0) || num_workers == 0 || _fs_mode_num_modes == 0
+            || _fs_mode_reactions_per_mode == 0 || _fs_mode_switch_every == 0) {
+        fprintf(stderr, "Usage: %s [bnm|eit] [workers] [hyperperiods] [modes] [reactions] [switch every]\n",
+                argv[0]);
+        return 1;
+    }
+
+    size_t per_reactor = _fs_mode_reactions_per_reactor();
+    static_schedule_t schedule = {
+        .num_workers = num_workers,
+        .num_counters = 0,
+        .num_reactions = num_workers * per_reactor,
+        .num_reactors = num_workers,
+        .wait_policy = WAIT_HYBRID,
+    };
+    char* path = fs_bench_use_schedules(schedule, per_reactor + _fs_mode_num_modes + 6, _fs_mode_write_schedule,
+                                        NULL);
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    size_t num_reactions = num_workers * per_reactor;
+    self_base_t** reactors = calloc(num_workers, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(num_reactions, sizeof(reaction_t*));
+    _fs_mode_reactors = calloc(num_workers, sizeof(self_base_t));
+    _fs_mode_modes = calloc(num_workers * _fs_mode_num_modes, sizeof(reactor_mode_t));
+    reaction_t* reaction_storage = calloc(num_reactions, sizeof(reaction_t));
+    trigger_t* outputs = calloc(num_workers, sizeof(trigger_t));
+    _fs_mode_outputs = calloc(num_workers, sizeof(trigger_t*));
+    trigger_t*** output_arrays = calloc(num_workers, sizeof(trigger_t**));
+    int* triggered_sizes = calloc(num_workers, sizeof(int));
+    reactor_mode_state_t** states = calloc(num_workers, sizeof(reactor_mode_state_t*));
+    _fs_mode_runs = calloc(num_workers, sizeof(size_t));
+    _fs_mode_wrong = calloc(num_workers, sizeof(size_t));
+    _fs_mode_transitions = calloc(num_workers, sizeof(size_t));
+    if (reactors == NULL || reactions == NULL || _fs_mode_reactors == NULL || _fs_mode_modes == NULL
+            || reaction_storage == NULL || outputs == NULL || _fs_mode_outputs == NULL || output_arrays == NULL
+            || triggered_sizes == NULL || states == NULL || _fs_mode_runs == NULL || _fs_mode_wrong == NULL
+            || _fs_mode_transitions == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t r = 0; r < num_workers; r++) {
+        self_base_t* reactor = &_fs_mode_reactors[r];
+        reactor_mode_t* modes = &_fs_mode_modes[r * _fs_mode_num_modes];
+        for (size_t m = 0; m < _fs_mode_num_modes; m++) {
+            modes[m] = (reactor_mode_t) { .state = &reactor->_lf__mode_state, .name = "mode" };
+        }
+        reactor->_lf__mode_state = (reactor_mode_state_t) {
+            .initial_mode = &modes[0],
+            .current_mode = &modes[0],
+            .mode_change = no_transition,
+        };
+        states[r] = &reactor->_lf__mode_state;
+        reactors[r] = reactor;
+        for (size_t i = 0; i < per_reactor; i++) {
+            reaction_t* reaction = &reaction_storage[r * per_reactor + i];
+            bool controller = i == per_reactor - 1;
+            reaction->function = controller ? _fs_mode_controller : _fs_mode_reaction;
+            reaction->self = reactor;
+            reaction->name = controller ? "controller" : "mode_reaction";
+            reaction->status = inactive;
+            reaction->deadline = NEVER;
+            reaction->mode = controller ? NULL : &modes[i / _fs_mode_reactions_per_mode];
+            reactions[r * per_reactor + i] = reaction;
+        }
+        reaction_t* controller = reactions[r * per_reactor + per_reactor - 1];
+        outputs[r].reactions = &reactions[r * per_reactor];
+        outputs[r].number_of_reactions = (int)(per_reactor - 1);
+        _fs_mode_outputs[r] = &outputs[r];
+        output_arrays[r] = &_fs_mode_outputs[r];
+        triggered_sizes[r] = 1;
+        controller->num_outputs = 1;
+        controller->output_produced = &_fs_mode_produced;
+        controller->triggered_sizes = &triggered_sizes[r];
+        controller->triggers = &output_arrays[r];
+    }
+    fs_bench_mode_states = states;
+    fs_bench_num_mode_states = (int)num_workers;
+    _lf_initialize_modes();
+
+    fs_bench_init(num_workers, reactors, num_workers, reactions, num_reactions, hyperperiods * FS_MODE_PERIOD,
+                  true);
+
+    interval_t elapsed = fs_bench_run_workers(num_workers, NULL);
+    lf_sched_free();
+
+    size_t runs = 0, wrong = 0, transitions = 0;
+    for (size_t r = 0; r < num_workers; r++) {
+        runs += _fs_mode_runs[r];
+        wrong += _fs_mode_wrong[r];
+        transitions += _fs_mode_transitions[r];
+    }
+    printf("variant=%s workers=%zu hyperperiods=%zu modes=%zu reactions_per_mode=%zu switch_every=%zu "
+           "elapsed_ms=%.3f ns_per_hyperperiod=%.1f runs=%zu expected_runs=%zu wrong_mode_runs=%zu "
+           "transitions=%zu\n",
+           variant, num_workers, hyperperiods, _fs_mode_num_modes, _fs_mode_reactions_per_mode,
+           _fs_mode_switch_every, elapsed / 1e6, (double)elapsed / hyperperiods, runs,
+           num_workers * hyperperiods * _fs_mode_reactions_per_mode, wrong, transitions);
+
+    free(_fs_mode_reactors);
+    free(_fs_mode_modes);
+    free(reaction_storage);
+    free(outputs);
+    free(_fs_mode_outputs);
+    free(output_arrays);
+    free(triggered_sizes);
+    free(states);
+    free(_fs_mode_runs);
+    free(_fs_mode_wrong);
+    free(_fs_mode_transitions);
+    unlink(path);
+    free(path);
+    return wrong == 0 ? 0 : 1;
+}
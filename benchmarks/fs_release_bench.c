@@ -0,0 +1,163 @@
+/**
+ * @file fs_release_bench.c
+ * @brief Measure how precisely DU releases the workers of the FS scheduler.
+ *
+ * Every worker runs the same periodic loop without reactions:
+ *
+ *  0: BIT  5
+ *  1: DU   period
+ *  2: ADV2 w, period
+ *  3: SAC
+ *  4: JMP  0
+ *  5: STP
+ *
+ * with the physical start time set to the start of the run, so release i
+ * (from 1) is due i periods after the start. The benchmark reports how far
+ * the end of the run is from the last release, which grows if releases
+ * drift. Build with -DFS_RELEASE_STATS=1 for a lateness histogram per worker,
+ * and with -DFS_DU_SPIN_NS=<ns> to spin before each release;
+ * `scripts/bench_release.sh` compares sleeping with spinning.
+ *
+ * With a background job cost, the workers are kept busy with background jobs
+ * that busy-wait for that long (see scheduler_background.h), and the
+ * benchmark also reports how much of the slack before the releases they
+ * reclaimed. `scripts/bench_background.sh` compares the lateness with and
+ * without them.
+ *
+ * The workers can be placed as with the runtime options (see
+ * worker_placement.h): pinned to a list of CPUs, which the schedule file
+ * records, or "-" for none; at a real-time priority, or 0; and with the
+ * memory locked (1) or not (0). `scripts/bench_placement.sh` compares the
+ * lateness with and without placement.
+ *
+ * Usage: fs_release_bench [workers] [hyperperiods] [period in us] [background job in us]
+ *                         [cpus] [priority] [lock memory]
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_background.h"
+#include "scheduler_instructions.h"
+#include "util.h"
+#include "worker_placement.h"
+
+#define FS_RELEASE_SCHEDULE_LENGTH 6
+
+/** How long each background job busy-waits. */
+static interval_t _fs_release_job_cost;
+
+/**
+ * A background job that busy-waits for `_fs_release_job_cost` and submits
+ * itself again, so that the queue never runs dry.
+ */
+static void _fs_release_job(void* arg) {
+    instant_t until = lf_time_physical() + _fs_release_job_cost;
+    while (lf_time_physical() < until);
+    lf_sched_submit_background(_fs_release_job, arg, _fs_release_job_cost);
+}
+
+/**
+ * @brief Write the schedule of worker `w`, whose period `arg` points to (see
+ * `fs_bench_use_schedules()`).
+ */
+static size_t _fs_release_write_schedule(inst_t* s, size_t w, void* arg) {
+    interval_t period = *(interval_t*)arg;
+    s[0] = (inst_t) { .op = BIT,  .rs1 = 5,         .rs2 = -1 };
+    s[1] = (inst_t) { .op = DU,   .rs1 = period,    .rs2 = -1 };
+    s[2] = (inst_t) { .op = ADV2, .rs1 = w,         .rs2 = period };
+    s[3] = (inst_t) { .op = SAC,  .rs1 = -1,        .rs2 = -1 };
+    s[4] = (inst_t) { .op = JMP,  .rs1 = 0,         .rs2 = 1 };
+    s[5] = (inst_t) { .op = STP,  .rs1 = -1,        .rs2 = -1 };
+    return FS_RELEASE_SCHEDULE_LENGTH;
+}
+
+int main(int argc, const char* argv[]) {
+    size_t num_workers = argc > 1 ? strtoull(argv[1], NULL, 10) : 2;
+    size_t hyperperiods = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+    interval_t period = USEC((argc > 3 ? strtoll(argv[3], NULL, 10) : 1000));
+    _fs_release_job_cost = USEC((argc > 4 ? strtoll(argv[4], NULL, 10) : 0));
+    const char* cpu_list = argc > 5 ? argv[5] : "-";
+    int priority = argc > 6 ? atoi(argv[6]) : 0;
+    bool lock_memory = argc > 7 && atoi(argv[7]) != 0;
+    int* cpus = NULL;
+    if (strcmp(cpu_list, "-") != 0) {
+        cpus = malloc(num_workers * sizeof(int));
+        if (cpus == NULL) {
+            lf_print_error_and_exit("Out of memory.");
+        }
+        char* p = (char*)cpu_list;
+        for (size_t w = 0; w < num_workers; w++) {
+            cpus[w] = *p != '\0' ? (int)strtol(p, &p, 10) : STATIC_SCHEDULE_NO_CPU;
+            if (*p == ',') p++;
+        }
+    }
+    if (num_workers == 0 || period <= 0 || _fs_release_job_cost < 0 || priority < 0) {
+        fprintf(stderr, "Usage: %s [workers] [hyperperiods] [period in us] [background job in us] "
+                        "[cpus] [priority] [lock memory]\n", argv[0]);
+        return 1;
+    }
+
+    static_schedule_t schedule = {
+        .num_workers = num_workers,
+        .num_counters = 0,
+        .num_reactions = 0,
+        .num_reactors = num_workers,
+        .cpus = cpus,
+        .wait_policy = WAIT_HYBRID,
+    };
+    char* path = fs_bench_use_schedules(schedule, FS_RELEASE_SCHEDULE_LENGTH, _fs_release_write_schedule, &period);
+    free(cpus);
+    lf_worker_set_priority(priority);
+    lf_worker_set_lock_memory(lock_memory);
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    self_base_t** reactors = calloc(num_workers, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(1, sizeof(reaction_t*));
+    self_base_t* reactor_storage = calloc(num_workers, sizeof(self_base_t));
+    if (reactors == NULL || reactions == NULL || reactor_storage == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t w = 0; w < num_workers; w++) {
+        reactors[w] = &reactor_storage[w];
+    }
+
+    fs_bench_init(num_workers, reactors, num_workers, reactions, 0, hyperperiods * period, true);
+    // The schedule is mapped now.
+    unlink(path);
+
+    // One job more than there are workers, so that a worker never finds the
+    // queue empty while another one is running a job.
+    for (size_t j = 0; _fs_release_job_cost > 0 && j <= num_workers; j++) {
+        lf_sched_submit_background(_fs_release_job, NULL, _fs_release_job_cost);
+    }
+
+    interval_t elapsed = fs_bench_run_workers(num_workers, NULL);
+    lf_sched_background_stats_t background = { 0 };
+    for (size_t w = 0; w < num_workers; w++) {
+        lf_sched_background_stats_t stats;
+        lf_sched_background_stats(w, &stats);
+        background.jobs += stats.jobs;
+        background.time += stats.time;
+        background.overrun += stats.overrun;
+    }
+    lf_sched_free();
+
+    // The last release is due after `hyperperiods` periods; the workers then
+    // only run through SAC and BIT.
+    printf("workers=%zu hyperperiods=%zu period_us=%.3f elapsed_ms=%.3f end_after_last_release_us=%.3f "
+           "background_job_us=%.3f background_jobs=%zu reclaimed_pct=%.2f\n",
+           num_workers, hyperperiods, period / 1e3, elapsed / 1e6,
+           (elapsed - (interval_t)hyperperiods * period) / 1e3, _fs_release_job_cost / 1e3,
+           background.jobs, 100.0 * background.time / ((double)elapsed * num_workers));
+
+    free(reactor_storage);
+    free(path);
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ * @file fs_sporadic_bench.c
+ * @brief Measure how long a sporadic reaction waits for an SRV slot of the
+ * FS scheduler.
+ *
+ * Every worker runs a periodic loop with a reaction of its own and an SRV
+ * slot after it:
+ *
+ *  0: BIT  6
+ *  1: DU   period
+ *  2: EXE  w
+ *  3: SRV  budget
+ *  4: ADV2 w, period
+ *  5: JMP  0
+ *  6: STP
+ *
+ * with the physical start time set to the start of the run. One more
+ * reaction is named by no schedule and is thus sporadic (see
+ * scheduler_instructions.h). A thread that stands in for a physical action
+ * triggers it at pseudo-random times, each at most two periods after the
+ * previous one has run, and the benchmark reports how long it took from
+ * trigger to run: at most a period plus the time to get through the slot.
+ * Since the slots of all workers come at the same point of the period, more
+ * workers do not shorten the wait; staggering the slots, e.g., with DU
+ * offsets, would.
+ *
+ * Usage: fs_sporadic_bench [workers] [hyperperiods] [period in us] [budget in us]
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "util.h"
+
+#define FS_SPORADIC_SCHEDULE_LENGTH 7
+
+/** The period of the schedules and the budget of their SRV slots. */
+static interval_t _fs_sporadic_period;
+static interval_t _fs_sporadic_budget;
+
+/** When the sporadic reaction was last triggered. */
+static _Atomic instant_t _fs_sporadic_triggered_at;
+
+/** How often the sporadic reaction has run, and how long it waited in total and at most. */
+static _Atomic size_t _fs_sporadic_runs;
+static interval_t _fs_sporadic_total_latency;
+static interval_t _fs_sporadic_max_latency;
+
+/** Set once the workers have stopped. */
+static atomic_bool _fs_sporadic_done;
+
+static void _fs_sporadic_periodic(void* self) {}
+
+static void _fs_sporadic_reaction(void* self) {
+    interval_t latency = lf_time_physical() - atomic_load(&_fs_sporadic_triggered_at);
+    _fs_sporadic_total_latency += latency;
+    if (latency > _fs_sporadic_max_latency) _fs_sporadic_max_latency = latency;
+    atomic_fetch_add(&_fs_sporadic_runs, 1);
+}
+
+/**
+ * @brief Trigger the sporadic reaction (`arg`) again and again, each time
+ * after it has run and a pseudo-random delay of up to two periods has passed.
+ */
+static void* _fs_sporadic_trigger(void* arg) {
+    reaction_t* reaction = (reaction_t*)arg;
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    while (!atomic_load(&_fs_sporadic_done)) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        lf_sleep((interval_t)(state % (uint64_t)(2 * _fs_sporadic_period)));
+        size_t runs = atomic_load(&_fs_sporadic_runs);
+        atomic_store(&_fs_sporadic_triggered_at, lf_time_physical());
+        lf_sched_trigger_reaction(reaction, -1);
+        while (atomic_load(&_fs_sporadic_runs) == runs && !atomic_load(&_fs_sporadic_done)) {
+            lf_sleep(USEC(10));
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Write the schedule of worker `w` (see `fs_bench_use_schedules()`).
+ */
+static size_t _fs_sporadic_write_schedule(inst_t* s, size_t w, void* arg) {
+    s[0] = (inst_t) { .op = BIT,  .rs1 = 6,                     .rs2 = -1 };
+    s[1] = (inst_t) { .op = DU,   .rs1 = _fs_sporadic_period,   .rs2 = -1 };
+    s[2] = (inst_t) { .op = EXE,  .rs1 = w,                     .rs2 = -1 };
+    s[3] = (inst_t) { .op = SRV,  .rs1 = _fs_sporadic_budget,   .rs2 = -1 };
+    s[4] = (inst_t) { .op = ADV2, .rs1 = w,                     .rs2 = _fs_sporadic_period };
+    s[5] = (inst_t) { .op = JMP,  .rs1 = 0,                     .rs2 = 1 };
+    s[6] = (inst_t) { .op = STP,  .rs1 = -1,                    .rs2 = -1 };
+    return FS_SPORADIC_SCHEDULE_LENGTH;
+}
+
+int main(int argc, const char* argv[]) {
+    size_t num_workers = argc > 1 ? strtoull(argv[1], NULL, 10) : 2;
+    size_t hyperperiods = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+    interval_t period = USEC((argc > 3 ? strtoll(argv[3], NULL, 10) : 1000));
+    interval_t budget = USEC((argc > 4 ? strtoll(argv[4], NULL, 10) : 100));
+    if (num_workers == 0 || period <= 0 || budget <= 0) {
+        fprintf(stderr, "Usage: %s [workers] [hyperperiods] [period in us] [budget in us]\n", argv[0]);
+        return 1;
+    }
+
+    _fs_sporadic_period = period;
+    _fs_sporadic_budget = budget;
+    static_schedule_t schedule = {
+        .num_workers = num_workers,
+        .num_counters = 0,
+        .num_reactions = num_workers + 1,
+        .num_reactors = num_workers,
+        .wait_policy = WAIT_HYBRID,
+    };
+    char* path = fs_bench_use_schedules(schedule, FS_SPORADIC_SCHEDULE_LENGTH, _fs_sporadic_write_schedule, NULL);
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    size_t num_reactions = num_workers + 1;
+    self_base_t** reactors = calloc(num_workers, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(num_reactions, sizeof(reaction_t*));
+    self_base_t* reactor_storage = calloc(num_workers, sizeof(self_base_t));
+    reaction_t* reaction_storage = calloc(num_reactions, sizeof(reaction_t));
+    if (reactors == NULL || reactions == NULL || reactor_storage == NULL || reaction_storage == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t w = 0; w < num_workers; w++) {
+        reactors[w] = &reactor_storage[w];
+    }
+    for (size_t i = 0; i < num_reactions; i++) {
+        reaction_t* reaction = &reaction_storage[i];
+        bool sporadic = i == num_workers;
+        reaction->function = sporadic ? _fs_sporadic_reaction : _fs_sporadic_periodic;
+        reaction->self = reactors[sporadic ? 0 : i];
+        reaction->name = sporadic ? "sporadic_reaction" : "periodic_reaction";
+        reaction->status = inactive;
+        reaction->deadline = NEVER;
+        reactions[i] = reaction;
+    }
+
+    fs_bench_init(num_workers, reactors, num_workers, reactions, num_reactions, hyperperiods * period, true);
+    // The schedule is mapped now.
+    unlink(path);
+
+    lf_thread_t trigger;
+    if (lf_thread_create(&trigger, _fs_sporadic_trigger, reactions[num_workers]) != 0) {
+        lf_print_error_and_exit("Cannot start the trigger thread.");
+    }
+    interval_t elapsed = fs_bench_run_workers(num_workers, NULL);
+    atomic_store(&_fs_sporadic_done, true);
+    lf_thread_join(trigger, NULL);
+    lf_sched_free();
+
+    size_t runs = atomic_load(&_fs_sporadic_runs);
+    printf("workers=%zu hyperperiods=%zu period_us=%.3f budget_us=%.3f elapsed_ms=%.3f sporadic_runs=%zu "
+           "mean_latency_us=%.3f max_latency_us=%.3f\n",
+           num_workers, hyperperiods, period / 1e3, budget / 1e3, elapsed / 1e6, runs,
+           runs > 0 ? _fs_sporadic_total_latency / 1e3 / runs : 0.0, _fs_sporadic_max_latency / 1e3);
+
+    free(reactor_storage);
+    free(reaction_storage);
+    free(path);
+    return 0;
+}
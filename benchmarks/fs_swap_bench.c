@@ -0,0 +1,246 @@
+/**
+ * @file fs_swap_bench.c
+ * @brief Switch the FS scheduler back and forth between two schedule sets
+ * while it runs, and measure what a switch costs and whether the periodic
+ * reactions keep their timing across it.
+ *
+ * There is a reaction per worker, each of its own reactor, that runs once a
+ * period. In the normal schedules every worker runs its own reaction:
+ *
+ *  0: BIT  6
+ *  1: DU   period
+ *  2: EXE  w
+ *  3: ADV2 w, period
+ *  4: SAC
+ *  5: JMP  0, 1
+ *  6: STP
+ *
+ * In the degraded schedules worker 0 runs all reactions, with a hyperperiod
+ * of two periods, and the other workers only take part in SAC:
+ *
+ *  0: BIT  n
+ *  1: DU   2 * period
+ *  2: EXE  r, ADV2 r, period     for every reaction r
+ *  .: DU   2 * period, period
+ *  .: EXE  r, ADV2 r, period     for every reaction r
+ *  .: SAC
+ *  .: JMP  0, 1
+ *  n: STP
+ *
+ * A thread stages the other set every `swap every` periods (see
+ * scheduler_swap.h). The benchmark reports how long staging took, how long
+ * it took the workers to switch, and the shortest and longest time between
+ * two runs of the same reaction, which stay close to a period if no
+ * hyperperiod is dropped or repeated at a switch. The reactions run once per
+ * period and reaction, except that the degraded schedules, if they run last
+ * and started at an odd period, finish the hyperperiod that holds the stop
+ * tag, like any schedule whose hyperperiod does not divide the timeout.
+ *
+ * Usage: fs_swap_bench [workers] [periods] [period in us] [swap every]
+ */
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "fs_bench.h"
+#include "platform.h"
+#include "reactor.h"
+#include "reactor_common.h"
+#include "scheduler.h"
+#include "scheduler_instructions.h"
+#include "scheduler_swap.h"
+#include "util.h"
+
+/** The reactors, to tell the reactions apart. */
+static self_base_t* _fs_swap_reactors;
+
+/** When each reaction last ran, and the shortest and longest time between two runs. */
+static instant_t* _fs_swap_last_run;
+static _Atomic size_t _fs_swap_runs;
+static interval_t _fs_swap_min_gap = FOREVER;
+static interval_t _fs_swap_max_gap;
+
+/** Set once the workers have stopped. */
+static atomic_bool _fs_swap_done;
+
+static void _fs_swap_reaction(void* self) {
+    size_t r = (self_base_t*)self - _fs_swap_reactors;
+    instant_t now = lf_time_physical();
+    if (_fs_swap_last_run[r] != NEVER) {
+        interval_t gap = now - _fs_swap_last_run[r];
+        // Only one worker runs a reaction at a time.
+        if (gap < _fs_swap_min_gap) _fs_swap_min_gap = gap;
+        if (gap > _fs_swap_max_gap) _fs_swap_max_gap = gap;
+    }
+    _fs_swap_last_run[r] = now;
+    atomic_fetch_add(&_fs_swap_runs, 1);
+}
+
+/** A schedule set to write. */
+typedef struct {
+    size_t num_workers;
+    interval_t period;
+    bool degraded;
+} fs_swap_set_t;
+
+/**
+ * @brief Write the schedule of worker `w` in the set `arg` points to (see
+ * `fs_bench_use_schedules()`).
+ */
+static size_t _fs_swap_write_worker(inst_t* s, size_t w, void* arg) {
+    const fs_swap_set_t* set = (const fs_swap_set_t*)arg;
+    interval_t period = set->period;
+    size_t n = 1;
+    if (!set->degraded) {
+        s[n++] = (inst_t) { .op = DU,   .rs1 = period,      .rs2 = -1 };
+        s[n++] = (inst_t) { .op = EXE,  .rs1 = w,           .rs2 = -1 };
+        s[n++] = (inst_t) { .op = ADV2, .rs1 = w,           .rs2 = period };
+    } else if (w == 0) {
+        for (size_t half = 0; half < 2; half++) {
+            s[n++] = (inst_t) { .op = DU, .rs1 = 2 * period, .rs2 = half == 0 ? -1 : period };
+            for (size_t r = 0; r < set->num_workers; r++) {
+                s[n++] = (inst_t) { .op = EXE,  .rs1 = r,   .rs2 = -1 };
+                s[n++] = (inst_t) { .op = ADV2, .rs1 = r,   .rs2 = period };
+            }
+        }
+    }
+    s[n++] = (inst_t) { .op = SAC,  .rs1 = -1,          .rs2 = -1 };
+    s[n++] = (inst_t) { .op = JMP,  .rs1 = 0,           .rs2 = 1 };
+    s[0] = (inst_t) { .op = BIT,    .rs1 = n,           .rs2 = -1 };
+    s[n++] = (inst_t) { .op = STP,  .rs1 = -1,          .rs2 = -1 };
+    return n;
+}
+
+/**
+ * @brief Write the normal (`degraded` false) or degraded schedules for
+ * `num_workers` workers to a temporary file.
+ *
+ * @return The name of the file, which the caller must free.
+ */
+static char* _fs_swap_write_schedule(size_t num_workers, interval_t period, bool degraded) {
+    fs_swap_set_t set = { .num_workers = num_workers, .period = period, .degraded = degraded };
+    static_schedule_t schedule = {
+        .num_workers = num_workers,
+        .num_counters = 0,
+        .num_reactions = num_workers,
+        .num_reactors = num_workers,
+        .wait_policy = WAIT_HYBRID,
+    };
+    return fs_bench_use_schedules(schedule, 6 + 4 * num_workers + 1, _fs_swap_write_worker, &set);
+}
+
+/** What the staging thread is given and measures. */
+typedef struct {
+    const char* paths[2];       // The normal and the degraded schedules.
+    interval_t  interval;       // Time between two stagings.
+    size_t      staged;
+    interval_t  stage_time;     // In lf_sched_stage_schedule().
+    interval_t  max_stage_time;
+    size_t      switched;
+    interval_t  switch_time;    // From staging until the workers had switched.
+    interval_t  max_switch_time;
+} fs_swap_stager_t;
+
+/**
+ * @brief Stage the degraded and normal schedules in turn until the workers
+ * stop, and wait each time for the workers to switch.
+ */
+static void* _fs_swap_stage(void* arg) {
+    fs_swap_stager_t* stager = (fs_swap_stager_t*)arg;
+    for (size_t i = 1; !atomic_load(&_fs_swap_done); i++) {
+        instant_t next = lf_time_physical() + stager->interval;
+        while (lf_time_physical() < next && !atomic_load(&_fs_swap_done)) {
+            lf_sleep(MSEC(1));
+        }
+        if (atomic_load(&_fs_swap_done)) break;
+        size_t swaps = lf_sched_schedule_swaps();
+        instant_t start = lf_time_physical();
+        const char* error;
+        if (lf_sched_stage_schedule(stager->paths[i % 2], &error) != 0) {
+            lf_print_error_and_exit("Cannot stage %s: %s.", stager->paths[i % 2], error);
+        }
+        instant_t staged = lf_time_physical();
+        stager->staged++;
+        stager->stage_time += staged - start;
+        if (staged - start > stager->max_stage_time) stager->max_stage_time = staged - start;
+        while (lf_sched_schedule_swaps() == swaps && !atomic_load(&_fs_swap_done)) {
+            lf_sleep(USEC(10));
+        }
+        if (lf_sched_schedule_swaps() == swaps) break;
+        interval_t switched = lf_time_physical() - staged;
+        stager->switched++;
+        stager->switch_time += switched;
+        if (switched > stager->max_switch_time) stager->max_switch_time = switched;
+    }
+    return NULL;
+}
+
+int main(int argc, const char* argv[]) {
+    size_t num_workers = argc > 1 ? strtoull(argv[1], NULL, 10) : 2;
+    size_t periods = argc > 2 ? strtoull(argv[2], NULL, 10) : 1000;
+    interval_t period = USEC((argc > 3 ? strtoll(argv[3], NULL, 10) : 1000));
+    size_t swap_every = argc > 4 ? strtoull(argv[4], NULL, 10) : 10;
+    if (num_workers == 0 || period <= 0 || swap_every == 0) {
+        fprintf(stderr, "Usage: %s [workers] [periods] [period in us] [swap every]\n", argv[0]);
+        return 1;
+    }
+
+    fs_swap_stager_t stager = { .interval = swap_every * period };
+    char* degraded = _fs_swap_write_schedule(num_workers, period, true);
+    // Written last, so that the scheduler loads it.
+    char* normal = _fs_swap_write_schedule(num_workers, period, false);
+    stager.paths[0] = normal;
+    stager.paths[1] = degraded;
+
+    // The scheduler frees these two arrays in lf_sched_free().
+    self_base_t** reactors = calloc(num_workers, sizeof(self_base_t*));
+    reaction_t** reactions = calloc(num_workers, sizeof(reaction_t*));
+    _fs_swap_reactors = calloc(num_workers, sizeof(self_base_t));
+    reaction_t* reaction_storage = calloc(num_workers, sizeof(reaction_t));
+    _fs_swap_last_run = calloc(num_workers, sizeof(instant_t));
+    if (reactors == NULL || reactions == NULL || _fs_swap_reactors == NULL || reaction_storage == NULL
+            || _fs_swap_last_run == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t r = 0; r < num_workers; r++) {
+        reactors[r] = &_fs_swap_reactors[r];
+        reaction_t* reaction = &reaction_storage[r];
+        reaction->function = _fs_swap_reaction;
+        reaction->self = reactors[r];
+        reaction->name = "periodic_reaction";
+        reaction->status = inactive;
+        reaction->deadline = NEVER;
+        reactions[r] = reaction;
+        _fs_swap_last_run[r] = NEVER;
+    }
+
+    fs_bench_init(num_workers, reactors, num_workers, reactions, num_workers, periods * period, true);
+
+    lf_thread_t thread;
+    if (lf_thread_create(&thread, _fs_swap_stage, &stager) != 0) {
+        lf_print_error_and_exit("Cannot start the staging thread.");
+    }
+    interval_t elapsed = fs_bench_run_workers(num_workers, NULL);
+    atomic_store(&_fs_swap_done, true);
+    lf_thread_join(thread, NULL);
+    size_t swaps = lf_sched_schedule_swaps();
+    lf_sched_free();
+
+    printf("workers=%zu periods=%zu period_us=%.3f swap_every=%zu elapsed_ms=%.3f swaps=%zu runs=%zu "
+           "mean_stage_us=%.3f max_stage_us=%.3f mean_switch_us=%.3f max_switch_us=%.3f "
+           "min_gap_us=%.3f max_gap_us=%.3f\n",
+           num_workers, periods, period / 1e3, swap_every, elapsed / 1e6, swaps, atomic_load(&_fs_swap_runs),
+           stager.staged > 0 ? stager.stage_time / 1e3 / stager.staged : 0.0, stager.max_stage_time / 1e3,
+           stager.switched > 0 ? stager.switch_time / 1e3 / stager.switched : 0.0, stager.max_switch_time / 1e3,
+           _fs_swap_min_gap / 1e3, _fs_swap_max_gap / 1e3);
+
+    unlink(normal);
+    unlink(degraded);
+    free(normal);
+    free(degraded);
+    free(_fs_swap_reactors);
+    free(reaction_storage);
+    free(_fs_swap_last_run);
+    return 0;
+}
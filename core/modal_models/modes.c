@@ -526,11 +526,15 @@ void _lf_process_mode_changes(
             }
         }
 
+#if SCHEDULER != FS
+        // The FS scheduler triggers them itself right after the transitions
+        // and never pops the event queue.
         if (_lf_mode_triggered_reactions_request) {
             // Insert a dummy event in the event queue for the next microstep to make
             // sure startup/reset reactions (if any) are triggered as soon as possible.
             pqueue_insert(event_q, _lf_create_dummy_events(NULL, current_tag.time, NULL, 1));
         }
+#endif
     }
 }
 
@@ -1,6 +1,9 @@
 #ifdef PLATFORM_Linux
 /* MacOS API support for the C target of Lingua Franca. */
 
+// For sched_setaffinity().
+#define _GNU_SOURCE
+
 /*************
 Copyright (c) 2021, The University of California at Berkeley.
 
@@ -45,6 +48,32 @@ THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "lf_unix_clock_support.h"
 
+#if defined LF_THREADED || defined _LF_TRACE
+#include <errno.h>
+#include <sched.h>
+#include <sys/mman.h>
+
+int lf_thread_set_cpu(int cpu_number) {
+    if (cpu_number < 0 || cpu_number >= CPU_SETSIZE) {
+        return EINVAL;
+    }
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu_number, &cpus);
+    // On Linux, 0 is the calling thread rather than the whole process.
+    return sched_setaffinity(0, sizeof(cpus), &cpus) == 0 ? 0 : errno;
+}
+
+int lf_thread_set_fifo_priority(int priority) {
+    struct sched_param param = { .sched_priority = priority };
+    return sched_setscheduler(0, SCHED_FIFO, &param) == 0 ? 0 : errno;
+}
+
+int lf_lock_memory() {
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? 0 : errno;
+}
+#endif
+
 /**
  * Pause execution for a number of nanoseconds.
  *
@@ -41,6 +41,25 @@ THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "lf_unix_clock_support.h"
 
+#if defined LF_THREADED || defined _LF_TRACE
+#include <errno.h>
+
+// macOS cannot pin a thread to a CPU or lock all memory of a program, and
+// the runtime does not use its real-time thread policies.
+
+int lf_thread_set_cpu(int cpu_number) {
+    return ENOTSUP;
+}
+
+int lf_thread_set_fifo_priority(int priority) {
+    return ENOTSUP;
+}
+
+int lf_lock_memory() {
+    return ENOTSUP;
+}
+#endif
+
 /**
  * Pause execution for a number of nanoseconds.
  *
@@ -72,6 +72,20 @@ int lf_available_cores() {
     return sysinfo.dwNumberOfProcessors;
 }
 
+// Not supported yet (see SetThreadAffinityMask() and VirtualLock()).
+
+int lf_thread_set_cpu(int cpu_number) {
+    return ENOTSUP;
+}
+
+int lf_thread_set_fifo_priority(int priority) {
+    return ENOTSUP;
+}
+
+int lf_lock_memory() {
+    return ENOTSUP;
+}
+
 #else
 #include "lf_os_single_threaded_support.c"
 #endif
@@ -382,6 +382,20 @@ int lf_available_cores() {
     return 1;
 }
 
+// Not supported yet.
+
+int lf_thread_set_cpu(int cpu_number) {
+    return ENOTSUP;
+}
+
+int lf_thread_set_fifo_priority(int priority) {
+    return ENOTSUP;
+}
+
+int lf_lock_memory() {
+    return ENOTSUP;
+}
+
 /**
  * Create a new thread, starting with execution of lf_thread
  * getting passed arguments. The new handle is stored in thread_id.
@@ -54,6 +54,9 @@ THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "vector.h"
 #include "hashset/hashset.h"
 #include "hashset/hashset_itr.h"
+#ifdef LF_THREADED
+#include "worker_placement.h"
+#endif
 
 ////////////////////////////////////////////////////////////
 //// Global variables :(
@@ -102,6 +105,20 @@ tag_t stop_tag = FOREVER_TAG_INITIALIZER;
 /** Indicator of whether the keepalive command-line option was given. */
 bool keepalive_specified = false;
 
+#if SCHEDULER == FS
+/**
+ * The static schedule file given with the --schedule command-line option, or
+ * NULL to use the schedule compiled into the program.
+ */
+const char* static_schedule_file = NULL;
+
+/**
+ * How many times to unroll the hyperperiod of the static schedule, as given
+ * with the --unroll command-line option.
+ */
+size_t static_schedule_unroll_factor = 1;
+#endif
+
 // Define the array of pointers to the _is_present fields of all the
 // self structs that need to be reinitialized at the start of each time step.
 // NOTE: This may have to be resized for a mutation.
@@ -1508,6 +1525,21 @@ void usage(int argc, const char* argv[]) {
     printf("   Whether continue execution even when there are no events to process.\n\n");
     printf("  -w, --workers <n>\n");
     printf("   Executed in <n> threads if possible (optional feature).\n\n");
+    #ifdef LF_THREADED
+    printf("  -c, --cpus <list>\n");
+    printf("   Pin worker i to the i-th CPU of the comma-separated <list>, e.g., 2,3,4.\n\n");
+    printf("  -p, --priority <n>\n");
+    printf("   Run the workers with the real-time FIFO policy at priority <n>.\n\n");
+    printf("  -m, --lock-memory [true | false]\n");
+    printf("   Whether to lock the memory of the program into RAM.\n\n");
+    #endif
+    #if SCHEDULER == FS
+    printf("  -s, --schedule <file>\n");
+    printf("   Execute the static schedule in <file> instead of the compiled-in one.\n");
+    printf("   SIGHUP switches to <file> again at the end of a hyperperiod.\n\n");
+    printf("  -u, --unroll <n>\n");
+    printf("   Unroll the hyperperiod of the static schedule <n> times.\n\n");
+    #endif
     printf("  -i, --id <n>\n");
     printf("   The ID of the federation that this reactor will join.\n\n");
     #ifdef FEDERATED
@@ -1628,6 +1660,74 @@ int process_args(int argc, const char* argv[]) {
             }
             _lf_number_of_workers = (unsigned int)num_workers;
         }
+        #ifdef LF_THREADED
+          else if (strcmp(arg, "-c") == 0 || strcmp(arg, "--cpus") == 0) {
+            if (argc < i + 1) {
+                lf_print_error("--cpus needs a comma-separated list of CPUs.");
+                usage(argc, argv);
+                return 0;
+            }
+            const char* cpus_spec = argv[i++];
+            if (lf_worker_set_cpus(cpus_spec) != 0) {
+                lf_print_error("Invalid value for --cpus: %s", cpus_spec);
+                usage(argc, argv);
+                return 0;
+            }
+        } else if (strcmp(arg, "-p") == 0 || strcmp(arg, "--priority") == 0) {
+            if (argc < i + 1) {
+                lf_print_error("--priority needs an integer argument.");
+                usage(argc, argv);
+                return 0;
+            }
+            const char* priority_spec = argv[i++];
+            int priority = atoi(priority_spec);
+            if (priority <= 0) {
+                lf_print_error("Invalid value for --priority: %s", priority_spec);
+                usage(argc, argv);
+                return 0;
+            }
+            lf_worker_set_priority(priority);
+        } else if (strcmp(arg, "-m") == 0 || strcmp(arg, "--lock-memory") == 0) {
+            if (argc < i + 1) {
+                lf_print_error("--lock-memory needs a boolean.");
+                usage(argc, argv);
+                return 0;
+            }
+            const char* lock_spec = argv[i++];
+            if (strcmp(lock_spec, "true") == 0) {
+                lf_worker_set_lock_memory(true);
+            } else if (strcmp(lock_spec, "false") == 0) {
+                lf_worker_set_lock_memory(false);
+            } else {
+                lf_print_error("Invalid value for --lock-memory: %s", lock_spec);
+                usage(argc, argv);
+                return 0;
+            }
+        }
+        #endif
+        #if SCHEDULER == FS
+          else if (strcmp(arg, "-s") == 0 || strcmp(arg, "--schedule") == 0) {
+            if (argc < i + 1) {
+                lf_print_error("--schedule needs a file name.");
+                usage(argc, argv);
+                return 0;
+            }
+            static_schedule_file = argv[i++];
+        } else if (strcmp(arg, "-u") == 0 || strcmp(arg, "--unroll") == 0) {
+            if (argc < i + 1) {
+                lf_print_error("--unroll needs an integer argument.");
+                usage(argc, argv);
+                return 0;
+            }
+            const char* factor_spec = argv[i++];
+            int factor = atoi(factor_spec);
+            if (factor <= 0) {
+                lf_print_error("Invalid value for --unroll: %s. Using 1.", factor_spec);
+                factor = 1;
+            }
+            static_schedule_unroll_factor = (size_t)factor;
+        }
+        #endif
         #ifdef FEDERATED
           else if (strcmp(arg, "-i") == 0 || strcmp(arg, "--id") == 0) {
             if (argc < i + 1) {
@@ -45,6 +45,7 @@ THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "reactor.h"
 #include "scheduler.h"
 #include "tag.h"
+#include "worker_placement.h"
 
 /**
  * Global mutex and condition variable.
@@ -934,42 +935,47 @@ void _lf_worker_invoke_reaction(int worker_number, reaction_t* reaction) {
  * The main looping logic of each LF worker thread.
  * This function assumes the caller holds the mutex lock.
  *
+ * The worker asks the scheduler for a run-list of reactions at a time,
+ * executes them back-to-back, and reports them done together.
+ *
  * @param worker_number The number assigned to this worker thread
  */
 void _lf_worker_do_work(int worker_number) {
-    // Keep track of whether we have decremented the idle thread count.
-    // Obtain a reaction from the scheduler that is ready to execute
-    // (i.e., it is not blocked by concurrently executing reactions
-    // that it depends on).
+    // Obtain reactions from the scheduler that are ready to execute
+    // (i.e., they are not blocked by concurrently executing reactions
+    // that they depend on).
     // lf_print_snapshot(); // This is quite verbose (but very useful in debugging reaction deadlocks).
-    reaction_t* current_reaction_to_execute = NULL;
-    while ((current_reaction_to_execute =
-            lf_sched_get_ready_reaction(worker_number))
-            != NULL) {
-        // Got a reaction that is ready to run.
-        LF_PRINT_DEBUG("Worker %d: Got from scheduler reaction %s: "
-                "level: %lld, is control reaction: %d, chain ID: %llu, and deadline " PRINTF_TIME ".",
+    reaction_t* run_list[LF_SCHED_MAX_RUN_LIST];
+    size_t count;
+    while ((count = lf_sched_get_ready_reactions(worker_number, run_list, LF_SCHED_MAX_RUN_LIST)) > 0) {
+        for (size_t i = 0; i < count; i++) {
+            reaction_t* current_reaction_to_execute = run_list[i];
+            // Got a reaction that is ready to run.
+            LF_PRINT_DEBUG("Worker %d: Got from scheduler reaction %s (%zu of %zu): "
+                    "level: %lld, is control reaction: %d, chain ID: %llu, and deadline " PRINTF_TIME ".",
+                    worker_number,
+                    current_reaction_to_execute->name,
+                    i + 1, count,
+                    LF_LEVEL(current_reaction_to_execute->index),
+                    current_reaction_to_execute->is_a_control_reaction,
+                    current_reaction_to_execute->chain_id,
+                    current_reaction_to_execute->deadline);
+
+            bool violation = _lf_worker_handle_violations(
                 worker_number,
-                current_reaction_to_execute->name,
-                LF_LEVEL(current_reaction_to_execute->index),
-                current_reaction_to_execute->is_a_control_reaction,
-                current_reaction_to_execute->chain_id,
-                current_reaction_to_execute->deadline);
+                current_reaction_to_execute
+            );
 
-        bool violation = _lf_worker_handle_violations(
-            worker_number,
-            current_reaction_to_execute
-        );
+            if (!violation) {
+                // Invoke the reaction function.
+                _lf_worker_invoke_reaction(worker_number, current_reaction_to_execute);
+            }
 
-        if (!violation) {
-            // Invoke the reaction function.
-            _lf_worker_invoke_reaction(worker_number, current_reaction_to_execute);
+            LF_PRINT_DEBUG("Worker %d: Done with reaction %s.",
+                    worker_number, current_reaction_to_execute->name);
         }
 
-        LF_PRINT_DEBUG("Worker %d: Done with reaction %s.",
-                worker_number, current_reaction_to_execute->name);
-
-        lf_sched_done_with_reaction(worker_number, current_reaction_to_execute);
+        lf_sched_done_with_reactions(worker_number, run_list, count);
     }
 }
 
@@ -984,6 +990,9 @@ void* worker(void* arg) {
     LF_PRINT_LOG("Worker thread %d started.", worker_number);
     lf_mutex_unlock(&mutex);
 
+    // Before the worker allocates anything of its own (see worker_placement.h).
+    lf_worker_place((size_t)worker_number);
+
     _lf_worker_do_work(worker_number);
 
     lf_mutex_lock(&mutex);
@@ -1029,6 +1038,7 @@ lf_thread_t* _lf_thread_ids;
 // Start threads in the thread pool.
 void start_threads() {
     LF_PRINT_LOG("Starting %u worker threads.", _lf_number_of_workers);
+    lf_worker_placement_init(_lf_number_of_workers);
     _lf_thread_ids = (lf_thread_t*)malloc(_lf_number_of_workers * sizeof(lf_thread_t));
     for (unsigned int i = 0; i < _lf_number_of_workers; i++) {
         if (lf_thread_create(&_lf_thread_ids[i], worker, NULL) != 0) {
@@ -40,116 +40,1882 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #define NUMBER_OF_WORKERS 1
 #endif  // NUMBER_OF_WORKERS
 
+#if defined(FS_THREADED_DISPATCH) && !defined(__GNUC__)
+#error "FS_THREADED_DISPATCH requires a compiler with computed goto support (GCC or Clang)."
+#endif
+
+#if defined(FS_COMPILED) && defined(FS_PROFILE)
+#error "FS_PROFILE profiles the instructions of the interpreter and cannot be combined with FS_COMPILED."
+#endif
+
 #include <assert.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Schedule swaps on a signal (see scheduler_swap.h) need POSIX signals and
+// a schedule that can be swapped.
+#if (defined(PLATFORM_Linux) || defined(PLATFORM_Darwin)) && !defined(FS_COMPILED) && !defined(FS_PROFILE)
+#define LF_SCHED_SWAP_ON_SIGNAL
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#ifndef FS_SWAP_SIGNAL
+#define FS_SWAP_SIGNAL SIGHUP
+#endif
+#endif
+
+#include "platform.h"
+#if defined(PLATFORM_Linux)
+#include "lf_unix_clock_support.h"
+#endif
+#include "reactor_common.h"
+#include "scheduler_instance.h"
+#ifdef FS_COMPILED
+#include "scheduler_compiled.h"
+#endif
+#include "scheduler_sync_tag_advance.h"
+#include "scheduler.h"
+#include "scheduler_swap.h"
+#include "semaphore.h"
+#include "static_schedule_file.h"
+#include "static_schedule_unroll.h"
+#include "static_schedule_verify.h"
+#include "trace.h"
+#include "util.h"
+#include "worker_placement.h"
+
+/////////////////// External Variables /////////////////////////
+extern const inst_t* static_schedules[];
+extern volatile uint32_t hyperperiod_iterations[];
+extern const size_t num_counters;
+extern const size_t schedule_lengths[];
+extern const size_t num_schedules;
+extern const wait_policy_t wait_policy;
+extern tag_t current_tag;
+extern tag_t stop_tag;
+extern instant_t start_time;
+extern bool _lf_worker_handle_violations(int worker_number, reaction_t* reaction);
+extern void _lf_worker_invoke_reaction(int worker_number, reaction_t* reaction);
+
+/////////////////// Scheduler Variables and Structs /////////////////////////
+_lf_sched_instance_t* _lf_sched_instance;
+
+/////////////////// Scheduler Private API /////////////////////////
+
+/**
+ * @brief How many pause instructions a worker executes under WAIT_HYBRID
+ * before it goes to sleep in WU or SAC.
+ */
+#ifndef LF_SCHED_WAIT_SPIN_PAUSES
+#define LF_SCHED_WAIT_SPIN_PAUSES 256
+#endif
+
+/**
+ * @brief The largest number of pause instructions between two reads of a
+ * word that a worker waits on. The number doubles on every read, starting
+ * from 1.
+ */
+#define LF_SCHED_WAIT_MAX_BACKOFF 64
+
+/**
+ * @brief How long a sleeping worker waits before it reads the word it waits
+ * on again on platforms without futexes, where it cannot be woken up.
+ */
+#define LF_SCHED_WAIT_POLL_INTERVAL USEC(20)
+
+/**
+ * @brief How long a worker sleeping in WU that may have to stop waits at most
+ * before it checks `stop_epoch` again. A stop wakes it up, but does not change
+ * the word it sleeps on, so the wake-up can come just before it goes to sleep.
+ */
+#define LF_SCHED_STOP_POLL_INTERVAL MSEC(1)
+
+/**
+ * @brief The execution context of a worker.
+ */
+static inline lf_sched_worker_context_t* _lf_sched_context(size_t worker_number) {
+    return _lf_sched_instance->contexts[worker_number];
+}
+
+/**
+ * @brief Tell the CPU that the caller is spinning.
+ */
+static inline void _lf_sched_cpu_relax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+/**
+ * @brief Pause between two reads of a word that another worker is going to
+ * change.
+ *
+ * @param backoff The number of pauses. Doubled on every call, up to
+ *  `LF_SCHED_WAIT_MAX_BACKOFF`. Start with 1.
+ * @param pauses Incremented by the number of pauses.
+ */
+static inline void _lf_sched_backoff(unsigned int* backoff, unsigned int* pauses) {
+    for (unsigned int i = 0; i < *backoff; i++) {
+        _lf_sched_cpu_relax();
+    }
+    *pauses += *backoff;
+    if (*backoff < LF_SCHED_WAIT_MAX_BACKOFF) *backoff <<= 1;
+}
+
+/**
+ * @brief Whether the wait policy of the schedule allows a worker that has
+ * paused `pauses` times to keep spinning rather than go to sleep.
+ */
+static inline bool _lf_sched_keep_spinning(unsigned int pauses) {
+    switch (_lf_sched_instance->wait_policy) {
+        case WAIT_SPIN:     return true;
+        case WAIT_HYBRID:   return pauses < LF_SCHED_WAIT_SPIN_PAUSES;
+        default:            return false;
+    }
+}
+
+/**
+ * @brief Sleep as long as a word holds `value`.
+ *
+ * May return early, so the caller must check the word again.
+ *
+ * @param timeout How long to sleep at most, or FOREVER for no bound.
+ */
+static inline void _lf_sched_word_sleep(_Atomic uint32_t* word, uint32_t value, interval_t timeout) {
+#if defined(__linux__)
+    struct timespec ts = { .tv_sec = timeout / BILLION, .tv_nsec = timeout % BILLION };
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT_PRIVATE, value, timeout == FOREVER ? NULL : &ts, NULL, 0);
+#else
+    (void)timeout;
+    lf_nanosleep(LF_SCHED_WAIT_POLL_INTERVAL);
+#endif
+}
+
+/**
+ * @brief Wake up all workers sleeping on a word if `waiters` says there are
+ * any.
+ *
+ * Must be called after the word has been changed. A sleeper registers in
+ * `waiters` before it reads the word for the last time, and this reads
+ * `waiters` after a full fence that follows the change, so either the sleeper
+ * sees the change or this sees the sleeper.
+ */
+static inline void _lf_sched_word_wake(_Atomic uint32_t* word, _Atomic uint32_t* waiters) {
+    // With WAIT_SPIN nobody ever sleeps, so skip the fence below.
+    if (_lf_sched_instance->wait_policy == WAIT_SPIN) return;
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(waiters, memory_order_relaxed) == 0) return;
+#if defined(__linux__)
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+#endif
+}
+
+/**
+ * @brief The word of a counter that workers sleeping in WU wait on: the low
+ * 32 bits of its value, since a futex is 32 bits wide. The verifier makes
+ * sure that no INC or INC2 leaves them unchanged.
+ */
+static inline _Atomic uint32_t* _lf_sched_counter_word(lf_sched_counter_t* counter) {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    return (_Atomic uint32_t*)&counter->value + 1;
+#else
+    return (_Atomic uint32_t*)&counter->value;
+#endif
+}
+
+static void _lf_sched_install_schedule(int next_iteration);
+
+#ifdef MODAL_REACTORS
+/**
+ * @brief Apply the mode transitions that reactions have requested in the
+ * hyperperiod that ends now (see `_lf_process_mode_changes()`), and trigger
+ * the startup and reset reactions of the modes entered, for EIT or SRV to
+ * run.
+ *
+ * Called by the last worker to arrive at the SAC at the end of the
+ * hyperperiod, while the others wait, so no reaction runs and no BNM reads
+ * a mode meanwhile. Takes the mutex that guards the event queue, from which
+ * the transitions suspend and restore the events of modes.
+ */
+static void _lf_sched_change_modes() {
+    lf_mutex_lock(&mutex);
+    _lf_handle_mode_changes();
+    _lf_handle_mode_triggered_reactions();
+    lf_mutex_unlock(&mutex);
+}
+#endif
+
+/**
+ * @brief Wait until all workers have reached SAC.
+ *
+ * The workers arrive at the leaves of a combining tree with
+ * `LF_SCHED_BARRIER_FANIN` children per node, so that no more than that
+ * many workers update the same word. The last to arrive at a node goes on to
+ * the parent, and the last to arrive at the root starts a new SAC generation,
+ * which the other workers watch for, following the wait policy of the
+ * schedule. Waiting for the generation rather than for a semaphore token
+ * means that a worker that leaves SAC first and reaches the next SAC cannot
+ * take the release meant for a worker that is still waiting in this one.
+ *
+ * SAC does not touch the counters, which are never cleared (see
+ * `lf_sched_counter_t`). At the end of a hyperperiod, the last to arrive
+ * applies the requested mode transitions and installs the schedules staged
+ * with `lf_sched_stage_schedule()`, if any, before it starts the new
+ * generation, so that neither takes a barrier of its own.
+ *
+ * @param worker_number The worker number of the worker thread asking for work
+ * to be assigned to it.
+ * @param boundary Whether this is the SAC at the end of the hyperperiod.
+ * @param next_iteration If so, the hyperperiod iteration that the next pass
+ *  through the loop would run.
+ */
+static void _lf_sched_barrier(size_t worker_number, bool boundary, int next_iteration) {
+    _Atomic uint32_t* word = &_lf_sched_instance->sac_generation;
+    // The generation cannot change before this worker has arrived too.
+    uint32_t generation = atomic_load_explicit(word, memory_order_relaxed);
+
+    size_t node = worker_number / LF_SCHED_BARRIER_FANIN;
+    for (;;) {
+        lf_sched_barrier_node_t* n = &_lf_sched_instance->barrier_nodes[node];
+        // Release what this worker (or subtree) wrote before SAC, and acquire
+        // what the others that arrived here before wrote.
+        if (atomic_fetch_add_explicit(&n->arrived, 1, memory_order_acq_rel) + 1 < n->expected) {
+            break;
+        }
+        // Last to arrive. Nobody arrives here again before the release below.
+        atomic_store_explicit(&n->arrived, 0, memory_order_relaxed);
+        if (n->parent == LF_SCHED_BARRIER_ROOT) {
+            LF_PRINT_DEBUG("Scheduler: Worker %zu is the last idle thread.", worker_number);
+            if (boundary) {
+#ifdef MODAL_REACTORS
+                _lf_sched_change_modes();
+#endif
+                if (atomic_load_explicit(&_lf_sched_instance->staged_schedule, memory_order_relaxed) != NULL) {
+                    _lf_sched_install_schedule(next_iteration);
+                }
+            }
+            atomic_store_explicit(word, generation + 1, memory_order_release);
+            _lf_sched_word_wake(word, &_lf_sched_instance->sac_waiters);
+            return;
+        }
+        node = n->parent;
+    }
+
+    // Not the last thread to arrive.
+    unsigned int backoff = 1;
+    unsigned int pauses = 0;
+    while (atomic_load_explicit(word, memory_order_acquire) == generation && _lf_sched_keep_spinning(pauses)) {
+        _lf_sched_backoff(&backoff, &pauses);
+    }
+    if (atomic_load_explicit(word, memory_order_acquire) == generation) {
+        atomic_fetch_add_explicit(&_lf_sched_instance->sac_waiters, 1, memory_order_seq_cst);
+        while (atomic_load_explicit(word, memory_order_acquire) == generation) {
+            _lf_sched_word_sleep(word, generation, FOREVER);
+        }
+        atomic_fetch_sub_explicit(&_lf_sched_instance->sac_waiters, 1, memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Wait until all workers have reached SAC, outside of a hyperperiod
+ * boundary (see `_lf_sched_barrier()`).
+ */
+void _lf_sched_wait_for_work(size_t worker_number) {
+    _lf_sched_barrier(worker_number, false, 0);
+}
+
+/**
+ * @brief Check whether every reactor has reached the stop tag.
+ *
+ * This is a single load of the countdown that ADV and ADV2 maintain, so it
+ * takes constant time however many reactors the program has.
+ */
+static inline bool _lf_sched_timeout_reached() {
+    bool stop = atomic_load_explicit(&_lf_sched_instance->reactors_remaining, memory_order_acquire) == 0;
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+    LF_PRINT_DEBUG("Start time is %ld. Current tag is (%ld, %d). Stop tag is (%ld, %d). Stop array: ", start_time, current_tag.time, current_tag.microstep, stop_tag.time, stop_tag.microstep);
+    for (int i = 0; i < _lf_sched_instance->num_reactor_self_instances; i++) {
+        LF_PRINT_DEBUG("(%ld, 0)", atomic_load_explicit(&_lf_sched_instance->reactor_self_instances[i]->tag_time, memory_order_relaxed));
+        LF_PRINT_DEBUG("%d", atomic_load_explicit(&_lf_sched_instance->reactor_self_instances[i]->reached_stop_tag, memory_order_relaxed));
+    }
+#endif
+
+    return stop;
+}
+
+/**
+ * @brief Whether a worker has to stop because another worker has left its
+ * loop in epoch `epoch` or before.
+ */
+static inline bool _lf_sched_stopped(size_t epoch) {
+    return epoch >= atomic_load_explicit(&_lf_sched_instance->stop_epoch, memory_order_relaxed);
+}
+
+/**
+ * @brief BIT: whether a worker in epoch `epoch` leaves its loop.
+ *
+ * Without a SAC before BIT, the workers do not check for the stop tag at the
+ * same time, and one that has run ahead may continue into an epoch in which
+ * another stops. The first to stop in an epoch therefore records it in
+ * `stop_epoch` and wakes up every worker sleeping in WU, so that workers in
+ * that epoch or later stop as well instead of waiting for increments that
+ * will never come (see `_lf_sched_wait_for_counter()`). Since the counters do
+ * not change, a worker that is about to sleep can miss the wake-up, so those
+ * workers also sleep for at most `LF_SCHED_STOP_POLL_INTERVAL` at a time.
+ */
+static bool _lf_sched_should_stop(size_t epoch) {
+    if (_lf_sched_stopped(epoch)) return true;
+    if (!_lf_sched_timeout_reached()) return false;
+    size_t stop_epoch = atomic_load_explicit(&_lf_sched_instance->stop_epoch, memory_order_relaxed);
+    while (epoch < stop_epoch) {
+        if (atomic_compare_exchange_weak_explicit(&_lf_sched_instance->stop_epoch, &stop_epoch, epoch,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+            for (size_t c = 0; c < _lf_sched_instance->num_counters; c++) {
+                lf_sched_counter_t* counter = &_lf_sched_instance->counters[c];
+                _lf_sched_word_wake(_lf_sched_counter_word(counter), &counter->waiters);
+            }
+            break;
+        }
+    }
+    return true;
+}
+
+#ifndef FS_DU_SPIN_NS
+/**
+ * @brief How long before a DU release time a worker stops sleeping and starts
+ * spinning. 0 turns spinning off.
+ */
+#define FS_DU_SPIN_NS 0
+#endif
+
+#ifdef FS_RELEASE_STATS
+/**
+ * @brief Add how late a worker was released by a DU to its histogram.
+ */
+static inline void _lf_sched_record_lateness(lf_sched_lateness_stats_t* stats, interval_t lateness) {
+    if (lateness < 0) lateness = 0;
+    size_t bucket = 0;
+    while (bucket < LF_SCHED_LATENESS_BUCKETS - 1 && lateness >= (1LL << bucket)) {
+        bucket++;
+    }
+    stats->buckets[bucket]++;
+    stats->releases++;
+    stats->total = lateness > FOREVER - stats->total ? FOREVER : stats->total + lateness;
+    if (lateness > stats->max) stats->max = lateness;
+}
+#endif
+
+/**
+ * @brief The release time of a DU with period `rs1` and offset `rs2` in
+ * hyperperiod iteration `iteration`, i.e.,
+ * `physical_start_time + rs1 * (iteration + 1) + rs2`, shifted by
+ * `release_offset` after schedule swaps. An offset that is not positive
+ * (usually -1) means no offset.
+ *
+ * Saturates at FOREVER instead of overflowing, so a release that cannot be
+ * represented is never reached rather than wrapping around into the past.
+ */
+static inline instant_t _lf_sched_release_time(long long int rs1, long long int rs2, int iteration) {
+    long long int n = (long long int)iteration + 1;
+    interval_t offset = rs2 > 0 ? rs2 : 0;
+    if (rs1 > 0 && n > 0) {
+        if (rs1 > (FOREVER - offset) / n) return FOREVER;
+        offset += rs1 * n;
+    }
+    instant_t origin = physical_start_time + _lf_sched_instance->release_offset;
+    if (origin > 0 && offset > FOREVER - origin) return FOREVER;
+    return origin + offset;
+}
+
+#if defined(PLATFORM_Linux)
+/**
+ * @brief The difference between physical time, as returned by
+ * `lf_time_physical()`, and the platform clock `_LF_CLOCK`.
+ */
+static inline interval_t _lf_sched_clock_offset() {
+    return _lf_time_epoch_offset + _lf_time_physical_clock_offset + _lf_time_test_physical_clock_offset;
+}
+
+/**
+ * @brief Read physical time without the bookkeeping of `lf_time_physical()`,
+ * which is not meant to be called by several workers at once.
+ */
+static inline instant_t _lf_sched_clock_now() {
+    struct timespec now;
+    clock_gettime(_LF_CLOCK, &now);
+    return convert_timespec_to_ns(now) + _lf_sched_clock_offset();
+}
+
+/**
+ * @brief Sleep until physical time `t` on the absolute time line of the
+ * platform clock, so that the time it takes to get into the sleep does not
+ * push the wakeup back.
+ */
+static void _lf_sched_sleep_until(instant_t t) {
+    if (t == FOREVER) {
+        lf_print_warning("Scheduler: A DU release time overflows; the worker will never be released.");
+    }
+    interval_t offset = _lf_sched_clock_offset();
+    instant_t clock_time = (offset < 0 && t > FOREVER + offset) ? FOREVER : t - offset;
+    struct timespec release = convert_ns_to_timespec(clock_time);
+    while (clock_nanosleep(_LF_CLOCK, TIMER_ABSTIME, &release, NULL) == EINTR) {}
+}
+#else
+static inline instant_t _lf_sched_clock_now() {
+    return lf_time_physical();
+}
+
+static void _lf_sched_sleep_until(instant_t t) {
+    lf_sleep_until_locked(t);
+}
+#endif
+
+#if (FS_BACKGROUND_QUEUE_SIZE & (FS_BACKGROUND_QUEUE_SIZE - 1)) != 0 || FS_BACKGROUND_QUEUE_SIZE < 2
+#error "FS_BACKGROUND_QUEUE_SIZE must be a power of 2 and at least 2."
+#endif
+
+/**
+ * @brief A cell of the background queue (see scheduler_background.h).
+ *
+ * `sequence` says whose turn it is: the producer of position `pos` may fill
+ * the cell when it is `pos`, and the consumer of `pos` may take the job when
+ * it is `pos + 1`. It is stored minus the index of the cell, so that a queue
+ * of zeros is empty.
+ */
+typedef struct {
+    _Atomic size_t      sequence;
+    _Atomic interval_t  cost;   // Atomic because consumers read it before they own the cell.
+    lf_sched_background_job_t job;
+    void*               arg;
+} lf_sched_background_cell_t;
+
+/**
+ * @brief The background queue: a bounded multi-producer, multi-consumer ring
+ * in which producers and consumers only contend on their own position.
+ */
+static struct {
+    _Alignas(LF_SCHED_CACHE_LINE_SIZE) _Atomic size_t enqueue_pos;
+    _Alignas(LF_SCHED_CACHE_LINE_SIZE) _Atomic size_t dequeue_pos;
+    _Alignas(LF_SCHED_CACHE_LINE_SIZE) lf_sched_background_cell_t cells[FS_BACKGROUND_QUEUE_SIZE];
+} _lf_sched_background_queue;
+
+static inline size_t _lf_sched_background_sequence(lf_sched_background_cell_t* cell, size_t index) {
+    return atomic_load_explicit(&cell->sequence, memory_order_acquire) + index;
+}
+
+int lf_sched_submit_background(lf_sched_background_job_t job, void* arg, interval_t cost) {
+    if (job == NULL || cost < 0) return -1;
+    size_t pos = atomic_load_explicit(&_lf_sched_background_queue.enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        size_t index = pos & (FS_BACKGROUND_QUEUE_SIZE - 1);
+        lf_sched_background_cell_t* cell = &_lf_sched_background_queue.cells[index];
+        intptr_t diff = (intptr_t)(_lf_sched_background_sequence(cell, index) - pos);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&_lf_sched_background_queue.enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                cell->job = job;
+                cell->arg = arg;
+                atomic_store_explicit(&cell->cost, cost, memory_order_relaxed);
+                atomic_store_explicit(&cell->sequence, pos + 1 - index, memory_order_release);
+                return 0;
+            }
+        } else if (diff < 0) {
+            return -1; // The consumer of the previous round has not taken its job yet.
+        } else {
+            pos = atomic_load_explicit(&_lf_sched_background_queue.enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Take the job at the head of the background queue if it is expected
+ * to take at most `budget`.
+ *
+ * @return false if the queue is empty or its head does not fit.
+ */
+static bool _lf_sched_take_background_job(interval_t budget, lf_sched_background_job_t* job, void** arg,
+                                          interval_t* cost) {
+    size_t pos = atomic_load_explicit(&_lf_sched_background_queue.dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        size_t index = pos & (FS_BACKGROUND_QUEUE_SIZE - 1);
+        lf_sched_background_cell_t* cell = &_lf_sched_background_queue.cells[index];
+        intptr_t diff = (intptr_t)(_lf_sched_background_sequence(cell, index) - (pos + 1));
+        if (diff == 0) {
+            // The cost may already belong to a later round if another worker has
+            // taken this job, but then the exchange below fails.
+            *cost = atomic_load_explicit(&cell->cost, memory_order_relaxed);
+            if (*cost > budget) return false;
+            if (atomic_compare_exchange_weak_explicit(&_lf_sched_background_queue.dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *job = cell->job;
+                *arg = cell->arg;
+                atomic_store_explicit(&cell->sequence, pos + FS_BACKGROUND_QUEUE_SIZE - index,
+                                      memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = atomic_load_explicit(&_lf_sched_background_queue.dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/**
+ * @brief Run background jobs in the slack before a DU release, as long as
+ * each is expected to finish `FS_BACKGROUND_GUARD_NS` before `release`.
+ *
+ * @return The time after the last job, or `now` if none ran.
+ */
+static instant_t _lf_sched_run_background_jobs(size_t worker_number, instant_t now, instant_t release) {
+    lf_sched_background_stats_t* stats = &_lf_sched_context(worker_number)->background_stats;
+    lf_sched_background_job_t job;
+    void* arg;
+    interval_t cost;
+    while (release - now > FS_BACKGROUND_GUARD_NS
+           && _lf_sched_take_background_job(release - FS_BACKGROUND_GUARD_NS - now, &job, &arg, &cost)) {
+        job(arg);
+        instant_t end = _lf_sched_clock_now();
+        stats->jobs++;
+        stats->time += end - now;
+        if (end - now > cost) stats->overrun += end - now - cost;
+        now = end;
+    }
+    return now;
+}
+
+bool lf_sched_background_stats(size_t worker_number, lf_sched_background_stats_t* stats) {
+    if (_lf_sched_instance == NULL || _lf_sched_instance->contexts == NULL
+            || worker_number >= _lf_sched_instance->_lf_sched_number_of_workers) {
+        return false;
+    }
+    *stats = _lf_sched_context(worker_number)->background_stats;
+    return true;
+}
+
+/**
+ * @brief Sleep until the release time of the current hyperperiod iteration
+ * is reached (see `_lf_sched_release_time()`).
+ *
+ * The release times are computed from the physical start time, not from the
+ * previous release, so they do not drift. The worker sleeps until
+ * `FS_DU_SPIN_NS` before the release and spins for the rest, which trades a
+ * core for precision below the wakeup latency of the platform. Before it
+ * goes to sleep, it runs what fits of the background queue into the slack
+ * (see `_lf_sched_run_background_jobs()`). If `FS_RELEASE_STATS` is defined,
+ * how late each release is gets recorded.
+ *
+ * @return How late the worker was released if that is measured, i.e., with
+ *  `FS_RELEASE_STATS` or `FS_PROFILE`, and 0 otherwise.
+ */
+static inline interval_t _lf_sched_delay_until(size_t worker_number, long long int rs1, long long int rs2,
+                                               int iteration) {
+    instant_t release = _lf_sched_release_time(rs1, rs2, iteration);
+    instant_t now = _lf_sched_clock_now();
+    LF_PRINT_DEBUG("physical_start_time: %ld, wakeup_time: %ld, rs1: %lld, iteration+1: %d, current_physical_time: %ld\n", physical_start_time, release, rs1, (iteration + 1), now);
+    if (now < release) {
+        now = _lf_sched_run_background_jobs(worker_number, now, release);
+    }
+    if (now < release) {
+        LF_PRINT_DEBUG("*** Worker %zu delaying", worker_number);
+#if FS_DU_SPIN_NS > 0
+        if (release - now > FS_DU_SPIN_NS) {
+            _lf_sched_sleep_until(release - FS_DU_SPIN_NS);
+        }
+        while ((now = _lf_sched_clock_now()) < release) {
+            _lf_sched_cpu_relax();
+        }
+#else
+        _lf_sched_sleep_until(release);
+#if defined(FS_RELEASE_STATS) || defined(FS_PROFILE)
+        now = _lf_sched_clock_now();
+#endif
+#endif
+        LF_PRINT_DEBUG("*** Worker %zu done delaying", worker_number);
+    }
+#ifdef FS_RELEASE_STATS
+    _lf_sched_record_lateness(&_lf_sched_context(worker_number)->release_stats, now - release);
+#endif
+#if defined(FS_RELEASE_STATS) || defined(FS_PROFILE)
+    return now - release;
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @brief Whether a counter has reached `target`, read with acquire semantics.
+ */
+static inline bool _lf_sched_counter_reached(lf_sched_counter_t* counter, int64_t target) {
+    return (int64_t)atomic_load_explicit(&counter->value, memory_order_acquire) >= target;
+}
+
+/**
+ * @brief Wait until a counter reaches a value in the worker's epoch, i.e.,
+ * `value + epoch * per_epoch`, following the wait policy of the schedule.
+ *
+ * The counter is read with acquire semantics, so everything the incrementing
+ * workers wrote before their INC/INC2 is visible afterwards. A worker that
+ * goes to sleep registers in the counter's `waiters` so that INC wakes it up
+ * (see `_lf_sched_word_wake()`). One that may stop also wakes up
+ * periodically to check for a stop (see `_lf_sched_should_stop()`).
+ *
+ * @return false if the worker has to leave its loop instead because another
+ *  worker has stopped (see `_lf_sched_should_stop()`).
+ */
+static bool _lf_sched_wait_for_counter(size_t worker_number, lf_sched_counter_t* counter,
+                                       long long int value, size_t epoch) {
+    int64_t target = value + (int64_t)(epoch * counter->per_epoch);
+    if (_lf_sched_counter_reached(counter, target)) return true;
+    // A worker without a BIT to leave its loop by waits regardless.
+    bool may_stop = _lf_sched_context(worker_number)->loop_exit != SIZE_MAX;
+
+    LF_PRINT_DEBUG("*** Worker %zu waiting", worker_number);
+#ifdef FS_WAIT_STATS
+    lf_sched_wait_stats_t* stats = &_lf_sched_instance->wait_stats[
+        worker_number * _lf_sched_instance->num_counters + (counter - _lf_sched_instance->counters)];
+    instant_t spin_start = _lf_sched_clock_now();
+    stats->waits++;
+#endif
+
+    unsigned int backoff = 1;
+    unsigned int pauses = 0;
+    while (!_lf_sched_counter_reached(counter, target) && !(may_stop && _lf_sched_stopped(epoch))
+            && _lf_sched_keep_spinning(pauses)) {
+        _lf_sched_backoff(&backoff, &pauses);
+    }
+#ifdef FS_WAIT_STATS
+    instant_t sleep_start = _lf_sched_clock_now();
+    stats->spin_time += sleep_start - spin_start;
+#endif
+
+    // Sleep until an INC, or a worker that stops, wakes this worker up.
+    if (!_lf_sched_counter_reached(counter, target) && !(may_stop && _lf_sched_stopped(epoch))) {
+        atomic_fetch_add_explicit(&counter->waiters, 1, memory_order_seq_cst);
+        uint64_t current;
+        while ((int64_t)(current = atomic_load_explicit(&counter->value, memory_order_acquire)) < target
+                && !(may_stop && _lf_sched_stopped(epoch))) {
+            _lf_sched_word_sleep(_lf_sched_counter_word(counter), (uint32_t)current,
+                                 may_stop ? LF_SCHED_STOP_POLL_INTERVAL : FOREVER);
+#ifdef FS_WAIT_STATS
+            stats->sleeps++;
+#endif
+        }
+        atomic_fetch_sub_explicit(&counter->waiters, 1, memory_order_relaxed);
+#ifdef FS_WAIT_STATS
+        stats->sleep_time += _lf_sched_clock_now() - sleep_start;
+#endif
+    }
+    LF_PRINT_DEBUG("*** Worker %zu done waiting", worker_number);
+    return _lf_sched_counter_reached(counter, target);
+}
+
+/**
+ * @brief Increment a counter with release semantics and wake up the workers
+ * sleeping on it, if any.
+ *
+ * @param single_writer Whether the schedule guarantees that only the calling
+ *  worker writes the counter (INC2), so that a plain store will do instead of
+ *  an atomic read-modify-write (INC).
+ */
+static inline void _lf_sched_increment_counter(lf_sched_counter_t* counter, long long int amount, bool single_writer) {
+    if (single_writer) {
+        uint64_t value = atomic_load_explicit(&counter->value, memory_order_relaxed);
+        atomic_store_explicit(&counter->value, value + (uint64_t)amount, memory_order_release);
+    } else {
+        atomic_fetch_add_explicit(&counter->value, (uint64_t)amount, memory_order_release);
+    }
+    _lf_sched_word_wake(_lf_sched_counter_word(counter), &counter->waiters);
+}
+
+/**
+ * @brief Advance the tag of a reactor by an amount and record whether the
+ * reactor has gone past the stop tag.
+ *
+ * No lock is taken. The new tag is published with a release write, and the
+ * first worker to see the reactor past the stop tag counts it down in
+ * `reactors_remaining`.
+ *
+ * @param single_writer Whether the schedule guarantees that only the calling
+ *  worker advances the reactor (ADV2), so that a plain store will do instead
+ *  of an atomic read-modify-write (ADV).
+ */
+static inline void _lf_sched_advance_reactor_tag(self_base_t* reactor, interval_t amount, bool single_writer) {
+    instant_t time;
+    if (single_writer) {
+        time = atomic_load_explicit(&reactor->tag_time, memory_order_relaxed) + amount;
+        atomic_store_explicit(&reactor->tag_time, time, memory_order_release);
+    } else {
+        time = atomic_fetch_add_explicit(&reactor->tag_time, amount, memory_order_release) + amount;
+    }
+
+    if (_lf_is_tag_after_stop_tag((tag_t) { .time = time, .microstep = 0 })
+            && !atomic_load_explicit(&reactor->reached_stop_tag, memory_order_relaxed)
+            && !atomic_exchange_explicit(&reactor->reached_stop_tag, true, memory_order_relaxed)) {
+        atomic_fetch_sub_explicit(&_lf_sched_instance->reactors_remaining, 1, memory_order_release);
+    }
+}
+
+#ifdef FS_PROFILE
+/**
+ * @brief The share of a worker's time from which the profile marks a line as
+ * hot.
+ */
+#ifndef LF_SCHED_PROFILE_HOT_PERCENT
+#define LF_SCHED_PROFILE_HOT_PERCENT 10
+#endif
+
+/**
+ * @brief Read the clock that the profiler measures with: the time stamp
+ * counter where there is one, and physical time in nanoseconds elsewhere.
+ */
+static inline uint64_t _lf_sched_profile_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t ticks;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(ticks));
+    return ticks;
+#else
+    return (uint64_t)_lf_sched_clock_now();
+#endif
+}
+
+/**
+ * @brief Called when a worker enters the VM loop. Charges the time since it
+ * last left the loop with a reaction to the instruction that returned it.
+ *
+ * @return The time of entry.
+ */
+static inline uint64_t _lf_sched_profile_enter(size_t worker_number) {
+    lf_sched_worker_profile_t* profile = &_lf_sched_context(worker_number)->profile;
+    uint64_t now = _lf_sched_profile_ticks();
+    if (profile->returned_pc != SIZE_MAX) {
+        profile->lines[profile->returned_pc].reaction_ticks += now - profile->returned_at;
+        profile->returned_pc = SIZE_MAX;
+    }
+    return now;
+}
+
+/**
+ * @brief Called before a worker executes the instruction at `pc`. Charges
+ * the time since the previous call to the previous instruction.
+ */
+static inline void _lf_sched_profile_step(size_t worker_number, size_t* previous_pc,
+                                          uint64_t* previous_ticks, size_t pc) {
+    lf_sched_worker_profile_t* profile = &_lf_sched_context(worker_number)->profile;
+    uint64_t now = _lf_sched_profile_ticks();
+    if (*previous_pc != SIZE_MAX) {
+        lf_sched_line_profile_t* line = &profile->lines[*previous_pc];
+        line->count++;
+        line->ticks += now - *previous_ticks - profile->reaction_ticks;
+        profile->reaction_ticks = 0;
+    }
+    *previous_pc = pc;
+    *previous_ticks = now;
+}
+
+/**
+ * @brief Called when a worker leaves the VM loop. Charges the time of the
+ * last instruction, and remembers it if it returned a reaction.
+ */
+static inline void _lf_sched_profile_exit(size_t worker_number, size_t previous_pc,
+                                          uint64_t previous_ticks, bool returns_reaction) {
+    lf_sched_worker_profile_t* profile = &_lf_sched_context(worker_number)->profile;
+    uint64_t now = _lf_sched_profile_ticks();
+    if (previous_pc != SIZE_MAX) {
+        profile->lines[previous_pc].count++;
+        profile->lines[previous_pc].ticks += now - previous_ticks - profile->reaction_ticks;
+        profile->reaction_ticks = 0;
+    }
+    if (returns_reaction) {
+        profile->returned_pc = previous_pc;
+        profile->returned_at = now;
+    }
+}
+
+/**
+ * @brief Called after the superinstruction at `pc` has run a reaction that
+ * started at `start`. Charges the reaction to the line's reaction time
+ * rather than to its instruction time.
+ */
+static inline void _lf_sched_profile_reaction(size_t worker_number, size_t pc, uint64_t start) {
+    lf_sched_worker_profile_t* profile = &_lf_sched_context(worker_number)->profile;
+    uint64_t ticks = _lf_sched_profile_ticks() - start;
+    profile->lines[pc].reaction_ticks += ticks;
+    profile->reaction_ticks += ticks;
+}
+
+/**
+ * @brief Record how late the DU at `pc` released the worker.
+ */
+static inline void _lf_sched_profile_lateness(size_t worker_number, size_t pc, interval_t lateness) {
+    lf_sched_line_profile_t* line = &_lf_sched_context(worker_number)->profile.lines[pc];
+    if (lateness < 0) lateness = 0;
+    line->lateness = lateness > FOREVER - line->lateness ? FOREVER : line->lateness + lateness;
+    if (lateness > line->max_lateness) line->max_lateness = lateness;
+}
+
+#define _LF_SCHED_PROFILE_ENTER(worker_number) \
+    size_t _profile_pc = SIZE_MAX; \
+    uint64_t _profile_ticks = _lf_sched_profile_enter(worker_number)
+#define _LF_SCHED_PROFILE_STEP(worker_number, pc) \
+    _lf_sched_profile_step(worker_number, &_profile_pc, &_profile_ticks, pc)
+#define _LF_SCHED_PROFILE_EXIT(worker_number, returned_reaction) \
+    _lf_sched_profile_exit(worker_number, _profile_pc, _profile_ticks, (returned_reaction) != NULL)
+#define _LF_SCHED_PROFILE_LATENESS(worker_number, pc, lateness) \
+    _lf_sched_profile_lateness(worker_number, pc, lateness)
+#else
+#define _LF_SCHED_PROFILE_ENTER(worker_number)
+#define _LF_SCHED_PROFILE_STEP(worker_number, pc)
+#define _LF_SCHED_PROFILE_EXIT(worker_number, returned_reaction)
+#define _LF_SCHED_PROFILE_LATENESS(worker_number, pc, lateness) (void)(lateness)
+#endif
+
+/**
+ * @brief Run a reaction on the worker without leaving the VM loop, as
+ * `_lf_worker_do_work()` would after getting it from the scheduler. This is
+ * how the superinstruction at `pc` executes its reaction.
+ */
+static inline void _lf_sched_run_reaction(size_t worker_number, size_t pc, reaction_t* reaction) {
+#ifdef FS_PROFILE
+    uint64_t start = _lf_sched_profile_ticks();
+#endif
+    if (!_lf_worker_handle_violations(worker_number, reaction)) {
+        _lf_worker_invoke_reaction(worker_number, reaction);
+    }
+    lf_sched_done_with_reaction(worker_number, reaction);
+#ifdef FS_PROFILE
+    _lf_sched_profile_reaction(worker_number, pc, start);
+#endif
+}
+
+/**
+ * @brief BNM: whether a mode and the modes enclosing it are the current
+ * modes of their reactors, which is always so without modal reactors. The
+ * modes only change at the end of a hyperperiod (see
+ * `_lf_sched_change_modes()`), so all workers get the same answer
+ * throughout a hyperperiod.
+ */
+static inline bool _lf_sched_mode_is_active(reactor_mode_t* mode) {
+#ifdef MODAL_REACTORS
+    return _lf_mode_is_active(mode);
+#else
+    return true;
+#endif
+}
+
+/**
+ * @brief Compare two reactions by address, for `qsort()` and `bsearch()`.
+ */
+static int _lf_sched_compare_reactions(const void* a, const void* b) {
+    uintptr_t x = (uintptr_t)*(reaction_t* const*)a;
+    uintptr_t y = (uintptr_t)*(reaction_t* const*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * @brief Whether a reaction is sporadic, i.e., triggering it queues it for
+ * SRV (see scheduler_instructions.h).
+ */
+static bool _lf_sched_is_sporadic(reaction_t* reaction) {
+    return _lf_sched_instance->num_sporadic_reactions > 0
+        && bsearch(&reaction, _lf_sched_instance->sporadic_reactions, _lf_sched_instance->num_sporadic_reactions,
+                   sizeof(reaction_t*), _lf_sched_compare_reactions) != NULL;
+}
+
+/**
+ * @brief SRV: run triggered sporadic reactions on the worker, highest
+ * priority first, until there are none left or `budget` has passed. A
+ * reaction that has started runs to completion.
+ *
+ * @param pc The SRV, which the profiler charges the reactions to.
+ */
+static void _lf_sched_serve_sporadic(size_t worker_number, size_t pc, interval_t budget) {
+    if (atomic_load_explicit(&_lf_sched_instance->sporadic_pending, memory_order_relaxed) == 0) return;
+    instant_t now = _lf_sched_clock_now();
+    instant_t end = budget > FOREVER - now ? FOREVER : now + budget;
+    lf_mutex_t* queue_mutex = &_lf_sched_instance->_lf_sched_array_of_mutexes[0];
+    do {
+        lf_mutex_lock(queue_mutex);
+        reaction_t* reaction = (reaction_t*)pqueue_pop((pqueue_t*)_lf_sched_instance->_lf_sched_triggered_reactions);
+        if (reaction != NULL) {
+            atomic_fetch_sub_explicit(&_lf_sched_instance->sporadic_pending, 1, memory_order_relaxed);
+        }
+        lf_mutex_unlock(queue_mutex);
+        if (reaction == NULL) return;
+        LF_PRINT_DEBUG("Worker %zu serving sporadic reaction %s.", worker_number, reaction->name);
+        _lf_sched_run_reaction(worker_number, pc, reaction);
+    } while (_lf_sched_clock_now() < end);
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG || defined(FS_PROFILE)
+/** The names of the opcodes, for printing instructions. */
+static const char* const _lf_sched_opcode_names[] = {
+    [ADV]   = "ADV",
+    [ADV2]  = "ADV2",
+    [BIT]   = "BIT",
+    [DU]    = "DU",
+    [EIT]   = "EIT",
+    [EXE]   = "EXE",
+    [INC]   = "INC",
+    [INC2]  = "INC2",
+    [JMP]   = "JMP",
+    [SAC]   = "SAC",
+    [STP]   = "STP",
+    [WU]    = "WU",
+    [ADDI]  = "ADDI",
+    [BEQ]   = "BEQ",
+    [BNE]   = "BNE",
+    [BLT]   = "BLT",
+    [BNT]   = "BNT",
+    [SRV]   = "SRV",
+    [BNM]   = "BNM",
+    [EXE_INC]       = "EXE_INC",
+    [EXE_ADV]       = "EXE_ADV",
+    [EXE_INC_ADV]   = "EXE_INC_ADV",
+    [WU_EIT]        = "WU_EIT",
+};
+#endif
+
+/**
+ * @brief Print the instruction a worker is about to execute.
+ *
+ * Only compiled in when debug logging is enabled so that the dispatch loops
+ * do no per-instruction bookkeeping in release builds. Decoded programs keep
+ * the instruction numbering of the static schedules, so the instruction is
+ * printed as it appears in the schedule file.
+ */
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define _LF_SCHED_PRINT_INST(worker_number, pc) \
+    LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld", \
+                    (size_t)(worker_number), (size_t)(pc), \
+                    _lf_sched_opcode_names[_lf_sched_instance->static_schedules[worker_number][pc].op], \
+                    _lf_sched_instance->static_schedules[worker_number][pc].rs1, \
+                    _lf_sched_instance->static_schedules[worker_number][pc].rs2)
+#else
+#define _LF_SCHED_PRINT_INST(worker_number, pc)
+#endif
 
-#include "platform.h"
-#include "reactor_common.h"
-#include "scheduler_instance.h"
-#include "scheduler_sync_tag_advance.h"
-#include "scheduler.h"
-#include "semaphore.h"
-#include "trace.h"
-#include "util.h"
+///////////////////// Program Loading /////////////////////////
 
-/////////////////// External Variables /////////////////////////
-extern lf_mutex_t mutex;
-extern const inst_t* static_schedules[];
-extern volatile uint32_t hyperperiod_iterations[];
-extern volatile uint32_t counters[];
-extern const size_t num_counters;
-extern tag_t current_tag;
-extern tag_t stop_tag;
-extern instant_t start_time;
+/**
+ * @brief Allocate the counters, each aligned to `FS_COUNTER_ALIGNMENT`, and
+ * set them to 0.
+ */
+static lf_sched_counter_t* _lf_sched_new_counters(size_t num_counters) {
+    // aligned_alloc() wants a size that is a multiple of the alignment, which
+    // sizeof already is, but not 0.
+    size_t size = (num_counters > 0 ? num_counters : 1) * sizeof(lf_sched_counter_t);
+    lf_sched_counter_t* counters = aligned_alloc(_Alignof(lf_sched_counter_t), size);
+    if (counters == NULL) {
+        lf_print_error_and_exit("Out of memory while allocating %zu counters.", num_counters);
+    }
+    for (size_t i = 0; i < num_counters; i++) {
+        atomic_init(&counters[i].value, 0);
+        atomic_init(&counters[i].waiters, 0);
+        counters[i].per_epoch = 0;
+    }
+    return counters;
+}
 
-/////////////////// Scheduler Variables and Structs /////////////////////////
-_lf_sched_instance_t* _lf_sched_instance;
+/**
+ * @brief Build the combining tree that the workers synchronize with in SAC.
+ *
+ * Worker w arrives at node w / `LF_SCHED_BARRIER_FANIN`. The nodes are stored
+ * level by level from the leaves, and the last node is the root.
+ */
+static lf_sched_barrier_node_t* _lf_sched_new_barrier(size_t num_workers) {
+    // A tree over n children has fewer than n nodes, plus one for n = 1.
+    size_t size = (num_workers + 1) * sizeof(lf_sched_barrier_node_t);
+    lf_sched_barrier_node_t* nodes = aligned_alloc(_Alignof(lf_sched_barrier_node_t), size);
+    if (nodes == NULL) {
+        lf_print_error_and_exit("Out of memory while allocating the SAC barrier.");
+    }
+    size_t level_start = 0;
+    size_t children = num_workers;
+    for (;;) {
+        size_t level_size = (children + LF_SCHED_BARRIER_FANIN - 1) / LF_SCHED_BARRIER_FANIN;
+        for (size_t i = 0; i < level_size; i++) {
+            lf_sched_barrier_node_t* node = &nodes[level_start + i];
+            atomic_init(&node->arrived, 0);
+            node->expected = (i + 1) * LF_SCHED_BARRIER_FANIN <= children
+                ? LF_SCHED_BARRIER_FANIN : children - i * LF_SCHED_BARRIER_FANIN;
+            node->parent = level_size == 1
+                ? LF_SCHED_BARRIER_ROOT : level_start + level_size + i / LF_SCHED_BARRIER_FANIN;
+        }
+        if (level_size == 1) break;
+        level_start += level_size;
+        children = level_size;
+    }
+    return nodes;
+}
 
-/////////////////// Scheduler Private API /////////////////////////
+/**
+ * @brief Allocate the execution contexts of the workers in
+ * `staged_contexts`, each aligned to `FS_CONTEXT_ALIGNMENT`, and point the
+ * workers at them until they load their own (see `_lf_sched_load_context()`).
+ */
+static void _lf_sched_new_contexts(size_t num_workers) {
+    // sizeof is a multiple of the alignment, as aligned_alloc() wants.
+    size_t size = num_workers * sizeof(lf_sched_worker_context_t);
+    lf_sched_worker_context_t* contexts = aligned_alloc(_Alignof(lf_sched_worker_context_t), size);
+    _lf_sched_instance->contexts = calloc(num_workers, sizeof(lf_sched_worker_context_t*));
+    if (contexts == NULL || _lf_sched_instance->contexts == NULL) {
+        lf_print_error_and_exit("Out of memory while allocating the worker contexts.");
+    }
+    memset(contexts, 0, size);
+    for (size_t w = 0; w < num_workers; w++) {
+        contexts[w].loop_end = STATIC_SCHEDULE_NO_LOOP;
+        contexts[w].loop_exit = SIZE_MAX;
+        _lf_sched_instance->contexts[w] = &contexts[w];
+    }
+    _lf_sched_instance->staged_contexts = contexts;
+}
+
+#ifdef FS_PROFILE
+static void _lf_sched_print_profile();
+
+/**
+ * @brief Give the context of every worker a zeroed profile, with the lines
+ * in cache lines of their own, and print the profiles when the program
+ * exits.
+ */
+static void _lf_sched_new_profiles(size_t num_workers) {
+    for (size_t w = 0; w < num_workers; w++) {
+        lf_sched_worker_profile_t* profile = &_lf_sched_instance->staged_contexts[w].profile;
+        // Round up so that the lines of different workers never share a cache line.
+        size_t size = _lf_sched_instance->program_lengths[w] * sizeof(lf_sched_line_profile_t);
+        size = (size / LF_SCHED_CACHE_LINE_SIZE + 1) * LF_SCHED_CACHE_LINE_SIZE;
+        profile->lines = aligned_alloc(LF_SCHED_CACHE_LINE_SIZE, size);
+        if (profile->lines == NULL) {
+            lf_print_error_and_exit("Out of memory while allocating the profiles.");
+        }
+        memset(profile->lines, 0, size);
+        profile->returned_pc = SIZE_MAX;
+        profile->returned_at = 0;
+        profile->reaction_ticks = 0;
+    }
+    _lf_sched_instance->profile_start_ticks = _lf_sched_profile_ticks();
+    _lf_sched_instance->profile_start_time = lf_time_physical();
+    // Also print the profile if the program is stopped with Ctrl-C, which
+    // exits without freeing the scheduler.
+    atexit(_lf_sched_print_profile);
+}
+#endif
+
+/**
+ * @brief The schedules that the workers run, with the tables and bases of
+ * the schedule file if there is one.
+ */
+static static_schedule_t _lf_sched_current_schedules() {
+    static_schedule_t schedule = {
+        .num_workers = _lf_sched_instance->_lf_sched_number_of_workers,
+        .schedules = _lf_sched_instance->static_schedules,
+        .schedule_lengths = _lf_sched_instance->program_lengths,
+        .num_counters = _lf_sched_instance->num_counters,
+        .wait_policy = _lf_sched_instance->wait_policy,
+    };
+    static_schedule_t* file = _lf_sched_instance->schedule_file;
+    if (file != NULL) {
+        schedule.num_reactions = file->num_reactions;
+        schedule.reaction_table = file->reaction_table;
+        schedule.num_reactors = file->num_reactors;
+        schedule.reactor_table = file->reactor_table;
+        schedule.reaction_bases = file->reaction_bases;
+        schedule.reactor_bases = file->reactor_bases;
+    }
+    return schedule;
+}
 
 /**
- * @brief If there is work to be done, notify workers individually.
+ * @brief Replace the schedules with their hyperperiod unrolled `factor`
+ * times (see static_schedule_unroll.h).
  *
- * This assumes that the caller is not holding any thread mutexes.
+ * Schedules that cannot be unrolled run as they are.
+ */
+static void _lf_sched_unroll_schedules(size_t factor) {
+    static_schedule_t schedule = _lf_sched_current_schedules();
+    static_schedule_t* unrolled = calloc(1, sizeof(static_schedule_t));
+    const char* error = "out of memory";
+    if (unrolled == NULL || static_schedule_unroll(&schedule, factor, unrolled, &error) != 0) {
+        lf_print_warning("Cannot unroll the static schedule %zu times: %s. Running it as is.", factor, error);
+        free(unrolled);
+        return;
+    }
+    _lf_sched_instance->unrolled_schedule = unrolled;
+    _lf_sched_instance->static_schedules = unrolled->schedules;
+    for (size_t i = 0; i < unrolled->num_workers; i++) {
+        _lf_sched_instance->program_lengths[i] = unrolled->schedule_lengths[i];
+    }
+    lf_print("Unrolled the hyperperiod of the static schedule %zu times.", factor);
+}
+
+/**
+ * @brief Print a problem found by the schedule verifier.
  */
-void _lf_sched_notify_workers() {
-    // Note: All threads are idle. Therefore, there is no need to lock the mutex
-    // while accessing the executing queue (which is pointing to one of the
-    // reaction queues).
-    size_t workers_to_awaken = 
-        _lf_sched_instance->_lf_sched_number_of_idle_workers;
-    LF_PRINT_DEBUG("Scheduler: Notifying %zu workers.", workers_to_awaken);
-    _lf_sched_instance->_lf_sched_number_of_idle_workers -= workers_to_awaken;
-    LF_PRINT_DEBUG("Scheduler: New number of idle workers: %zu.",
-                _lf_sched_instance->_lf_sched_number_of_idle_workers);
-    if (workers_to_awaken > 1) {
-        // Notify all the workers except the worker thread that has called this
-        // function.
-        lf_semaphore_release(_lf_sched_instance->_lf_sched_semaphore,
-                             (workers_to_awaken - 1));
+static void _lf_sched_report_problem(void* user_data, size_t worker, size_t line, const char* message) {
+    if (worker == STATIC_SCHEDULE_NO_LOCATION) {
+        lf_print_error("Static schedule: %s.", message);
+    } else if (line == STATIC_SCHEDULE_NO_LOCATION) {
+        lf_print_error("Worker %zu: %s.", worker, message);
+    } else {
+        lf_print_error("Worker %zu, line %zu: %s.", worker, line, message);
     }
 }
 
 /**
- * @brief Wait until the scheduler assigns work.
+ * @brief Verify a set of static schedules.
  *
- * If the calling worker thread is the last to become idle, it will call on the
- * scheduler to distribute work. Otherwise, it will wait on
- * '_lf_sched_instance->_lf_sched_semaphore'.
+ * Bad operands, unequal numbers of SACs, WUs that can never be satisfied,
+ * and INC2 counters with several writers would otherwise show up as hangs or
+ * memory corruption at run time, so the schedules must not be run if any
+ * problem is found.
  *
- * @param worker_number The worker number of the worker thread asking for work
- * to be assigned to it.
+ * @return The number of problems, which have been printed.
  */
-void _lf_sched_wait_for_work(size_t worker_number) {
-    // Increment the number of idle workers by 1 and
-    // check if this is the last worker thread to become idle.
-    if (lf_atomic_add_fetch(&_lf_sched_instance->_lf_sched_number_of_idle_workers,
-                            1) ==
-        _lf_sched_instance->_lf_sched_number_of_workers) {
-        // Last thread to go idle
-        LF_PRINT_DEBUG("Scheduler: Worker %zu is the last idle thread.",
-                    worker_number);
-        // Clear all the counters.
-        for (int i = 0; i < num_counters; i++) {
-            counters[i] = 0;
-        }
-        // Call on the scheduler to distribute work or advance tag.
-        _lf_sched_notify_workers();
+static int _lf_sched_verify_schedules(const static_schedule_t* schedule) {
+    return static_schedule_verify(schedule,
+                                  _lf_sched_instance->num_reaction_instances,
+                                  _lf_sched_instance->num_reactor_self_instances,
+                                  _lf_sched_report_problem, NULL);
+}
+
+/**
+ * @brief Find the JMP that closes the loop of a schedule and where a worker
+ * that stops goes, i.e., the target of the BIT at the loop head, or SIZE_MAX
+ * if the loop has no BIT.
+ */
+static void _lf_sched_find_loop(const inst_t* schedule, size_t length, size_t* loop_end, size_t* loop_exit) {
+    size_t end = static_schedule_loop_end(schedule, length);
+    *loop_end = end;
+    *loop_exit = SIZE_MAX;
+    if (end != STATIC_SCHEDULE_NO_LOOP && schedule[schedule[end].rs1].op == BIT) {
+        *loop_exit = schedule[schedule[end].rs1].rs1;
+    }
+}
+
+/**
+ * @brief Find how much each counter grows per epoch (see
+ * `static_schedule_counter_offsets()`).
+ *
+ * The schedules must have been verified.
+ *
+ * @param schedule The schedules.
+ * @param counters Their `schedule->num_counters` counters, whose `per_epoch`
+ *  is set.
+ * @return The base of each counter, for `_lf_sched_decode_schedule()`. The
+ *  caller frees it.
+ */
+static unsigned long long* _lf_sched_prepare_epochs(const static_schedule_t* schedule, lf_sched_counter_t* counters) {
+    size_t num_counters = schedule->num_counters;
+    unsigned long long* base = malloc((num_counters + 1) * sizeof(unsigned long long));
+    unsigned long long* per_epoch = malloc((num_counters + 1) * sizeof(unsigned long long));
+    if (base == NULL || per_epoch == NULL) {
+        lf_print_error_and_exit("Out of memory while loading the schedule.");
+    }
+    static_schedule_counter_offsets(schedule, base, per_epoch);
+    for (size_t c = 0; c < num_counters; c++) {
+        counters[c].per_epoch = per_epoch[c];
+    }
+    free(per_epoch);
+    return base;
+}
+
+#if FS_FUSE && !defined(FS_COMPILED)
+/**
+ * @brief Fuse common instruction sequences of a decoded program into
+ * superinstructions (see scheduler_instructions.h).
+ *
+ * Sequences are matched greedily from the start, longest first, and do not
+ * overlap. Only the opcode of the first instruction of a sequence changes.
+ *
+ * @return The number of superinstructions.
+ */
+static size_t _lf_sched_fuse_program(decoded_inst_t* program, size_t length) {
+    size_t fused = 0;
+    for (size_t pc = 0; pc < length; pc++) {
+        unsigned int next = pc + 1 < length ? program[pc + 1].op : STP;
+        unsigned int after = pc + 2 < length ? program[pc + 2].op : STP;
+        unsigned int op = inst_fuse(program[pc].op, next, after);
+        if (op == program[pc].op) continue;
+        program[pc].op = op;
+        pc += inst_length(op) - 1;
+        fused++;
+    }
+    return fused;
+}
+#endif
+
+/**
+ * @brief Which reactions a set of verified schedules leaves to SRV: if any
+ * schedule has an SRV, those that no schedule names, and none otherwise.
+ *
+ * @return A newly allocated array with an entry per reaction.
+ */
+static bool* _lf_sched_find_sporadic_flags(const static_schedule_t* schedules) {
+    size_t num_reactions = _lf_sched_instance->num_reaction_instances;
+    bool* named = calloc(num_reactions + 1, sizeof(bool));
+    if (named == NULL) {
+        lf_print_error_and_exit("Out of memory while looking for sporadic reactions.");
+    }
+    bool serves = false;
+    for (size_t w = 0; w < schedules->num_workers; w++) {
+        const inst_t* schedule = schedules->schedules[w];
+        for (size_t pc = 0; pc < schedules->schedule_lengths[w]; pc++) {
+            switch (schedule[pc].op) {
+                case EIT:
+                case EXE:
+                    named[static_schedule_reaction_index(schedules, w, schedule[pc].rs1)] = true;
+                    break;
+                case BNT:
+                    named[static_schedule_reaction_index(schedules, w, schedule[pc].rs2)] = true;
+                    break;
+                case SRV:
+                    serves = true;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    // Turn the names into the flags.
+    for (size_t i = 0; i < num_reactions; i++) {
+        named[i] = serves && !named[i];
+    }
+    return named;
+}
+
+/**
+ * @brief If any schedule has an SRV, collect the reactions that no schedule
+ * names into `sporadic_reactions` and set up the queue that triggering them
+ * puts them in (see scheduler_instructions.h).
+ */
+static void _lf_sched_find_sporadic_reactions() {
+    static_schedule_t schedules = _lf_sched_current_schedules();
+    size_t num_reactions = _lf_sched_instance->num_reaction_instances;
+    bool* flags = _lf_sched_find_sporadic_flags(&schedules);
+    size_t count = 0;
+    reaction_t** sporadic = malloc((num_reactions + 1) * sizeof(reaction_t*));
+    if (sporadic == NULL) {
+        lf_print_error_and_exit("Out of memory while looking for sporadic reactions.");
+    }
+    for (size_t i = 0; i < num_reactions; i++) {
+        if (flags[i]) sporadic[count++] = _lf_sched_instance->reaction_instances[i];
+    }
+    free(flags);
+    if (count == 0) {
+        free(sporadic);
+        return;
+    }
+
+    _lf_sched_instance->_lf_sched_array_of_mutexes = calloc(1, sizeof(lf_mutex_t));
+    if (_lf_sched_instance->_lf_sched_array_of_mutexes == NULL) {
+        lf_print_error_and_exit("Out of memory while setting up the sporadic reactions.");
+    }
+    qsort(sporadic, count, sizeof(reaction_t*), _lf_sched_compare_reactions);
+    _lf_sched_instance->sporadic_reactions = sporadic;
+    _lf_sched_instance->num_sporadic_reactions = count;
+    // Every sporadic reaction is in the queue at most once, since only
+    // triggering an inactive reaction inserts it.
+    _lf_sched_instance->_lf_sched_triggered_reactions = pqueue_init(
+        count, in_reverse_order, get_reaction_index, get_reaction_position, set_reaction_position,
+        reaction_matches, print_reaction);
+    lf_mutex_init(&_lf_sched_instance->_lf_sched_array_of_mutexes[0]);
+    LF_PRINT_LOG("Scheduler: %zu sporadic reactions are served by SRV.", count);
+}
+
+#ifndef FS_COMPILED
+/**
+ * @brief Decode the static schedule of a worker.
+ *
+ * The schedule must have been verified by `_lf_sched_verify_schedules()`,
+ * so only the range of rs2, which is narrower in a decoded instruction, is
+ * checked here. A WU in the worker's loop gets the base of its counter
+ * added, so that only the epoch remains to be added at run time.
+ *
+ * @param schedules The schedules of all workers.
+ * @param worker_number The worker whose schedule to decode.
+ * @param loop_end The JMP that closes the worker's loop (see
+ *  `_lf_sched_find_loop()`).
+ * @param base The base of each counter (see
+ *  `static_schedule_counter_offsets()`).
+ * @param counters The counters that INC, INC2, and WU refer to.
+ * @return A newly allocated array of `schedule_lengths[worker_number]`
+ *  decoded instructions, or NULL if an rs2 is out of range, which has been
+ *  printed.
+ */
+static decoded_inst_t* _lf_sched_decode_schedule(const static_schedule_t* schedules, size_t worker_number,
+                                                 size_t loop_end, const unsigned long long* base,
+                                                 lf_sched_counter_t* counters) {
+    const inst_t* schedule = schedules->schedules[worker_number];
+    size_t length = schedules->schedule_lengths[worker_number];
+    size_t loop_head = loop_end == STATIC_SCHEDULE_NO_LOOP ? length : (size_t)schedule[loop_end].rs1;
+    decoded_inst_t* program = calloc(length, sizeof(decoded_inst_t));
+    if (program == NULL) {
+        lf_print_error_and_exit("Out of memory while loading the schedule of worker %zu.", worker_number);
+    }
+
+    for (size_t pc = 0; pc < length; pc++) {
+        long long int rs1 = schedule[pc].rs1;
+        long long int rs2 = schedule[pc].rs2;
+        if (schedule[pc].op == WU && pc >= loop_head
+                && rs2 >= DECODED_INST_RS2_MIN && rs2 <= DECODED_INST_RS2_MAX) {
+            // A target that does not fit fails the range check below.
+            bool fits = base[rs1] <= (unsigned long long)(DECODED_INST_RS2_MAX - rs2);
+            rs2 = fits ? rs2 + (long long int)base[rs1] : DECODED_INST_RS2_MAX + 1;
+        }
+        if (rs2 < DECODED_INST_RS2_MIN || rs2 > DECODED_INST_RS2_MAX) {
+            lf_print_error("Worker %zu, line %zu: rs2 (%lld) is out of range.", worker_number, pc, rs2);
+            free(program);
+            return NULL;
+        }
+        program[pc].op = schedule[pc].op;
+        program[pc].rs2 = rs2;
+        switch (schedule[pc].op) {
+            case EIT:
+            case EXE:
+                rs1 = static_schedule_reaction_index(schedules, worker_number, rs1);
+                program[pc].rs1.reaction = _lf_sched_instance->reaction_instances[rs1];
+                break;
+            case ADV:
+            case ADV2:
+                rs1 = static_schedule_reactor_index(schedules, worker_number, rs1);
+                program[pc].rs1.reactor = _lf_sched_instance->reactor_self_instances[rs1];
+                break;
+            case INC:
+            case INC2:
+            case WU:
+                program[pc].rs1.counter = &counters[rs1];
+                break;
+            case BIT:
+            case JMP:
+            case BEQ:
+            case BNE:
+            case BLT:
+                program[pc].rs1.target = rs1;
+                break;
+            case BNT:
+                // The target fits rs2, since it is within the schedule.
+                rs2 = static_schedule_reaction_index(schedules, worker_number, rs2);
+                program[pc].rs1.reaction = _lf_sched_instance->reaction_instances[rs2];
+                program[pc].rs2 = rs1;
+                break;
+            case BNM:
+                // Like BNT, but with the mode of the reaction.
+                rs2 = static_schedule_reaction_index(schedules, worker_number, rs2);
+                program[pc].rs1.mode = _lf_sched_instance->reaction_instances[rs2]->mode;
+                program[pc].rs2 = rs1;
+                break;
+            default:
+                program[pc].rs1.value = rs1;
+                break;
+        }
+    }
+#if FS_FUSE
+    size_t fused = _lf_sched_fuse_program(program, length);
+    LF_PRINT_LOG("Worker %zu: fused %zu instruction sequences.", worker_number, fused);
+#endif
+    return program;
+}
+
+/**
+ * @brief Move the decoded program that waits for a worker in
+ * `staged_programs` into memory allocated by the worker itself, and point
+ * the worker's context at it.
+ *
+ * The program is aligned to a cache line and padded to a whole number of
+ * cache lines so that it shares no line with other data.
+ */
+static void _lf_sched_load_program(size_t worker_number, lf_sched_worker_context_t* context) {
+    size_t length = _lf_sched_instance->program_lengths[worker_number];
+    size_t size = length * sizeof(decoded_inst_t);
+    size = (size + LF_SCHED_CACHE_LINE_SIZE - 1) / LF_SCHED_CACHE_LINE_SIZE * LF_SCHED_CACHE_LINE_SIZE;
+    decoded_inst_t* program = aligned_alloc(LF_SCHED_CACHE_LINE_SIZE, size);
+    if (program == NULL) {
+        lf_print_error_and_exit("Out of memory while loading the schedule of worker %zu.", worker_number);
+    }
+    memcpy(program, _lf_sched_instance->staged_programs[worker_number], length * sizeof(decoded_inst_t));
+    free(_lf_sched_instance->staged_programs[worker_number]);
+    _lf_sched_instance->staged_programs[worker_number] = NULL;
+    context->program = program;
+    LF_PRINT_DEBUG("Worker %zu loaded %zu instructions (%zu bytes).", worker_number, length, size);
+}
+#endif
+
+/**
+ * @brief Move the context and the decoded program of a worker into memory
+ * allocated by the worker itself.
+ *
+ * This is called by the worker thread, so on systems with a first-touch
+ * page placement policy both end up in the memory of the node that the
+ * worker runs on (see `_lf_sched_load_program()`). With an
+ * `FS_CONTEXT_ALIGNMENT` below a cache line, contexts stay packed in
+ * `staged_contexts`.
+ */
+static lf_sched_worker_context_t* _lf_sched_load_context(size_t worker_number) {
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+#if FS_CONTEXT_ALIGNMENT >= LF_SCHED_CACHE_LINE_SIZE
+    lf_sched_worker_context_t* staged = context;
+    context = aligned_alloc(_Alignof(lf_sched_worker_context_t), sizeof(lf_sched_worker_context_t));
+    if (context == NULL) {
+        lf_print_error_and_exit("Out of memory while loading the context of worker %zu.", worker_number);
+    }
+    memcpy(context, staged, sizeof(lf_sched_worker_context_t));
+#endif
+    context->loaded = true;
+#ifndef FS_COMPILED
+    _lf_sched_load_program(worker_number, context);
+#endif
+    _lf_sched_instance->contexts[worker_number] = context;
+    return context;
+}
+
+///////////////////// Schedule Swaps /////////////////////////
+// See scheduler_swap.h.
+
+#ifdef FS_WAIT_STATS
+static void _lf_sched_print_wait_stats(const lf_sched_wait_stats_t* wait_stats, size_t num_counters);
+#endif
+
+/** Serializes `lf_sched_stage_schedule()`. */
+static lf_mutex_t _lf_sched_stage_mutex;
+
+/**
+ * @brief Why a set of verified schedules has no point at the end of every
+ * hyperperiod where all workers wait, i.e., a SAC right before the JMP that
+ * closes the loop of every worker, or NULL if it has.
+ */
+static const char* _lf_sched_boundary_problem(const static_schedule_t* schedule) {
+    for (size_t w = 0; w < schedule->num_workers; w++) {
+        const inst_t* insts = schedule->schedules[w];
+        size_t end = static_schedule_loop_end(insts, schedule->schedule_lengths[w]);
+        if (end == STATIC_SCHEDULE_NO_LOOP) {
+            return "a worker has no loop";
+        }
+        if (end == 0 || insts[end - 1].op != SAC) {
+            return "a worker does not end its loop with SAC and JMP";
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Why the workers cannot switch to or from a set of verified
+ * schedules at the end of a hyperperiod, or NULL if they can.
+ *
+ * @param schedule The schedules.
+ * @param hyperperiod Set to the period of their DUs, or 0 if they have none.
+ */
+static const char* _lf_sched_swap_problem(const static_schedule_t* schedule, interval_t* hyperperiod) {
+    *hyperperiod = 0;
+    const char* problem = _lf_sched_boundary_problem(schedule);
+    if (problem != NULL) return problem;
+    long long int step = 0;
+    for (size_t w = 0; w < schedule->num_workers; w++) {
+        const inst_t* insts = schedule->schedules[w];
+        size_t length = schedule->schedule_lengths[w];
+        size_t end = static_schedule_loop_end(insts, length);
+        long long int iterations = insts[end].rs2 > 0 ? insts[end].rs2 : 0;
+        if (w > 0 && iterations != step) {
+            return "the workers advance the hyperperiod iteration by different amounts";
+        }
+        step = iterations;
+        for (size_t pc = 0; pc < length; pc++) {
+            if (insts[pc].op != DU || insts[pc].rs1 <= 0) continue;
+            if (*hyperperiod != 0 && insts[pc].rs1 != *hyperperiod) {
+                return "the DUs have different periods";
+            }
+            *hyperperiod = insts[pc].rs1;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Free a staged schedule set, or what the workers ran before a swap.
+ */
+static void _lf_sched_free_staged_schedule(lf_sched_staged_schedule_t* staged) {
+    if (staged->programs != NULL) {
+        for (size_t w = 0; w < _lf_sched_instance->_lf_sched_number_of_workers; w++) {
+            free(staged->programs[w]);
+        }
+    }
+    free(staged->programs);
+    free(staged->lengths);
+    free(staged->counters);
+    if (staged->unrolled != NULL) {
+        static_schedule_unroll_free(staged->unrolled);
+        free(staged->unrolled);
+    }
+    if (staged->file != NULL) {
+        static_schedule_unmap(staged->file);
+        free(staged->file);
+    }
+#ifdef FS_WAIT_STATS
+    free(staged->wait_stats);
+#endif
+    free(staged);
+}
+
+/**
+ * @brief Free what the workers ran before the swaps so far.
+ */
+static void _lf_sched_free_retired_schedules() {
+    lf_sched_staged_schedule_t* retired =
+        atomic_exchange_explicit(&_lf_sched_instance->retired_schedules, NULL, memory_order_acquire);
+    while (retired != NULL) {
+        lf_sched_staged_schedule_t* next = retired->next;
+#ifdef FS_WAIT_STATS
+        lf_print("Wait statistics of a schedule that was swapped out:");
+        _lf_sched_print_wait_stats(retired->wait_stats, retired->num_counters);
+#endif
+        _lf_sched_free_staged_schedule(retired);
+        retired = next;
+    }
+}
+
+#if !defined(FS_COMPILED) && !defined(FS_PROFILE)
+/**
+ * @brief Load, verify, and decode a schedule file for the workers to switch
+ * to.
+ *
+ * @return The staged schedules, or NULL with `error` set.
+ */
+static lf_sched_staged_schedule_t* _lf_sched_load_staged_schedule(const char* path, const char** error) {
+    size_t num_workers = _lf_sched_instance->_lf_sched_number_of_workers;
+    lf_sched_staged_schedule_t* staged = calloc(1, sizeof(lf_sched_staged_schedule_t));
+    if (staged == NULL || (staged->file = calloc(1, sizeof(static_schedule_t))) == NULL) {
+        lf_print_error_and_exit("Out of memory while staging a schedule.");
+    }
+    if (static_schedule_map(path, staged->file, error) != 0) {
+        free(staged->file);
+        staged->file = NULL;
+        _lf_sched_free_staged_schedule(staged);
+        return NULL;
+    }
+    if (staged->file->num_workers != num_workers) {
+        *error = "the schedule is for a different number of workers";
+        _lf_sched_free_staged_schedule(staged);
+        return NULL;
+    }
+    static_schedule_t schedule = *staged->file;
+    if (static_schedule_unroll_factor > 1) {
+        static_schedule_t* unrolled = calloc(1, sizeof(static_schedule_t));
+        const char* unroll_error = "out of memory";
+        if (unrolled == NULL || static_schedule_unroll(&schedule, static_schedule_unroll_factor, unrolled, &unroll_error) != 0) {
+            lf_print_warning("Cannot unroll the static schedule in %s %zu times: %s. Running it as is.",
+                             path, static_schedule_unroll_factor, unroll_error);
+            free(unrolled);
+        } else {
+            staged->unrolled = unrolled;
+            schedule = *unrolled;
+        }
+    }
+
+    const char* problem = NULL;
+    if (_lf_sched_verify_schedules(&schedule) > 0) {
+        problem = "the schedule failed verification";
     } else {
-        // Not the last thread to become idle.
-        // Wait for work to be released.
-        lf_semaphore_acquire(_lf_sched_instance->_lf_sched_semaphore);
+        problem = _lf_sched_swap_problem(&schedule, &staged->hyperperiod);
+    }
+    if (problem == NULL) {
+        bool* flags = _lf_sched_find_sporadic_flags(&schedule);
+        for (size_t i = 0; i < _lf_sched_instance->num_reaction_instances; i++) {
+            if (flags[i] != _lf_sched_is_sporadic(_lf_sched_instance->reaction_instances[i])) {
+                problem = "the schedule leaves other reactions to SRV than the one that runs";
+                break;
+            }
+        }
+        free(flags);
+    }
+    if (problem != NULL) {
+        *error = problem;
+        _lf_sched_free_staged_schedule(staged);
+        return NULL;
+    }
+
+    // The workers start at the heads of their loops, so the counters start
+    // at what the code before the loops adds to them.
+    staged->num_counters = schedule.num_counters;
+    staged->counters = _lf_sched_new_counters(schedule.num_counters);
+    unsigned long long* base = _lf_sched_prepare_epochs(&schedule, staged->counters);
+    for (size_t c = 0; c < schedule.num_counters; c++) {
+        atomic_init(&staged->counters[c].value, base[c]);
+    }
+    staged->lengths = malloc(num_workers * sizeof(size_t));
+    staged->programs = calloc(num_workers, sizeof(decoded_inst_t*));
+    if (staged->lengths == NULL || staged->programs == NULL) {
+        lf_print_error_and_exit("Out of memory while staging a schedule.");
+    }
+    for (size_t w = 0; w < num_workers && problem == NULL; w++) {
+        size_t loop_end, loop_exit;
+        _lf_sched_find_loop(schedule.schedules[w], schedule.schedule_lengths[w], &loop_end, &loop_exit);
+        staged->lengths[w] = schedule.schedule_lengths[w];
+        staged->programs[w] = _lf_sched_decode_schedule(&schedule, w, loop_end, base, staged->counters);
+        if (staged->programs[w] == NULL) problem = "an operand is out of range";
+    }
+    free(base);
+    if (problem != NULL) {
+        *error = problem;
+        _lf_sched_free_staged_schedule(staged);
+        return NULL;
+    }
+#ifdef FS_WAIT_STATS
+    staged->wait_stats = calloc(num_workers * schedule.num_counters + 1, sizeof(lf_sched_wait_stats_t));
+    if (staged->wait_stats == NULL) {
+        lf_print_error_and_exit("Out of memory while staging a schedule.");
+    }
+#endif
+    return staged;
+}
+#endif
+
+int lf_sched_stage_schedule(const char* path, const char** error) {
+#if defined(FS_COMPILED)
+    *error = "compiled schedules cannot be swapped";
+    return -1;
+#elif defined(FS_PROFILE)
+    *error = "the profiles of FS_PROFILE are kept per line of the schedules loaded first";
+    return -1;
+#else
+    if (_lf_sched_instance == NULL || _lf_sched_instance->staged_programs == NULL) {
+        *error = "the scheduler is not initialized";
+        return -1;
+    }
+    if (_lf_sched_instance->swap_problem != NULL) {
+        *error = _lf_sched_instance->swap_problem;
+        return -1;
+    }
+    lf_mutex_lock(&_lf_sched_stage_mutex);
+    _lf_sched_free_retired_schedules();
+    lf_sched_staged_schedule_t* staged = _lf_sched_load_staged_schedule(path, error);
+    if (staged != NULL) {
+        lf_sched_staged_schedule_t* dropped =
+            atomic_exchange_explicit(&_lf_sched_instance->staged_schedule, staged, memory_order_release);
+        if (dropped != NULL) {
+            LF_PRINT_LOG("Scheduler: Dropped a staged schedule that the workers had not switched to yet.");
+            _lf_sched_free_staged_schedule(dropped);
+        }
+        lf_print("Staged the static schedule in %s.", path);
     }
+    lf_mutex_unlock(&_lf_sched_stage_mutex);
+    return staged != NULL ? 0 : -1;
+#endif
+}
+
+size_t lf_sched_schedule_swaps() {
+    return atomic_load_explicit(&_lf_sched_instance->swaps, memory_order_relaxed);
 }
 
 /**
- * @brief BIT: Branch If Timeout
- * Check if timeout is reached. If not, don't do anything.
- * If so, jump to a specified location (rs1).
- * 
- * FIXME: Should the timeout value be an operand?
- * FIXME: Use a global variable num_active_reactors instead of iterating over
- * a for loop.
+ * @brief Install the staged schedules, if any, for the workers to switch to
+ * when they leave the SAC at the end of the hyperperiod.
+ *
+ * Called by the last worker to arrive at that SAC, while the others wait, so
+ * this only swaps pointers. Whatever the workers ran before goes to
+ * `retired_schedules`, to be freed outside the barrier.
+ *
+ * @param next_iteration The hyperperiod iteration that the old schedules
+ *  would have run next.
  */
-void execute_inst_BIT(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
-    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    bool stop = true;
-    for (int i = 0; i < _lf_sched_instance->num_reactor_self_instances; i++) {
-        if (!_lf_sched_instance->reactor_reached_stop_tag[i]) {
-            stop = false;
-            break;
+static void _lf_sched_install_schedule(int next_iteration) {
+    lf_sched_staged_schedule_t* staged =
+        atomic_exchange_explicit(&_lf_sched_instance->staged_schedule, NULL, memory_order_acquire);
+    if (staged == NULL) return;
+
+    // A DU of period H in iteration i releases H * (i + 1) after the origin,
+    // so move the origin to where that makes the first hyperperiod of the new
+    // schedules start at the same time as the next one of the old.
+    long long int n = (long long int)next_iteration + 1;
+    if (staged->hyperperiod > 0 && _lf_sched_instance->hyperperiod > 0) {
+        _lf_sched_instance->release_offset += (_lf_sched_instance->hyperperiod - staged->hyperperiod) * n;
+    } else if (staged->hyperperiod > 0) {
+        // The old schedules did not follow physical time, so start now.
+        _lf_sched_instance->release_offset = _lf_sched_clock_now() - physical_start_time - staged->hyperperiod * n;
+    }
+
+    for (size_t w = 0; w < _lf_sched_instance->_lf_sched_number_of_workers; w++) {
+        _lf_sched_instance->program_lengths[w] = staged->lengths[w];
+        _lf_sched_instance->staged_programs[w] = staged->programs[w];
+        staged->programs[w] = NULL;
+    }
+    static_schedule_t* file = _lf_sched_instance->schedule_file;
+    _lf_sched_instance->schedule_file = staged->file;
+    staged->file = file;
+    static_schedule_t* unrolled = _lf_sched_instance->unrolled_schedule;
+    _lf_sched_instance->unrolled_schedule = staged->unrolled;
+    staged->unrolled = unrolled;
+    _lf_sched_instance->static_schedules = _lf_sched_instance->unrolled_schedule != NULL
+        ? _lf_sched_instance->unrolled_schedule->schedules : _lf_sched_instance->schedule_file->schedules;
+    lf_sched_counter_t* counters = _lf_sched_instance->counters;
+    _lf_sched_instance->counters = staged->counters;
+    staged->counters = counters;
+    size_t num_counters = _lf_sched_instance->num_counters;
+    _lf_sched_instance->num_counters = staged->num_counters;
+    staged->num_counters = num_counters;
+#ifdef FS_WAIT_STATS
+    lf_sched_wait_stats_t* wait_stats = _lf_sched_instance->wait_stats;
+    _lf_sched_instance->wait_stats = staged->wait_stats;
+    staged->wait_stats = wait_stats;
+#endif
+    _lf_sched_instance->hyperperiod = staged->hyperperiod;
+    _lf_sched_instance->swap_iteration = next_iteration;
+    atomic_fetch_add_explicit(&_lf_sched_instance->swaps, 1, memory_order_relaxed);
+
+    staged->next = atomic_load_explicit(&_lf_sched_instance->retired_schedules, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(&_lf_sched_instance->retired_schedules, &staged->next, staged,
+                                                  memory_order_release, memory_order_relaxed));
+    LF_PRINT_LOG("Scheduler: Switched schedules before hyperperiod iteration %d.", next_iteration);
+}
+
+#ifndef FS_COMPILED
+/**
+ * @brief Switch a worker that has left the SAC at the end of a hyperperiod
+ * to the schedule installed there, if there was a swap: load its program and
+ * start at the head of its loop, in epoch 0, with the hyperperiod iteration
+ * of the old schedule and cleared registers.
+ *
+ * @return Whether the worker has switched schedules.
+ */
+static bool _lf_sched_adopt_schedule(size_t worker_number, lf_sched_worker_context_t* context) {
+    size_t swaps = atomic_load_explicit(&_lf_sched_instance->swaps, memory_order_relaxed);
+    if (context->swaps == swaps) return false;
+    context->swaps = swaps;
+    free(context->program);
+    _lf_sched_load_program(worker_number, context);
+    const inst_t* schedule = _lf_sched_instance->static_schedules[worker_number];
+    _lf_sched_find_loop(schedule, _lf_sched_instance->program_lengths[worker_number],
+                        &context->loop_end, &context->loop_exit);
+    context->pc = (size_t)schedule[context->loop_end].rs1;
+    context->epoch = 0;
+    context->iteration = _lf_sched_instance->swap_iteration;
+    memset(context->registers, 0, sizeof(context->registers));
+    return true;
+}
+#endif
+
+/**
+ * @brief SAC: wait until all workers have reached SAC, and if this is the
+ * SAC at the end of the hyperperiod and schedules have been staged, switch
+ * to them.
+ *
+ * @param pc The SAC.
+ * @param iteration The worker's hyperperiod iteration.
+ * @return Whether the worker has switched schedules. If so, its context
+ *  holds its new program, pc, epoch, iteration, and loop.
+ */
+static bool _lf_sched_sync_workers(size_t worker_number, size_t pc, int iteration) {
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    bool boundary = pc + 1 == context->loop_end;
+    int next_iteration = iteration;
+    if (boundary && context->program[pc + 1].rs2 > 0) {
+        next_iteration += context->program[pc + 1].rs2;
+    }
+    tracepoint_worker_wait_starts(worker_number);
+    _lf_sched_barrier(worker_number, boundary, next_iteration);
+    tracepoint_worker_wait_ends(worker_number);
+#ifdef FS_COMPILED
+    return false;
+#else
+    return boundary && _lf_sched_adopt_schedule(worker_number, context);
+#endif
+}
+
+#if defined(LF_SCHED_SWAP_ON_SIGNAL)
+/** The pipe through which the signal handler wakes up the staging thread. */
+static int _lf_sched_swap_pipe[2] = { -1, -1 };
+static lf_thread_t _lf_sched_swap_thread;
+static struct sigaction _lf_sched_swap_old_action;
+
+static void _lf_sched_swap_signal_handler(int signal_number) {
+    // write() is async-signal-safe. If the pipe is full, a request is
+    // pending already.
+    char request = 0;
+    ssize_t written = write(_lf_sched_swap_pipe[1], &request, 1);
+    (void)written;
+}
+
+/**
+ * @brief Stage the schedule file given with `--schedule` every time
+ * `FS_SWAP_SIGNAL` arrives, until the pipe is closed.
+ */
+static void* _lf_sched_swap_signal_thread(void* arg) {
+    for (;;) {
+        char request;
+        ssize_t count = read(_lf_sched_swap_pipe[0], &request, 1);
+        if (count < 0 && errno == EINTR) continue;
+        if (count != 1) return NULL;
+        const char* error;
+        if (lf_sched_stage_schedule(static_schedule_file, &error) != 0) {
+            lf_print_error("Cannot switch to the static schedule in %s: %s.", static_schedule_file, error);
         }
     }
+}
 
-    LF_PRINT_DEBUG("Start time is %ld. Current tag is (%ld, %d). Stop tag is (%ld, %d). Stop array: ", start_time, current_tag.time, current_tag.microstep, stop_tag.time, stop_tag.microstep);
-    for (int i = 0; i < _lf_sched_instance->num_reactor_self_instances; i++) {
-        LF_PRINT_DEBUG("(%ld, %d)",
-            _lf_sched_instance->reactor_self_instances[i]->tag.time,
-            _lf_sched_instance->reactor_self_instances[i]->tag.microstep);
-        LF_PRINT_DEBUG("%d", _lf_sched_instance->reactor_reached_stop_tag[i]);
+/**
+ * @brief Stage the schedule file given with `--schedule` when
+ * `FS_SWAP_SIGNAL` arrives.
+ */
+static void _lf_sched_start_swap_signal() {
+    if (pipe(_lf_sched_swap_pipe) != 0) {
+        lf_print_warning("Cannot set up schedule swaps on signal %d.", FS_SWAP_SIGNAL);
+        return;
     }
+    fcntl(_lf_sched_swap_pipe[1], F_SETFL, O_NONBLOCK);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = _lf_sched_swap_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (lf_thread_create(&_lf_sched_swap_thread, _lf_sched_swap_signal_thread, NULL) != 0
+            || sigaction(FS_SWAP_SIGNAL, &action, &_lf_sched_swap_old_action) != 0) {
+        lf_print_error_and_exit("Cannot set up schedule swaps on signal %d.", FS_SWAP_SIGNAL);
+    }
+    LF_PRINT_LOG("Scheduler: Signal %d switches to the schedule in %s again.", FS_SWAP_SIGNAL, static_schedule_file);
+}
 
-    if (stop) *pc = rs1;    // Jump to a specified location.
-    else *pc += 1;          // Increment pc.
+/**
+ * @brief Stop staging schedules on `FS_SWAP_SIGNAL`.
+ */
+static void _lf_sched_stop_swap_signal() {
+    if (_lf_sched_swap_pipe[1] < 0) return;
+    sigaction(FS_SWAP_SIGNAL, &_lf_sched_swap_old_action, NULL);
+    close(_lf_sched_swap_pipe[1]);
+    lf_thread_join(_lf_sched_swap_thread, NULL);
+    close(_lf_sched_swap_pipe[0]);
+    _lf_sched_swap_pipe[0] = _lf_sched_swap_pipe[1] = -1;
+}
+#endif
+
+#ifndef FS_THREADED_DISPATCH
+
+/**
+ * @brief BIT: Branch If Timeout
+ * Check if timeout is reached, or another worker has stopped in this
+ * worker's epoch (see `_lf_sched_should_stop()`). If not, don't do anything.
+ * If so, jump to a specified location (rs1).
+ * 
+ * FIXME: Should the timeout value be an operand?
+ */
+void execute_inst_BIT(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    bool stop = _lf_sched_should_stop(_lf_sched_context(worker_number)->epoch);
+    if (stop) *pc = inst->rs1.target;   // Jump to a specified location.
+    else *pc += 1;                      // Increment pc.
 }
 
 /**
@@ -157,15 +1923,14 @@ void execute_inst_BIT(size_t worker_number, long long int rs1, long long int rs2
  * Check if the reaction status is "queued."
  * If so, return the reaction pointer and advance pc.
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_EIT(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_EIT(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    reaction_t* reaction = _lf_sched_instance->reaction_instances[rs1];
+    reaction_t* reaction = inst->rs1.reaction;
     if (reaction->status == queued) {
         *returned_reaction = reaction;
         *exit_loop = true;
@@ -177,16 +1942,14 @@ void execute_inst_EIT(size_t worker_number, long long int rs1, long long int rs2
 /**
  * @brief EXE: Execute a reaction
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_EXE(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_EXE(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    reaction_t* reaction = _lf_sched_instance->reaction_instances[rs1];
-    *returned_reaction = reaction;
+    *returned_reaction = inst->rs1.reaction;
     *exit_loop = true;
     *pc += 1; // Increment pc.
 }
@@ -195,67 +1958,48 @@ void execute_inst_EXE(size_t worker_number, long long int rs1, long long int rs2
  * @brief DU: Delay Until a physical timepoint (rs1) plus an offset (rs2) is reached.
  * 
  * @param worker_number 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_DU(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_DU(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    // FIXME: There seems to be an overflow problem.
-    // When wakeup_time overflows but lf_time_physical() doesn't,
-    // lf_sleep_until_locked() terminates immediately. 
-    instant_t wakeup_time = physical_start_time + rs1 * (*iteration + 1);
-    LF_PRINT_DEBUG("physical_start_time: %ld, wakeup_time: %ld, rs1: %lld, iteration+1: %d, current_physical_time: %ld\n", physical_start_time, wakeup_time, rs1, (*iteration + 1), lf_time_physical());
-    LF_PRINT_DEBUG("*** Worker %zu delaying", worker_number);
-    lf_sleep_until_locked(wakeup_time);
-    LF_PRINT_DEBUG("*** Worker %zu done delaying", worker_number);
+    interval_t lateness = _lf_sched_delay_until(worker_number, inst->rs1.value, inst->rs2, *iteration);
+    _LF_SCHED_PROFILE_LATENESS(worker_number, *pc, lateness);
     *pc += 1; // Increment pc.
 }
 
 /**
- * @brief WU: Wait until a counting variable reaches a specified value.
+ * @brief WU: Wait until a counting variable reaches a specified value in
+ * the worker's epoch, or leave the loop if the workers are stopping.
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_WU(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_WU(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    LF_PRINT_DEBUG("*** Worker %zu waiting", worker_number);
-    while(_lf_sched_instance->counters[rs1] < rs2);
-    LF_PRINT_DEBUG("*** Worker %zu done waiting", worker_number);
-    *pc += 1; // Increment pc.
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    if (_lf_sched_wait_for_counter(worker_number, inst->rs1.counter, inst->rs2, context->epoch)) {
+        *pc += 1; // Increment pc.
+    } else {
+        *pc = context->loop_exit;
+    }
 }
 
 /**
  * @brief ADV: Advance time for a particular reactor.
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_ADV(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_ADV(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    
-    // This mutex is quite expensive.
-    lf_mutex_lock(&mutex);
-
-    self_base_t* reactor =
-        _lf_sched_instance->reactor_self_instances[rs1];
-    reactor->tag.time += rs2;
-    reactor->tag.microstep = 0;
-
-    if (_lf_is_tag_after_stop_tag(reactor->tag)) {
-        _lf_sched_instance->reactor_reached_stop_tag[rs1] = true;
-    }
-   
-    lf_mutex_unlock(&mutex);
+    _lf_sched_advance_reactor_tag(inst->rs1.reactor, inst->rs2, false);
 
     *pc += 1; // Increment pc.
 }
@@ -263,74 +2007,65 @@ void execute_inst_ADV(size_t worker_number, long long int rs1, long long int rs2
 /**
  * @brief ADV: Advance time for a particular reactor.
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_ADV2(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_ADV2(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-
-    self_base_t* reactor =
-        _lf_sched_instance->reactor_self_instances[rs1];
-    reactor->tag.time += rs2;
-    reactor->tag.microstep = 0;
-
-    if (_lf_is_tag_after_stop_tag(reactor->tag)) {
-        _lf_sched_instance->reactor_reached_stop_tag[rs1] = true;
-    }
-   
+    _lf_sched_advance_reactor_tag(inst->rs1.reactor, inst->rs2, true);
     *pc += 1; // Increment pc.
 }
 
 /**
- * @brief JMP: Jump to a particular line in the schedule.
+ * @brief JMP: Jump to a particular line in the schedule. The JMP that
+ * closes the worker's loop starts a new epoch.
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_JMP(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_JMP(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    if (rs2 != -1) *iteration += 1;
-    *pc = rs1;
+    if (inst->rs2 > 0) *iteration += inst->rs2;
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    if (*pc == context->loop_end) context->epoch++;
+    *pc = inst->rs1.target;
 }
 
 /**
- * @brief SAC: (Sync-And-Clear) synchronize all workers until all execute SAC
- * and let the last idle worker reset all counters to 0.
+ * @brief SAC: (Sync-And-Clear) synchronize all workers until all execute SAC.
+ *
+ * The counters are no longer cleared; WU waits for values relative to the
+ * worker's epoch instead (see `lf_sched_counter_t`). At the end of the
+ * hyperperiod, the worker may switch to staged schedules, which sets its pc
+ * (see scheduler_swap.h).
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_SAC(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_SAC(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    tracepoint_worker_wait_starts(worker_number);
-    _lf_sched_wait_for_work(worker_number);
-    tracepoint_worker_wait_ends(worker_number);
-    *pc += 1; // Increment pc.
+    if (!_lf_sched_sync_workers(worker_number, *pc, *iteration)) {
+        *pc += 1; // Increment pc.
+    }
 }
 
 /**
  * @brief INC: INCrement a counter (rs1) by an amount (rs2).
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_INC(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_INC(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    lf_mutex_lock(&mutex);
-    _lf_sched_instance->counters[rs1] += rs2;
-    lf_mutex_unlock(&mutex);
+    _lf_sched_increment_counter(inst->rs1.counter, inst->rs2, false);
     *pc += 1; // Increment pc.
 }
 
@@ -338,15 +2073,14 @@ void execute_inst_INC(size_t worker_number, long long int rs1, long long int rs2
  * @brief INC2: [Lock-free] INCrement a counter (rs1) by an amount (rs2).
  * The compiler needs to guarantee a single writer.
  * 
- * @param rs1 
- * @param rs2 
+ * @param inst 
  * @param pc 
  * @param returned_reaction 
  * @param exit_loop 
  */
-void execute_inst_INC2(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_INC2(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
-    _lf_sched_instance->counters[rs1] += rs2;
+    _lf_sched_increment_counter(inst->rs1.counter, inst->rs2, true);
     *pc += 1; // Increment pc.
 }
 
@@ -354,17 +2088,117 @@ void execute_inst_INC2(size_t worker_number, long long int rs1, long long int rs
  * @brief STP: SToP the execution.
  * 
  */
-void execute_inst_STP(size_t worker_number, long long int rs1, long long int rs2, size_t* pc,
+void execute_inst_STP(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
     reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
     *exit_loop = true;
 }
 
+/**
+ * @brief ADDI: ADD an Immediate (rs2) to a register (rs1).
+ */
+void execute_inst_ADDI(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    long long int* registers = _lf_sched_context(worker_number)->registers;
+    registers[inst->rs1.value] = inst_add_immediate(registers[inst->rs1.value], inst->rs2);
+    *pc += 1; // Increment pc.
+}
+
+/**
+ * @brief BEQ, BNE, and BLT: Branch to a location (rs1) if a register (rs2)
+ * is equal to, not equal to, or less than zero.
+ */
+void execute_inst_branch(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    long long int value = _lf_sched_context(worker_number)->registers[inst->rs2];
+    if (inst_register_branch_taken(inst->op, value)) *pc = inst->rs1.target;
+    else *pc += 1;
+}
+
+/**
+ * @brief BNT: Branch to a location if a reaction is Not Triggered. Decoded
+ * with the reaction in rs1 and the location in rs2.
+ */
+void execute_inst_BNT(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    if (inst->rs1.reaction->status != queued) *pc = inst->rs2;
+    else *pc += 1;
+}
+
+/**
+ * @brief SRV: SeRVe triggered sporadic reactions for up to a budget (rs1).
+ */
+void execute_inst_SRV(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    _lf_sched_serve_sporadic(worker_number, *pc, inst->rs1.value);
+    *pc += 1;
+}
+
+/**
+ * @brief BNM: Branch to a location if the mode of a reaction is Not active.
+ * Decoded with the mode in rs1 and the location in rs2.
+ */
+void execute_inst_BNM(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    if (!_lf_sched_mode_is_active(inst->rs1.mode)) *pc = inst->rs2;
+    else *pc += 1;
+}
+
+/**
+ * @brief EXE_INC: EXEcute a reaction (rs1) on the worker and INCrement a
+ * counter, as given by the next instruction.
+ */
+void execute_inst_EXE_INC(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    _lf_sched_run_reaction(worker_number, *pc, inst[0].rs1.reaction);
+    _lf_sched_increment_counter(inst[1].rs1.counter, inst[1].rs2, inst[1].op == INC2);
+    *pc += 2;
+}
+
+/**
+ * @brief EXE_ADV: EXEcute a reaction (rs1) on the worker and ADVance a
+ * reactor, as given by the next instruction.
+ */
+void execute_inst_EXE_ADV(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    _lf_sched_run_reaction(worker_number, *pc, inst[0].rs1.reaction);
+    _lf_sched_advance_reactor_tag(inst[1].rs1.reactor, inst[1].rs2, inst[1].op == ADV2);
+    *pc += 2;
+}
+
+/**
+ * @brief EXE_INC_ADV: EXEcute a reaction (rs1) on the worker, INCrement a
+ * counter, and ADVance a reactor, as given by the next two instructions.
+ */
+void execute_inst_EXE_INC_ADV(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    _lf_sched_run_reaction(worker_number, *pc, inst[0].rs1.reaction);
+    _lf_sched_increment_counter(inst[1].rs1.counter, inst[1].rs2, inst[1].op == INC2);
+    _lf_sched_advance_reactor_tag(inst[2].rs1.reactor, inst[2].rs2, inst[2].op == ADV2);
+    *pc += 3;
+}
+
+/**
+ * @brief WU_EIT: Wait Until a counter (rs1) reaches a value (rs2), then
+ * execute the reaction of the next instruction on the worker if it is
+ * triggered.
+ */
+void execute_inst_WU_EIT(size_t worker_number, const decoded_inst_t* inst, size_t* pc,
+    reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    if (!_lf_sched_wait_for_counter(worker_number, inst[0].rs1.counter, inst[0].rs2, context->epoch)) {
+        *pc = context->loop_exit;
+        return;
+    }
+    if (inst[1].rs1.reaction->status == queued) {
+        _lf_sched_run_reaction(worker_number, *pc, inst[1].rs1.reaction);
+    }
+    *pc += 2;
+}
+
 /**
  * @brief Execute an instruction
  * 
- * @param op the opcode
- * @param rs1 the first operand
- * @param rs2 the second operand
+ * @param inst the decoded instruction
  * @param pc a pointer to the program counter
  * @param returned_reaction a pointer to a reaction to be executed 
  * 
@@ -372,86 +2206,151 @@ void execute_inst_STP(size_t worker_number, long long int rs1, long long int rs2
  * @param exit_loop a pointer to a boolean indicating whether
  *                  the outer while loop should be exited
  */
-void execute_inst(size_t worker_number, opcode_t op, long long int rs1, long long int rs2,
-    size_t* pc, reaction_t** returned_reaction, bool* exit_loop, volatile volatile int* iteration) {
-    char* op_str = NULL;
-    switch (op) {
+void execute_inst(size_t worker_number, const decoded_inst_t* inst,
+    size_t* pc, reaction_t** returned_reaction, bool* exit_loop, volatile int* iteration) {
+    _LF_SCHED_PRINT_INST(worker_number, *pc);
+    switch (inst->op) {
         case ADV:
-            op_str = "ADV";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_ADV(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_ADV(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case ADV2:
-            op_str = "ADV2";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_ADV2(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_ADV2(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case BIT:
-            op_str = "BIT";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_BIT(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_BIT(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
          case DU:  
-            op_str = "DU";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_DU(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_DU(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case EIT:
-            op_str = "EIT";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_EIT(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_EIT(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case EXE:
-            op_str = "EXE";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_EXE(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_EXE(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case INC:
-            op_str = "INC";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_INC(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_INC(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case INC2:
-            op_str = "INC2";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_INC2(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_INC2(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case JMP:
-            op_str = "JMP";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_JMP(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_JMP(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case SAC:
-            op_str = "SAC";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_SAC(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_SAC(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case STP:
-            op_str = "STP";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_STP(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_STP(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         case WU:
-            op_str = "WU";
-            LF_PRINT_DEBUG("*** Current instruction for worker %zu: [Line %zu] %s %lld %lld",
-                            worker_number, *pc, op_str, rs1, rs2);
-            execute_inst_WU(worker_number, rs1, rs2, pc, returned_reaction, exit_loop, iteration);
+            execute_inst_WU(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case ADDI:
+            execute_inst_ADDI(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case BEQ:
+        case BNE:
+        case BLT:
+            execute_inst_branch(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case BNT:
+            execute_inst_BNT(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case SRV:
+            execute_inst_SRV(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case BNM:
+            execute_inst_BNM(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case EXE_INC:
+            execute_inst_EXE_INC(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case EXE_ADV:
+            execute_inst_EXE_ADV(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case EXE_INC_ADV:
+            execute_inst_EXE_INC_ADV(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
+            break;
+        case WU_EIT:
+            execute_inst_WU_EIT(worker_number, inst, pc, returned_reaction, exit_loop, iteration);
             break;
         default:
-            lf_print_error_and_exit("Invalid instruction: %d", op);
+            lf_print_error_and_exit("Invalid instruction: %d", inst->op);
+    }
+}
+#endif // FS_THREADED_DISPATCH
+
+#ifdef FS_COMPILED
+///////////////////// Compiled Schedules /////////////////////////
+// What the instructions of a compiled schedule call (see scheduler_compiled.h).
+// Counters are passed as indices, like the operands of INC, INC2, and WU in a
+// schedule.
+
+void lf_sched_compiled_execute(size_t worker_number, reaction_t* reaction) {
+    _lf_sched_run_reaction(worker_number, 0, reaction);
+}
+
+void lf_sched_compiled_increment(size_t counter, long long int amount, bool single_writer) {
+    _lf_sched_increment_counter(&_lf_sched_instance->counters[counter], amount, single_writer);
+}
+
+bool lf_sched_compiled_wait_until(size_t worker_number, size_t counter, long long int value) {
+    return _lf_sched_wait_for_counter(worker_number, &_lf_sched_instance->counters[counter], value,
+                                      _lf_sched_context(worker_number)->epoch);
+}
+
+void lf_sched_compiled_advance(self_base_t* reactor, interval_t amount, bool single_writer) {
+    _lf_sched_advance_reactor_tag(reactor, amount, single_writer);
+}
+
+bool lf_sched_compiled_timeout_reached(size_t worker_number) {
+    return _lf_sched_should_stop(_lf_sched_context(worker_number)->epoch);
+}
+
+void lf_sched_compiled_end_epoch(size_t worker_number) {
+    _lf_sched_context(worker_number)->epoch++;
+}
+
+void lf_sched_compiled_delay_until(size_t worker_number, long long int rs1, long long int rs2, int iteration) {
+    _lf_sched_delay_until(worker_number, rs1, rs2, iteration);
+}
+
+void lf_sched_compiled_sync_and_clear(size_t worker_number, bool boundary) {
+    tracepoint_worker_wait_starts(worker_number);
+    // Staging is refused with compiled schedules, so only the modes change
+    // at the boundary, and the iteration does not matter.
+    _lf_sched_barrier(worker_number, boundary, 0);
+    tracepoint_worker_wait_ends(worker_number);
+}
+
+bool lf_sched_compiled_mode_is_active(reaction_t* reaction) {
+    return _lf_sched_mode_is_active(reaction->mode);
+}
+
+void lf_sched_compiled_serve(size_t worker_number, interval_t budget) {
+    _lf_sched_serve_sporadic(worker_number, 0, budget);
+}
+
+/**
+ * @brief Check that the compiled schedules were generated from the schedules
+ * that the workers would otherwise interpret.
+ */
+static void _lf_sched_check_compiled_schedules() {
+    if (lf_sched_compiled_num_workers != _lf_sched_instance->_lf_sched_number_of_workers) {
+        lf_print_error_and_exit("The compiled schedule is for %zu workers, but there are %zu workers.",
+                                lf_sched_compiled_num_workers, _lf_sched_instance->_lf_sched_number_of_workers);
     }
+    static_schedule_t schedule = _lf_sched_current_schedules();
+    uint32_t fingerprint = static_schedule_fingerprint(&schedule);
+    if (fingerprint != lf_sched_compiled_fingerprint) {
+        lf_print_error_and_exit("The compiled schedule (fingerprint %08x) was generated from a different "
+                                "schedule than the one loaded (fingerprint %08x). Regenerate it with "
+                                "fs_schedule_compile.", lf_sched_compiled_fingerprint, fingerprint);
+    }
+    LF_PRINT_LOG("Scheduler: Running the compiled schedule (fingerprint %08x).", fingerprint);
 }
+#endif // FS_COMPILED
 
 ///////////////////// Scheduler Init and Destroy API /////////////////////////
 /**
@@ -460,6 +2359,10 @@ void execute_inst(size_t worker_number, opcode_t op, long long int rs1, long lon
  * This has to be called before other functions of the scheduler can be used.
  * If the scheduler is already initialized, this will be a no-op.
  *
+ * The first call also decodes the static schedule of every worker (see
+ * `decoded_inst_t`). Each worker moves its context and decoded program into
+ * memory of its own when it first asks for work.
+ *
  * @param number_of_workers Indicate how many workers this scheduler will be
  *  managing.
  * @param option Pointer to a `sched_params_t` struct containing additional
@@ -482,31 +2385,263 @@ void lf_sched_init(
         //        to a meaningful value. When the first time lf_sched_init() is
         //        called, start_time has not been set.
 
-        // Initialize the local tags for the FS scheduler.
+        // Initialize the local tags for the FS scheduler and count the
+        // reactors that BIT waits for.
+        size_t reactors_remaining = 0;
         for (int i = 0; i < _lf_sched_instance->num_reactor_self_instances; i++) {
-            _lf_sched_instance->reactor_self_instances[i]->tag.time = start_time;
-            _lf_sched_instance->reactor_self_instances[i]->tag.microstep = 0;
-            LF_PRINT_DEBUG("(%ld, %d)",
-                _lf_sched_instance->reactor_self_instances[i]->tag.time,
-                _lf_sched_instance->reactor_self_instances[i]->tag.microstep);
+            self_base_t* reactor = _lf_sched_instance->reactor_self_instances[i];
+            atomic_store_explicit(&reactor->tag_time, start_time, memory_order_relaxed);
+            if (!atomic_load_explicit(&reactor->reached_stop_tag, memory_order_relaxed)) {
+                reactors_remaining++;
+            }
+            LF_PRINT_DEBUG("(%ld, 0)", start_time);
         }
+        atomic_store_explicit(&_lf_sched_instance->reactors_remaining, reactors_remaining, memory_order_release);
 
         // Already initialized
         return;
     }
 
-    _lf_sched_instance->pc = calloc(number_of_workers, sizeof(size_t));
-    _lf_sched_instance->static_schedules = &static_schedules[0];
+    _lf_sched_new_contexts(number_of_workers);
+    atomic_store_explicit(&_lf_sched_instance->stop_epoch, SIZE_MAX, memory_order_relaxed);
     _lf_sched_instance->reaction_instances = params->reaction_instances;
+    _lf_sched_instance->num_reaction_instances = params->num_reaction_instances;
     _lf_sched_instance->reactor_self_instances = params->reactor_self_instances;
     _lf_sched_instance->num_reactor_self_instances = params->num_reactor_self_instances;
-    _lf_sched_instance->reactor_reached_stop_tag = params->reactor_reached_stop_tag;
-    _lf_sched_instance->counters = counters;
+    _lf_sched_instance->staged_programs = calloc(number_of_workers, sizeof(decoded_inst_t*));
+    _lf_sched_instance->program_lengths = calloc(number_of_workers, sizeof(size_t));
+
+    if (static_schedule_file != NULL) {
+        // Use the schedule file given on the command line.
+        static_schedule_t* file = calloc(1, sizeof(static_schedule_t));
+        const char* error;
+        if (static_schedule_map(static_schedule_file, file, &error) != 0) {
+            lf_print_error_and_exit("Cannot load schedule file %s: %s.", static_schedule_file, error);
+        }
+        if (file->num_workers != number_of_workers) {
+            lf_print_error_and_exit("The schedule file %s is for %zu workers, but there are %zu workers.",
+                                    static_schedule_file, file->num_workers, number_of_workers);
+        }
+        _lf_sched_instance->schedule_file = file;
+        _lf_sched_instance->static_schedules = file->schedules;
+        _lf_sched_instance->num_counters = file->num_counters;
+        _lf_sched_instance->wait_policy = file->wait_policy;
+        for (size_t i = 0; i < number_of_workers; i++) {
+            _lf_sched_instance->program_lengths[i] = file->schedule_lengths[i];
+            lf_worker_set_default_cpu(i, file->cpus[i]);
+        }
+        lf_print("Using the static schedule in %s.", static_schedule_file);
+    } else {
+        if (num_schedules != number_of_workers) {
+            lf_print_error_and_exit("The static schedule is for %zu workers, but there are %zu workers.",
+                                    num_schedules, number_of_workers);
+        }
+        _lf_sched_instance->static_schedules = &static_schedules[0];
+        _lf_sched_instance->num_counters = num_counters;
+        _lf_sched_instance->wait_policy = wait_policy;
+        for (size_t i = 0; i < number_of_workers; i++) {
+            _lf_sched_instance->program_lengths[i] = schedule_lengths[i];
+            _lf_sched_instance->staged_contexts[i].iteration = hyperperiod_iterations[i];
+        }
+    }
+
+    if (static_schedule_unroll_factor > 1) {
+        _lf_sched_unroll_schedules(static_schedule_unroll_factor);
+    }
+
+    // Spinning only helps if the worker being waited for can run at the same
+    // time, i.e., if every worker can have a core of its own.
+    if (_lf_sched_instance->wait_policy == WAIT_HYBRID && lf_available_cores() < (int)number_of_workers) {
+        LF_PRINT_LOG("Scheduler: %d cores for %zu workers; waiting without spinning.",
+                     lf_available_cores(), number_of_workers);
+        _lf_sched_instance->wait_policy = WAIT_BLOCK;
+    }
+    _lf_sched_instance->counters = _lf_sched_new_counters(_lf_sched_instance->num_counters);
+    _lf_sched_instance->barrier_nodes = _lf_sched_new_barrier(number_of_workers);
+#ifdef FS_WAIT_STATS
+    _lf_sched_instance->wait_stats = calloc(number_of_workers * _lf_sched_instance->num_counters,
+                                            sizeof(lf_sched_wait_stats_t));
+#endif
+#ifdef FS_PROFILE
+    _lf_sched_new_profiles(number_of_workers);
+#endif
+
+    // Verify and decode the schedules. Compiled schedules need no decoding.
+    static_schedule_t schedule = _lf_sched_current_schedules();
+    int problems = _lf_sched_verify_schedules(&schedule);
+    if (problems > 0) {
+        lf_print_error_and_exit("The static schedule failed verification with %d problem(s).", problems);
+    }
+    _lf_sched_find_sporadic_reactions();
+    for (size_t i = 0; i < number_of_workers; i++) {
+        lf_sched_worker_context_t* context = &_lf_sched_instance->staged_contexts[i];
+        _lf_sched_find_loop(schedule.schedules[i], schedule.schedule_lengths[i], &context->loop_end, &context->loop_exit);
+    }
+    unsigned long long* base = _lf_sched_prepare_epochs(&schedule, _lf_sched_instance->counters);
+#ifdef FS_COMPILED
+    _lf_sched_check_compiled_schedules();
+#else
+    for (size_t i = 0; i < number_of_workers; i++) {
+        _lf_sched_instance->staged_programs[i] = _lf_sched_decode_schedule(
+            &schedule, i, _lf_sched_instance->staged_contexts[i].loop_end, base, _lf_sched_instance->counters);
+        if (_lf_sched_instance->staged_programs[i] == NULL) {
+            lf_print_error_and_exit("Cannot load the static schedule of worker %zu.", i);
+        }
+    }
+#endif
+    free(base);
+
+    // Find out whether the workers can switch to other schedules later.
+    lf_mutex_init(&_lf_sched_stage_mutex);
+    _lf_sched_instance->swap_problem = _lf_sched_swap_problem(&schedule, &_lf_sched_instance->hyperperiod);
+#if defined(FS_COMPILED)
+    _lf_sched_instance->swap_problem = "compiled schedules cannot be swapped";
+#elif defined(LF_SCHED_SWAP_ON_SIGNAL)
+    if (static_schedule_file != NULL && _lf_sched_instance->swap_problem == NULL) {
+        _lf_sched_start_swap_signal();
+    }
+#endif
+#ifdef MODAL_REACTORS
+    // Schedules with BNM have the boundary, as the verifier checks.
+    const char* boundary_problem = _lf_sched_boundary_problem(&schedule);
+    if (boundary_problem != NULL) {
+        lf_print_warning("Scheduler: Mode transitions will not take effect, since %s.", boundary_problem);
+    }
+#endif
 
     // FIXME: Why does this show a negative value?
     LF_PRINT_DEBUG("start_time = %ld", start_time);
 }
 
+#ifdef FS_WAIT_STATS
+/**
+ * @brief Print how long the workers have waited on each counter in WU.
+ */
+static void _lf_sched_print_wait_stats(const lf_sched_wait_stats_t* wait_stats, size_t num_counters) {
+    static const char* const policy_names[] = {
+        [WAIT_SPIN]     = "spin",
+        [WAIT_HYBRID]   = "hybrid",
+        [WAIT_BLOCK]    = "block",
+    };
+    lf_print("Wait statistics (policy: %s):", policy_names[_lf_sched_instance->wait_policy]);
+    for (size_t c = 0; c < num_counters; c++) {
+        lf_sched_wait_stats_t total = { 0 };
+        for (size_t w = 0; w < _lf_sched_instance->_lf_sched_number_of_workers; w++) {
+            const lf_sched_wait_stats_t* stats = &wait_stats[w * num_counters + c];
+            total.waits += stats->waits;
+            total.sleeps += stats->sleeps;
+            total.spin_time += stats->spin_time;
+            total.sleep_time += stats->sleep_time;
+        }
+        lf_print("    Counter %zu: %zu waits, spun %.3f ms, slept %.3f ms (%zu sleeps).",
+                 c, total.waits, total.spin_time / 1e6, total.sleep_time / 1e6, total.sleeps);
+    }
+}
+#endif
+
+#ifdef FS_RELEASE_STATS
+/**
+ * @brief Print how late each worker was released by DU.
+ */
+static void _lf_sched_print_release_stats() {
+    lf_print("Release lateness (DU spin: %lld ns):", (long long)FS_DU_SPIN_NS);
+    for (size_t w = 0; w < _lf_sched_instance->_lf_sched_number_of_workers; w++) {
+        lf_sched_lateness_stats_t* stats = &_lf_sched_context(w)->release_stats;
+        if (stats->releases == 0) continue;
+        lf_print("    Worker %zu: %zu releases, mean %.3f us, max %.3f us.",
+                 w, stats->releases, (double)stats->total / stats->releases / 1e3, stats->max / 1e3);
+        for (size_t b = 0; b < LF_SCHED_LATENESS_BUCKETS; b++) {
+            if (stats->buckets[b] == 0) continue;
+            if (b == LF_SCHED_LATENESS_BUCKETS - 1) {
+                lf_print("        >= %lld ns: %zu", 1LL << (b - 1), stats->buckets[b]);
+            } else {
+                lf_print("        < %lld ns: %zu", 1LL << b, stats->buckets[b]);
+            }
+        }
+    }
+}
+#endif
+
+/**
+ * @brief Log how much slack each worker has reclaimed with background jobs,
+ * if any ran.
+ */
+static void _lf_sched_log_background_stats() {
+    for (size_t w = 0; w < _lf_sched_instance->_lf_sched_number_of_workers; w++) {
+        lf_sched_background_stats_t* stats = &_lf_sched_context(w)->background_stats;
+        if (stats->jobs == 0) continue;
+        LF_PRINT_LOG("Worker %zu ran %zu background jobs in %.3f ms of slack (%.3f ms over their cost).",
+                     w, stats->jobs, stats->time / 1e6, stats->overrun / 1e6);
+    }
+}
+
+#ifdef FS_PROFILE
+/**
+ * @brief Print every worker's schedule with what the profiler has measured
+ * for each instruction, and the time spent waiting on each counter.
+ *
+ * Lines that take at least `LF_SCHED_PROFILE_HOT_PERCENT` of the worker's
+ * time are marked with ">>". Printed once, when the scheduler is freed or the
+ * program exits, whichever comes first. If the workers are still running
+ * (e.g., after Ctrl-C), the numbers of the current hyperperiod may be off.
+ */
+static void _lf_sched_print_profile() {
+    static bool printed = false;
+    if (printed || _lf_sched_instance == NULL || _lf_sched_instance->contexts == NULL) return;
+    printed = true;
+
+    // Convert ticks to time with the average rate since profiling started.
+    uint64_t elapsed_ticks = _lf_sched_profile_ticks() - _lf_sched_instance->profile_start_ticks;
+    interval_t elapsed_time = lf_time_physical() - _lf_sched_instance->profile_start_time;
+    double ns_per_tick = elapsed_ticks > 0 ? (double)elapsed_time / elapsed_ticks : 1.0;
+    size_t num_counters = _lf_sched_instance->num_counters;
+    double* counter_wait_us = calloc(num_counters > 0 ? num_counters : 1, sizeof(double));
+
+    lf_print("FS profile (%.3f ns per tick; >> marks lines with at least %d%% of a worker's time):",
+             ns_per_tick, LF_SCHED_PROFILE_HOT_PERCENT);
+#if FS_FUSE
+    lf_print("A superinstruction is counted on the first line of the sequence it runs.");
+#endif
+    for (size_t w = 0; w < _lf_sched_instance->_lf_sched_number_of_workers; w++) {
+        const lf_sched_line_profile_t* lines = _lf_sched_context(w)->profile.lines;
+        const inst_t* schedule = _lf_sched_instance->static_schedules[w];
+        size_t length = _lf_sched_instance->program_lengths[w];
+        uint64_t total = 0;
+        for (size_t pc = 0; pc < length; pc++) {
+            total += lines[pc].ticks + lines[pc].reaction_ticks;
+        }
+        lf_print("Worker %zu: %.3f ms", w, total * ns_per_tick / 1e6);
+        lf_print("      share      count    inst_us  reaction_us  line  instruction");
+        for (size_t pc = 0; pc < length; pc++) {
+            const lf_sched_line_profile_t* line = &lines[pc];
+            uint64_t ticks = line->ticks + line->reaction_ticks;
+            double percent = total > 0 ? 100.0 * ticks / total : 0.0;
+            char details[64] = "";
+            if (schedule[pc].op == DU && line->count > 0) {
+                snprintf(details, sizeof(details), "  late: mean %.3f us, max %.3f us",
+                         (double)line->lateness / line->count / 1e3, line->max_lateness / 1e3);
+            } else if (schedule[pc].op == WU && schedule[pc].rs1 >= 0
+                    && (size_t)schedule[pc].rs1 < num_counters) {
+                counter_wait_us[schedule[pc].rs1] += line->ticks * ns_per_tick / 1e3;
+            }
+            lf_print("%s %6.2f%% %10llu %10.3f %12.3f  %4zu  %-4s %lld, %lld%s",
+                     percent >= LF_SCHED_PROFILE_HOT_PERCENT ? ">>" : "  ",
+                     percent, (unsigned long long)line->count,
+                     line->ticks * ns_per_tick / 1e3, line->reaction_ticks * ns_per_tick / 1e3,
+                     pc, _lf_sched_opcode_names[schedule[pc].op], schedule[pc].rs1, schedule[pc].rs2,
+                     details);
+        }
+    }
+    if (num_counters > 0) {
+        lf_print("Time spent in WU per counter, all workers:");
+        for (size_t c = 0; c < num_counters; c++) {
+            lf_print("    Counter %zu: %.3f us", c, counter_wait_us[c]);
+        }
+    }
+    free(counter_wait_us);
+}
+#endif
+
 /**
  * @brief Free the memory used by the scheduler.
  *
@@ -514,7 +2649,55 @@ void lf_sched_init(
  */
 void lf_sched_free() {
     LF_PRINT_DEBUG("Freeing the pointers in the scheduler struct.");
-    free(_lf_sched_instance->pc);
+#ifdef FS_PROFILE
+    _lf_sched_print_profile();
+#endif
+#ifdef LF_SCHED_SWAP_ON_SIGNAL
+    _lf_sched_stop_swap_signal();
+#endif
+    lf_sched_staged_schedule_t* staged =
+        atomic_exchange_explicit(&_lf_sched_instance->staged_schedule, NULL, memory_order_acquire);
+    if (staged != NULL) _lf_sched_free_staged_schedule(staged);
+    _lf_sched_free_retired_schedules();
+    for (size_t i = 0; i < _lf_sched_instance->_lf_sched_number_of_workers; i++) {
+        free(_lf_sched_instance->staged_programs[i]);
+    }
+    free(_lf_sched_instance->staged_programs);
+    free(_lf_sched_instance->program_lengths);
+    if (_lf_sched_instance->schedule_file != NULL) {
+        static_schedule_unmap(_lf_sched_instance->schedule_file);
+        free(_lf_sched_instance->schedule_file);
+    }
+    if (_lf_sched_instance->unrolled_schedule != NULL) {
+        static_schedule_unroll_free(_lf_sched_instance->unrolled_schedule);
+        free(_lf_sched_instance->unrolled_schedule);
+    }
+#ifdef FS_WAIT_STATS
+    _lf_sched_print_wait_stats(_lf_sched_instance->wait_stats, _lf_sched_instance->num_counters);
+    free(_lf_sched_instance->wait_stats);
+#endif
+#ifdef FS_RELEASE_STATS
+    _lf_sched_print_release_stats();
+#endif
+    _lf_sched_log_background_stats();
+    for (size_t i = 0; i < _lf_sched_instance->_lf_sched_number_of_workers; i++) {
+        lf_sched_worker_context_t* context = _lf_sched_context(i);
+        free(context->program);
+#ifdef FS_PROFILE
+        free(context->profile.lines);
+#endif
+        if (context != &_lf_sched_instance->staged_contexts[i]) free(context);
+    }
+    free(_lf_sched_instance->contexts);
+    free(_lf_sched_instance->staged_contexts);
+    _lf_sched_instance->contexts = NULL;
+    free(_lf_sched_instance->counters);
+    free(_lf_sched_instance->barrier_nodes);
+    if (_lf_sched_instance->num_sporadic_reactions > 0) {
+        pqueue_free((pqueue_t*)_lf_sched_instance->_lf_sched_triggered_reactions);
+        free(_lf_sched_instance->_lf_sched_array_of_mutexes);
+        free(_lf_sched_instance->sporadic_reactions);
+    }
     free(_lf_sched_instance->reactor_self_instances);
     free(_lf_sched_instance->reaction_instances);
 }
@@ -531,34 +2714,339 @@ void lf_sched_free() {
  * @return reaction_t* A reaction for the worker to execute. NULL if the calling
  * worker thread should exit.
  */
+#if defined(FS_COMPILED)
+/**
+ * The compiled variant (-DFS_COMPILED=ON). The worker runs its compiled
+ * schedule, which executes every reaction itself, and leaves when the
+ * schedule reaches STP.
+ */
+reaction_t* lf_sched_get_ready_reaction(int worker_number) {
+    LF_PRINT_DEBUG("Worker %d runs its compiled schedule", worker_number);
+    _lf_sched_load_context(worker_number);
+    lf_sched_compiled_workers[worker_number](worker_number,
+                                             _lf_sched_instance->reaction_instances,
+                                             _lf_sched_instance->reactor_self_instances);
+    LF_PRINT_DEBUG("Worker %d leaves lf_sched_get_ready_reaction", worker_number);
+    return NULL;
+}
+#elif !defined(FS_THREADED_DISPATCH)
 reaction_t* lf_sched_get_ready_reaction(int worker_number) {
     LF_PRINT_DEBUG("Worker %d inside lf_sched_get_ready_reaction", worker_number);
     
-    const inst_t*   current_schedule    = _lf_sched_instance->static_schedules[worker_number];
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    if (!context->loaded) {
+        context = _lf_sched_load_context(worker_number);
+    }
+
     reaction_t*     returned_reaction   = NULL;
     bool            exit_loop           = false;
-    size_t*         pc                  = &_lf_sched_instance->pc[worker_number];
-    opcode_t        op;
-    long long int   rs1;
-    long long int   rs2;
-    volatile int*   iteration           = &hyperperiod_iterations[worker_number];
+    size_t*         pc                  = &context->pc;
+    volatile int*   iteration           = &context->iteration;
+    _LF_SCHED_PROFILE_ENTER(worker_number);
 
     while (!exit_loop) {
-        op  = current_schedule[*pc].op;
-        rs1 = current_schedule[*pc].rs1;
-        rs2 = current_schedule[*pc].rs2;
-
-        // Execute the current instruction
-        execute_inst(worker_number, op, rs1, rs2, pc,
+        _LF_SCHED_PROFILE_STEP(worker_number, *pc);
+        // Execute the current instruction. The program is read from the
+        // context every time, since SAC may switch it.
+        execute_inst(worker_number, &context->program[*pc], pc,
                     &returned_reaction, &exit_loop, iteration);
 
         LF_PRINT_DEBUG("Worker %d: returned_reaction = %p, exit_loop = %d",
                         worker_number, returned_reaction, exit_loop);
     }
+    _LF_SCHED_PROFILE_EXIT(worker_number, returned_reaction);
+
+    LF_PRINT_DEBUG("Worker %d leaves lf_sched_get_ready_reaction", worker_number);
+    return returned_reaction;
+}
+#else
+/**
+ * The direct-threaded variant of the VM loop (-DFS_THREADED_DISPATCH=1).
+ *
+ * Instead of a central switch that calls out to an execute_inst_* function
+ * per instruction, every instruction handler ends by jumping straight to the
+ * handler of the next instruction through a table of label addresses
+ * (computed goto). The pc, the hyperperiod iteration, the epoch, and the
+ * reaction to return are locals that the compiler keeps in registers; they
+ * are only written back to the worker's context when the worker leaves the
+ * loop.
+ */
+reaction_t* lf_sched_get_ready_reaction(int worker_number) {
+    static const void* const dispatch_table[] = {
+        [ADV]   = &&handle_ADV,
+        [ADV2]  = &&handle_ADV2,
+        [BIT]   = &&handle_BIT,
+        [DU]    = &&handle_DU,
+        [EIT]   = &&handle_EIT,
+        [EXE]   = &&handle_EXE,
+        [INC]   = &&handle_INC,
+        [INC2]  = &&handle_INC2,
+        [JMP]   = &&handle_JMP,
+        [SAC]   = &&handle_SAC,
+        [STP]   = &&handle_STP,
+        [WU]    = &&handle_WU,
+        [ADDI]  = &&handle_ADDI,
+        [BEQ]   = &&handle_BEQ,
+        [BNE]   = &&handle_BNE,
+        [BLT]   = &&handle_BLT,
+        [BNT]   = &&handle_BNT,
+        [SRV]   = &&handle_SRV,
+        [BNM]   = &&handle_BNM,
+        [EXE_INC]       = &&handle_EXE_INC,
+        [EXE_ADV]       = &&handle_EXE_ADV,
+        [EXE_INC_ADV]   = &&handle_EXE_INC_ADV,
+        [WU_EIT]        = &&handle_WU_EIT,
+    };
+
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    if (!context->loaded) {
+        context = _lf_sched_load_context(worker_number);
+    }
 
+    const decoded_inst_t* current_program = context->program;
+    reaction_t*     returned_reaction   = NULL;
+    size_t          pc                  = context->pc;
+    int             iteration           = context->iteration;
+    size_t          epoch               = context->epoch;
+    size_t          loop_end            = context->loop_end;
+    size_t          loop_exit           = context->loop_exit;
+    long long int* const registers      = context->registers;
+    const decoded_inst_t* inst;
+    _LF_SCHED_PROFILE_ENTER(worker_number);
+
+// Fetch the instruction at pc and jump to its handler. Opcodes were checked
+// when the program was decoded.
+#define DISPATCH() \
+    do { \
+        inst = &current_program[pc]; \
+        _LF_SCHED_PRINT_INST(worker_number, pc); \
+        _LF_SCHED_PROFILE_STEP(worker_number, pc); \
+        goto *dispatch_table[inst->op]; \
+    } while (0)
+
+    DISPATCH();
+
+handle_ADV:
+    _lf_sched_advance_reactor_tag(inst->rs1.reactor, inst->rs2, false);
+    pc++;
+    DISPATCH();
+
+handle_ADV2:
+    _lf_sched_advance_reactor_tag(inst->rs1.reactor, inst->rs2, true);
+    pc++;
+    DISPATCH();
+
+handle_BIT:
+    if (_lf_sched_should_stop(epoch)) pc = inst->rs1.target;
+    else pc++;
+    DISPATCH();
+
+handle_DU: {
+    interval_t lateness = _lf_sched_delay_until(worker_number, inst->rs1.value, inst->rs2, iteration);
+    _LF_SCHED_PROFILE_LATENESS(worker_number, pc, lateness);
+    pc++;
+    }
+    DISPATCH();
+
+handle_EIT:
+    pc++;
+    if (inst->rs1.reaction->status == queued) {
+        returned_reaction = inst->rs1.reaction;
+        goto exit_loop;
+    }
+    LF_PRINT_DEBUG("*** Worker %d skip execution", worker_number);
+    DISPATCH();
+
+handle_EXE:
+    pc++;
+    returned_reaction = inst->rs1.reaction;
+    goto exit_loop;
+
+handle_INC:
+    _lf_sched_increment_counter(inst->rs1.counter, inst->rs2, false);
+    pc++;
+    DISPATCH();
+
+handle_INC2:
+    _lf_sched_increment_counter(inst->rs1.counter, inst->rs2, true);
+    pc++;
+    DISPATCH();
+
+handle_JMP:
+    if (inst->rs2 > 0) iteration += inst->rs2;
+    if (pc == loop_end) epoch++;
+    pc = inst->rs1.target;
+    DISPATCH();
+
+handle_SAC:
+    if (_lf_sched_sync_workers(worker_number, pc, iteration)) {
+        // Switched schedules (see scheduler_swap.h).
+        current_program = context->program;
+        pc = context->pc;
+        iteration = context->iteration;
+        epoch = context->epoch;
+        loop_end = context->loop_end;
+        loop_exit = context->loop_exit;
+    } else {
+        pc++;
+    }
+    DISPATCH();
+
+handle_STP:
+    goto exit_loop;
+
+handle_WU:
+    if (_lf_sched_wait_for_counter(worker_number, inst->rs1.counter, inst->rs2, epoch)) pc++;
+    else pc = loop_exit;
+    DISPATCH();
+
+handle_ADDI:
+    registers[inst->rs1.value] = inst_add_immediate(registers[inst->rs1.value], inst->rs2);
+    pc++;
+    DISPATCH();
+
+handle_BEQ:
+    if (registers[inst->rs2] == 0) pc = inst->rs1.target;
+    else pc++;
+    DISPATCH();
+
+handle_BNE:
+    if (registers[inst->rs2] != 0) pc = inst->rs1.target;
+    else pc++;
+    DISPATCH();
+
+handle_BLT:
+    if (registers[inst->rs2] < 0) pc = inst->rs1.target;
+    else pc++;
+    DISPATCH();
+
+handle_BNT:
+    if (inst->rs1.reaction->status != queued) pc = inst->rs2;
+    else pc++;
+    DISPATCH();
+
+handle_SRV:
+    _lf_sched_serve_sporadic(worker_number, pc, inst->rs1.value);
+    pc++;
+    DISPATCH();
+
+handle_BNM:
+    if (!_lf_sched_mode_is_active(inst->rs1.mode)) pc = inst->rs2;
+    else pc++;
+    DISPATCH();
+
+handle_EXE_INC:
+    _lf_sched_run_reaction(worker_number, pc, inst[0].rs1.reaction);
+    _lf_sched_increment_counter(inst[1].rs1.counter, inst[1].rs2, inst[1].op == INC2);
+    pc += 2;
+    DISPATCH();
+
+handle_EXE_ADV:
+    _lf_sched_run_reaction(worker_number, pc, inst[0].rs1.reaction);
+    _lf_sched_advance_reactor_tag(inst[1].rs1.reactor, inst[1].rs2, inst[1].op == ADV2);
+    pc += 2;
+    DISPATCH();
+
+handle_EXE_INC_ADV:
+    _lf_sched_run_reaction(worker_number, pc, inst[0].rs1.reaction);
+    _lf_sched_increment_counter(inst[1].rs1.counter, inst[1].rs2, inst[1].op == INC2);
+    _lf_sched_advance_reactor_tag(inst[2].rs1.reactor, inst[2].rs2, inst[2].op == ADV2);
+    pc += 3;
+    DISPATCH();
+
+handle_WU_EIT:
+    if (!_lf_sched_wait_for_counter(worker_number, inst[0].rs1.counter, inst[0].rs2, epoch)) {
+        pc = loop_exit;
+        DISPATCH();
+    }
+    if (inst[1].rs1.reaction->status == queued) {
+        _lf_sched_run_reaction(worker_number, pc, inst[1].rs1.reaction);
+    }
+    pc += 2;
+    DISPATCH();
+
+#undef DISPATCH
+
+exit_loop:
+    _LF_SCHED_PROFILE_EXIT(worker_number, returned_reaction);
+    context->pc = pc;
+    context->iteration = iteration;
+    context->epoch = epoch;
     LF_PRINT_DEBUG("Worker %d leaves lf_sched_get_ready_reaction", worker_number);
     return returned_reaction;
 }
+#endif // FS_COMPILED, FS_THREADED_DISPATCH
+
+#if !defined(FS_COMPILED) && !defined(FS_PROFILE)
+/**
+ * @brief Whether any output of `reaction` triggers `other` directly.
+ */
+static bool _lf_sched_may_trigger(reaction_t* reaction, reaction_t* other) {
+    for (size_t i = 0; i < reaction->num_outputs; i++) {
+        for (int j = 0; j < reaction->triggered_sizes[i]; j++) {
+            trigger_t* trigger = reaction->triggers[i][j];
+            if (trigger == NULL) continue;
+            for (int k = 0; k < trigger->number_of_reactions; k++) {
+                if (trigger->reactions[k] == other) return true;
+            }
+        }
+    }
+    return false;
+}
+#endif
+
+/**
+ * @brief Ask the scheduler for a run-list of reactions.
+ *
+ * The VM returns the reaction of an EXE or EIT as usual. The EXEs and EITs
+ * that directly follow it are taken without entering the VM again, and the
+ * pc moves past them: an EXE appends its reaction, and an EIT appends its
+ * reaction if it is queued and skips it otherwise, as the VM would. Since
+ * the status of an EIT's reaction is read before the reactions ahead of it
+ * in the run-list have run, an EIT whose reaction one of those can trigger
+ * ends the run-list instead. Likewise, the reactions in the run-list stay
+ * queued until `lf_sched_done_with_reactions()`, so a trigger of one of
+ * them by a later reaction would be lost, and an EXE or EIT whose reaction
+ * can trigger one of those ends the run-list too. With FS_PROFILE, every
+ * reaction is returned on its own so that the profile charges it to its own
+ * line.
+ *
+ * @param worker_number
+ * @param run_list Filled in with the reactions.
+ * @param capacity The length of `run_list`.
+ * @return The number of reactions in `run_list`. 0 if the calling worker
+ * thread should exit.
+ */
+size_t lf_sched_get_ready_reactions(int worker_number, reaction_t** run_list, size_t capacity) {
+    reaction_t* reaction = lf_sched_get_ready_reaction(worker_number);
+    if (reaction == NULL) return 0;
+    run_list[0] = reaction;
+    size_t count = 1;
+#if !defined(FS_COMPILED) && !defined(FS_PROFILE)
+    lf_sched_worker_context_t* context = _lf_sched_context(worker_number);
+    const decoded_inst_t* program = context->program;
+    size_t* pc = &context->pc;
+    while (count < capacity) {
+        const decoded_inst_t* inst = &program[*pc];
+        if (inst->op != EIT && inst->op != EXE) break;
+        reaction_t* candidate = inst->rs1.reaction;
+        for (size_t i = 0; i < count; i++) {
+            if ((inst->op == EIT && _lf_sched_may_trigger(run_list[i], candidate))
+                    || _lf_sched_may_trigger(candidate, run_list[i])) {
+                return count;
+            }
+        }
+        _LF_SCHED_PRINT_INST(worker_number, *pc);
+        if (inst->op == EXE || candidate->status == queued) {
+            run_list[count++] = candidate;
+        } else {
+            LF_PRINT_DEBUG("*** Worker %d skip execution", worker_number);
+        }
+        (*pc)++;
+    }
+#endif
+    return count;
+}
 
 /**
  * @brief Inform the scheduler that worker thread 'worker_number' is done
@@ -584,6 +3072,27 @@ void lf_sched_done_with_reaction(size_t worker_number,
     LF_PRINT_DEBUG("*** Worker %zu reports updated status for %s: %u", worker_number, done_reaction->name, done_reaction->status);
 }
 
+/**
+ * @brief Inform the scheduler that worker thread 'worker_number' is done
+ * executing a run-list.
+ *
+ * Reactions run by EXE are often inactive, e.g., timer reactions, so the
+ * status is read first and the compare-and-swap of
+ * `lf_sched_done_with_reaction()` only done for queued reactions.
+ *
+ * @param worker_number The worker number for the worker thread that has
+ * finished executing the run-list.
+ * @param run_list The reactions that are done.
+ * @param count The number of reactions in `run_list`.
+ */
+void lf_sched_done_with_reactions(size_t worker_number, reaction_t** run_list, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        if (run_list[i]->status == queued) {
+            lf_sched_done_with_reaction(worker_number, run_list[i]);
+        }
+    }
+}
+
 /**
  * @brief Inform the scheduler that worker thread 'worker_number' would like to
  * trigger 'reaction' at the current tag.
@@ -591,7 +3100,9 @@ void lf_sched_done_with_reaction(size_t worker_number,
  * If a worker number is not available (e.g., this function is not called by a
  * worker thread), -1 should be passed as the 'worker_number'.
  *
- * This scheduler ignores the worker number.
+ * This scheduler ignores the worker number. A reaction that an EIT polls
+ * only needs to be marked as queued, while a sporadic reaction is also put
+ * into the queue that SRV serves (see scheduler_instructions.h).
  *
  * The scheduler will ensure that the same reaction is not triggered twice in
  * the same tag.
@@ -612,6 +3123,15 @@ void lf_sched_trigger_reaction(reaction_t* reaction, int worker_number) {
         // lf_print_error_and_exit("Worker %d reports unexpected reaction status for reaction %s: %d. Expected %d.",
         //                         worker_number, reaction->name,
         //                         reaction->status, inactive);
+        return;
+    }
+    // A sporadic reaction is not polled by any EIT, so queue it for SRV.
+    if (_lf_sched_is_sporadic(reaction)) {
+        lf_mutex_t* queue_mutex = &_lf_sched_instance->_lf_sched_array_of_mutexes[0];
+        lf_mutex_lock(queue_mutex);
+        pqueue_insert((pqueue_t*)_lf_sched_instance->_lf_sched_triggered_reactions, reaction);
+        atomic_fetch_add_explicit(&_lf_sched_instance->sporadic_pending, 1, memory_order_relaxed);
+        lf_mutex_unlock(queue_mutex);
     }
 }
 #endif
@@ -341,51 +341,65 @@ void lf_sched_free() {
 
 ///////////////////// Scheduler Worker API (public) /////////////////////////
 /**
- * @brief Ask the scheduler for one more reaction.
+ * @brief Ask the scheduler for a run-list of reactions.
  *
- * This function blocks until it can return a ready reaction for worker thread
- * 'worker_number' or it is time for the worker thread to stop and exit (where a
- * NULL value would be returned).
+ * This function blocks until it can return ready reactions for worker thread
+ * 'worker_number' or it is time for the worker thread to stop and exit (where 0
+ * would be returned).
+ *
+ * Reactions at the same level are independent, so the worker takes several
+ * of the current level at once: its share if the level were divided evenly
+ * among all workers, but at least one and at most `capacity`.
  *
  * @param worker_number
- * @return reaction_t* A reaction for the worker to execute. NULL if the calling
- * worker thread should exit.
+ * @param run_list Filled in with the reactions.
+ * @param capacity The length of `run_list`.
+ * @return The number of reactions in `run_list`. 0 if the calling worker
+ * thread should exit.
  */
-reaction_t* lf_sched_get_ready_reaction(int worker_number) {
+size_t lf_sched_get_ready_reactions(int worker_number, reaction_t** run_list, size_t capacity) {
     // Iterate until the stop tag is reached or reaction vectors are empty
     while (!_lf_sched_instance->_lf_sched_should_stop) {
         // Calculate the current level of reactions to execute
         size_t current_level =
             _lf_sched_instance->_lf_sched_next_reaction_level - 1;
-        reaction_t* reaction_to_return = NULL;
+        size_t count = 0;
 #ifdef FEDERATED
         // Need to lock the mutex because federate.c could trigger reactions at
         // the current level (if there is a causality loop)
         lf_mutex_lock(
             &_lf_sched_instance->_lf_sched_array_of_mutexes[current_level]);
 #endif
+        // The number of reactions left is only a hint, since other workers
+        // take reactions concurrently.
+        int remaining = _lf_sched_instance->_lf_sched_indexes[current_level];
+        size_t workers = _lf_sched_instance->_lf_sched_number_of_workers;
+        size_t take = remaining > 0 ? ((size_t)remaining + workers - 1) / workers : 1;
+        take = LF_MAX(1, LF_MIN(take, capacity));
         int current_level_q_index = lf_atomic_add_fetch(
-            &_lf_sched_instance->_lf_sched_indexes[current_level], -1);
-        if (current_level_q_index >= 0) {
+            &_lf_sched_instance->_lf_sched_indexes[current_level], -(int)take);
+        // This worker owns the entries in [current_level_q_index,
+        // current_level_q_index + take) that are not negative.
+        for (int i = current_level_q_index + (int)take - 1; i >= 0 && i >= current_level_q_index; i--) {
             LF_PRINT_DEBUG(
                 "Scheduler: Worker %d popping reaction with level %zu, index "
                 "for level: %d.",
-                worker_number, current_level, current_level_q_index
+                worker_number, current_level, i
             );
-            reaction_to_return =
+            run_list[count++] =
                 ((reaction_t**)_lf_sched_instance->
-                    _lf_sched_executing_reactions)[current_level_q_index];
+                    _lf_sched_executing_reactions)[i];
             ((reaction_t**)_lf_sched_instance->
-                    _lf_sched_executing_reactions)[current_level_q_index] = NULL;
+                    _lf_sched_executing_reactions)[i] = NULL;
         }
 #ifdef FEDERATED
         lf_mutex_unlock(
             &_lf_sched_instance->_lf_sched_array_of_mutexes[current_level]);
 #endif
 
-        if (reaction_to_return != NULL) {
-            // Got a reaction
-            return reaction_to_return;
+        if (count > 0) {
+            // Got reactions
+            return count;
         }
 
         LF_PRINT_DEBUG("Worker %d is out of ready reactions.", worker_number);
@@ -397,7 +411,23 @@ reaction_t* lf_sched_get_ready_reaction(int worker_number) {
     }
 
     // It's time for the worker thread to stop and exit.
-    return NULL;
+    return 0;
+}
+
+/**
+ * @brief Ask the scheduler for one more reaction.
+ *
+ * This function blocks until it can return a ready reaction for worker thread
+ * 'worker_number' or it is time for the worker thread to stop and exit (where a
+ * NULL value would be returned).
+ *
+ * @param worker_number
+ * @return reaction_t* A reaction for the worker to execute. NULL if the calling
+ * worker thread should exit.
+ */
+reaction_t* lf_sched_get_ready_reaction(int worker_number) {
+    reaction_t* reaction;
+    return lf_sched_get_ready_reactions(worker_number, &reaction, 1) > 0 ? reaction : NULL;
 }
 
 /**
@@ -416,6 +446,21 @@ void lf_sched_done_with_reaction(size_t worker_number,
     }
 }
 
+/**
+ * @brief Inform the scheduler that worker thread 'worker_number' is done
+ * executing a run-list.
+ *
+ * @param worker_number The worker number for the worker thread that has
+ * finished executing the run-list.
+ * @param run_list The reactions that are done.
+ * @param count The number of reactions in `run_list`.
+ */
+void lf_sched_done_with_reactions(size_t worker_number, reaction_t** run_list, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        lf_sched_done_with_reaction(worker_number, run_list[i]);
+    }
+}
+
 /**
  * @brief Inform the scheduler that worker thread 'worker_number' would like to
  * trigger 'reaction' at the current tag.
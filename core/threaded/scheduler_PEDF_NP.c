@@ -643,6 +643,27 @@ void lf_sched_done_with_reaction(size_t worker_number, reaction_t* done_reaction
     vector_push(&_lf_sched_threads_info[worker_number].done_reactions, (void*)done_reaction);
 }
 
+/**
+ * @brief Ask the scheduler for a run-list of reactions.
+ *
+ * This scheduler hands out one reaction at a time (see
+ * `lf_sched_get_ready_reaction()`).
+ */
+size_t lf_sched_get_ready_reactions(int worker_number, reaction_t** run_list, size_t capacity) {
+    run_list[0] = lf_sched_get_ready_reaction(worker_number);
+    return run_list[0] != NULL ? 1 : 0;
+}
+
+/**
+ * @brief Inform the scheduler that worker thread 'worker_number' is done
+ * executing a run-list.
+ */
+void lf_sched_done_with_reactions(size_t worker_number, reaction_t** run_list, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        lf_sched_done_with_reaction(worker_number, run_list[i]);
+    }
+}
+
 /**
  * @brief Inform the scheduler that worker thread 'worker_number' would like to
  * trigger 'reaction' at the current tag.
@@ -122,6 +122,18 @@ void lf_sched_done_with_reaction(size_t worker_number, reaction_t* done_reaction
     done_reaction->status = inactive;
 }
 
+size_t lf_sched_get_ready_reactions(int worker_number, reaction_t** run_list, size_t capacity) {
+    // Reactions are handed out one at a time.
+    run_list[0] = lf_sched_get_ready_reaction(worker_number);
+    return run_list[0] != NULL ? 1 : 0;
+}
+
+void lf_sched_done_with_reactions(size_t worker_number, reaction_t** run_list, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        lf_sched_done_with_reaction(worker_number, run_list[i]);
+    }
+}
+
 void lf_sched_trigger_reaction(reaction_t* reaction, int worker_number) {
     assert(worker_number >= -1);
     if (!lf_bool_compare_and_swap(&reaction->status, inactive, queued)) return;
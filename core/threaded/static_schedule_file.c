@@ -0,0 +1,463 @@
+/**
+ * @file static_schedule_file.c
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief Reading and writing static schedule files.
+ *
+ * See static_schedule_file.h for the layout.
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "static_schedule_file.h"
+
+/** The alignment of the instruction arrays in a file. */
+#define SECTION_ALIGNMENT 8
+
+static size_t align_up(size_t n) {
+    return (n + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+/**
+ * @brief Continue the 32-bit FNV-1a hash `hash` over `size` bytes.
+ */
+static uint32_t fnv1a(uint32_t hash, const void* data, size_t size) {
+    const unsigned char* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+#define FNV1A_INIT 2166136261u
+
+#if defined(_WIN32)
+/**
+ * @brief Read a whole file into memory. Used where mmap is unavailable.
+ */
+static void* read_file(const char* path, size_t* size) {
+    FILE* file = fopen(path, "rb");
+    if (file == NULL) return NULL;
+    void* data = NULL;
+    if (fseek(file, 0, SEEK_END) == 0) {
+        long end = ftell(file);
+        if (end >= 0 && fseek(file, 0, SEEK_SET) == 0) {
+            data = malloc(end > 0 ? (size_t)end : 1);
+            if (data != NULL && fread(data, 1, (size_t)end, file) != (size_t)end) {
+                free(data);
+                data = NULL;
+            }
+            *size = (size_t)end;
+        }
+    }
+    fclose(file);
+    return data;
+}
+#endif
+
+/**
+ * @brief Free the per-worker arrays that `parse()` allocates.
+ */
+static void free_arrays(static_schedule_t* schedule) {
+    free(schedule->schedules);
+    free(schedule->schedule_lengths);
+    free(schedule->reaction_bases);
+    free(schedule->reactor_bases);
+    free(schedule->cpus);
+}
+
+/**
+ * @brief Check a file image and fill in `schedule` with pointers into it.
+ */
+static int parse(void* data, size_t size, static_schedule_t* schedule, const char** error) {
+    const unsigned char* base = data;
+    static_schedule_file_header_t header;
+    if (size < sizeof(header)) {
+        *error = "file is too short to hold a header";
+        return -1;
+    }
+    memcpy(&header, base, sizeof(header));
+    if (memcmp(header.magic, STATIC_SCHEDULE_FILE_MAGIC, sizeof(header.magic)) != 0) {
+        *error = "not a static schedule file";
+        return -1;
+    }
+    if (header.byte_order != STATIC_SCHEDULE_FILE_BYTE_ORDER) {
+        *error = "file was written on a machine with a different byte order";
+        return -1;
+    }
+    if (header.version != STATIC_SCHEDULE_FILE_VERSION) {
+        *error = "unsupported file version";
+        return -1;
+    }
+    if (header.inst_size != sizeof(inst_t)) {
+        *error = "file was written on a machine with a different instruction layout";
+        return -1;
+    }
+    if (header.wait_policy > WAIT_BLOCK) {
+        *error = "unknown wait policy";
+        return -1;
+    }
+    if (fnv1a(FNV1A_INIT, base + sizeof(header), size - sizeof(header)) != header.checksum) {
+        *error = "checksum mismatch";
+        return -1;
+    }
+
+    // The fixed-size tables follow the header directly.
+    size_t sections_offset = sizeof(header);
+    size_t reaction_table_offset = sections_offset
+            + (size_t)header.num_workers * sizeof(static_schedule_file_section_t);
+    size_t reactor_table_offset = reaction_table_offset
+            + (size_t)header.num_reactions * sizeof(uint32_t);
+    size_t tables_end = reactor_table_offset + (size_t)header.num_reactors * sizeof(uint32_t);
+    if (tables_end > size) {
+        *error = "file is too short to hold its tables";
+        return -1;
+    }
+
+    schedule->schedules = calloc(header.num_workers, sizeof(inst_t*));
+    schedule->schedule_lengths = calloc(header.num_workers, sizeof(size_t));
+    schedule->reaction_bases = calloc(header.num_workers, sizeof(size_t));
+    schedule->reactor_bases = calloc(header.num_workers, sizeof(size_t));
+    schedule->cpus = calloc(header.num_workers, sizeof(int));
+    if (header.num_workers > 0 && (schedule->schedules == NULL || schedule->schedule_lengths == NULL
+                                   || schedule->reaction_bases == NULL || schedule->reactor_bases == NULL
+                                   || schedule->cpus == NULL)) {
+        free_arrays(schedule);
+        *error = "out of memory";
+        return -1;
+    }
+    for (size_t i = 0; i < header.num_workers; i++) {
+        static_schedule_file_section_t section;
+        memcpy(&section, base + sections_offset + i * sizeof(section), sizeof(section));
+        if (section.offset % SECTION_ALIGNMENT != 0
+                || section.offset < tables_end
+                || section.offset > size
+                || section.length > (size - section.offset) / sizeof(inst_t)) {
+            free_arrays(schedule);
+            *error = "a worker's instructions lie outside the file";
+            return -1;
+        }
+        if (section.cpu < STATIC_SCHEDULE_NO_CPU) {
+            free_arrays(schedule);
+            *error = "a worker's CPU is invalid";
+            return -1;
+        }
+        // Sections may overlap: workers that run the same template share it.
+        schedule->schedules[i] = (const inst_t*)(base + section.offset);
+        schedule->schedule_lengths[i] = section.length;
+        schedule->reaction_bases[i] = section.reaction_base;
+        schedule->reactor_bases[i] = section.reactor_base;
+        schedule->cpus[i] = section.cpu;
+    }
+
+    schedule->num_workers = header.num_workers;
+    schedule->num_counters = header.num_counters;
+    schedule->num_reactions = header.num_reactions;
+    schedule->reaction_table = (const uint32_t*)(base + reaction_table_offset);
+    schedule->num_reactors = header.num_reactors;
+    schedule->reactor_table = (const uint32_t*)(base + reactor_table_offset);
+    schedule->wait_policy = header.wait_policy;
+    schedule->mapping = data;
+    schedule->mapping_size = size;
+    return 0;
+}
+
+int static_schedule_map(const char* path, static_schedule_t* schedule, const char** error) {
+    memset(schedule, 0, sizeof(*schedule));
+    void* data;
+    size_t size = 0;
+#if !defined(_WIN32)
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        *error = "cannot open file";
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size == 0) {
+        close(fd);
+        *error = "cannot read file";
+        return -1;
+    }
+    size = (size_t)st.st_size;
+    data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        *error = "cannot map file";
+        return -1;
+    }
+    if (parse(data, size, schedule, error) != 0) {
+        munmap(data, size);
+        return -1;
+    }
+#else
+    data = read_file(path, &size);
+    if (data == NULL) {
+        *error = "cannot read file";
+        return -1;
+    }
+    if (parse(data, size, schedule, error) != 0) {
+        free(data);
+        return -1;
+    }
+#endif
+    return 0;
+}
+
+void static_schedule_unmap(static_schedule_t* schedule) {
+    if (schedule->mapping != NULL) {
+#if !defined(_WIN32)
+        munmap(schedule->mapping, schedule->mapping_size);
+#else
+        free(schedule->mapping);
+#endif
+    }
+    free_arrays(schedule);
+    memset(schedule, 0, sizeof(*schedule));
+}
+
+/**
+ * @brief Append `size` bytes to a buffer, growing it as needed.
+ */
+static int append(unsigned char** buffer, size_t* length, size_t* capacity,
+                  const void* data, size_t size) {
+    if (*length + size > *capacity) {
+        size_t new_capacity = *capacity ? *capacity : 4096;
+        while (new_capacity < *length + size) new_capacity *= 2;
+        unsigned char* grown = realloc(*buffer, new_capacity);
+        if (grown == NULL) return -1;
+        *buffer = grown;
+        *capacity = new_capacity;
+    }
+    if (data != NULL) memcpy(*buffer + *length, data, size);
+    else memset(*buffer + *length, 0, size);
+    *length += size;
+    return 0;
+}
+
+/**
+ * @brief The first worker whose instructions `worker` can share, i.e., that
+ * has the same schedule array and length, or `worker` itself.
+ */
+static size_t shared_with(const static_schedule_t* schedule, size_t worker) {
+    for (size_t i = 0; i < worker; i++) {
+        if (schedule->schedules[i] == schedule->schedules[worker]
+                && schedule->schedule_lengths[i] == schedule->schedule_lengths[worker]) {
+            return i;
+        }
+    }
+    return worker;
+}
+
+int static_schedule_write(const char* path, const static_schedule_t* schedule, const char** error) {
+    unsigned char* buffer = NULL;
+    size_t length = 0;
+    size_t capacity = 0;
+    int failed = 0;
+
+    static_schedule_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, STATIC_SCHEDULE_FILE_MAGIC, sizeof(header.magic));
+    header.version = STATIC_SCHEDULE_FILE_VERSION;
+    header.byte_order = STATIC_SCHEDULE_FILE_BYTE_ORDER;
+    header.num_workers = (uint32_t)schedule->num_workers;
+    header.num_counters = (uint32_t)schedule->num_counters;
+    header.num_reactions = (uint32_t)schedule->num_reactions;
+    header.num_reactors = (uint32_t)schedule->num_reactors;
+    header.inst_size = sizeof(inst_t);
+    header.wait_policy = schedule->wait_policy;
+    failed |= append(&buffer, &length, &capacity, &header, sizeof(header));
+
+    // Sections, with offsets computed up front. A worker whose schedule is
+    // the same array as that of an earlier worker shares its instructions.
+    uint64_t* offsets = malloc((schedule->num_workers + 1) * sizeof(uint64_t));
+    if (offsets == NULL) {
+        free(buffer);
+        *error = "out of memory";
+        return -1;
+    }
+    size_t offset = align_up(sizeof(header)
+            + schedule->num_workers * sizeof(static_schedule_file_section_t)
+            + (schedule->num_reactions + schedule->num_reactors) * sizeof(uint32_t));
+    for (size_t i = 0; i < schedule->num_workers; i++) {
+        size_t shared = shared_with(schedule, i);
+        offsets[i] = shared < i ? offsets[shared] : offset;
+        static_schedule_file_section_t section = {
+            .offset = offsets[i],
+            .length = schedule->schedule_lengths[i],
+            .reaction_base = schedule->reaction_bases != NULL ? (uint32_t)schedule->reaction_bases[i] : 0,
+            .reactor_base = schedule->reactor_bases != NULL ? (uint32_t)schedule->reactor_bases[i] : 0,
+            .cpu = schedule->cpus != NULL ? (int32_t)schedule->cpus[i] : STATIC_SCHEDULE_NO_CPU,
+        };
+        failed |= append(&buffer, &length, &capacity, &section, sizeof(section));
+        if (shared == i) offset = align_up(offset + schedule->schedule_lengths[i] * sizeof(inst_t));
+    }
+    free(offsets);
+
+    // Tables.
+    for (size_t i = 0; i < schedule->num_reactions; i++) {
+        uint32_t entry = schedule->reaction_table ? schedule->reaction_table[i] : (uint32_t)i;
+        failed |= append(&buffer, &length, &capacity, &entry, sizeof(entry));
+    }
+    for (size_t i = 0; i < schedule->num_reactors; i++) {
+        uint32_t entry = schedule->reactor_table ? schedule->reactor_table[i] : (uint32_t)i;
+        failed |= append(&buffer, &length, &capacity, &entry, sizeof(entry));
+    }
+
+    // Instructions. Copy them field by field so that padding is written as 0.
+    for (size_t i = 0; i < schedule->num_workers; i++) {
+        if (shared_with(schedule, i) != i) continue;
+        failed |= append(&buffer, &length, &capacity, NULL, align_up(length) - length);
+        for (size_t pc = 0; pc < schedule->schedule_lengths[i]; pc++) {
+            inst_t inst;
+            memset(&inst, 0, sizeof(inst));
+            inst.op = schedule->schedules[i][pc].op;
+            inst.rs1 = schedule->schedules[i][pc].rs1;
+            inst.rs2 = schedule->schedules[i][pc].rs2;
+            failed |= append(&buffer, &length, &capacity, &inst, sizeof(inst));
+        }
+    }
+
+    if (failed) {
+        free(buffer);
+        *error = "out of memory";
+        return -1;
+    }
+
+    header.checksum = fnv1a(FNV1A_INIT, buffer + sizeof(header), length - sizeof(header));
+    memcpy(buffer, &header, sizeof(header));
+
+    FILE* file = fopen(path, "wb");
+    if (file == NULL) {
+        free(buffer);
+        *error = "cannot create file";
+        return -1;
+    }
+    if (fwrite(buffer, 1, length, file) != length) {
+        failed = 1;
+    }
+    if (fclose(file) != 0) {
+        failed = 1;
+    }
+    free(buffer);
+    if (failed) {
+        *error = "cannot write file";
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Add the base of a worker, if any, to an operand, and look the
+ * result up in a table, if there is one and the result is in it.
+ */
+static int64_t resolve(int64_t operand, const size_t* bases, size_t worker,
+                       const uint32_t* table, size_t table_size) {
+    int64_t index = (int64_t)((uint64_t)operand + (bases != NULL ? bases[worker] : 0));
+    if (table != NULL && index >= 0 && (uint64_t)index < table_size) index = table[index];
+    return index;
+}
+
+size_t static_schedule_reaction_index(const static_schedule_t* schedule, size_t worker, long long int operand) {
+    return (size_t)resolve(operand, schedule->reaction_bases, worker,
+                           schedule->reaction_table, schedule->num_reactions);
+}
+
+size_t static_schedule_reactor_index(const static_schedule_t* schedule, size_t worker, long long int operand) {
+    return (size_t)resolve(operand, schedule->reactor_bases, worker,
+                           schedule->reactor_table, schedule->num_reactors);
+}
+
+uint32_t static_schedule_fingerprint(const static_schedule_t* schedule) {
+    uint32_t hash = FNV1A_INIT;
+    uint64_t num_workers = schedule->num_workers;
+    uint64_t num_counters = schedule->num_counters;
+    hash = fnv1a(hash, &num_workers, sizeof(num_workers));
+    hash = fnv1a(hash, &num_counters, sizeof(num_counters));
+    for (size_t i = 0; i < schedule->num_workers; i++) {
+        uint64_t length = schedule->schedule_lengths[i];
+        hash = fnv1a(hash, &length, sizeof(length));
+        for (size_t pc = 0; pc < schedule->schedule_lengths[i]; pc++) {
+            const inst_t* inst = &schedule->schedules[i][pc];
+            uint32_t op = inst->op;
+            int64_t rs1 = inst->rs1;
+            int64_t rs2 = inst->rs2;
+            // Operands outside the tables are hashed with their bases
+            // only. The verifier rejects them anyway.
+            if (op == EXE || op == EIT) {
+                rs1 = resolve(rs1, schedule->reaction_bases, i, schedule->reaction_table, schedule->num_reactions);
+            } else if (op == ADV || op == ADV2) {
+                rs1 = resolve(rs1, schedule->reactor_bases, i, schedule->reactor_table, schedule->num_reactors);
+            } else if (op == BNT || op == BNM) {
+                rs2 = resolve(rs2, schedule->reaction_bases, i, schedule->reaction_table, schedule->num_reactions);
+            }
+            hash = fnv1a(hash, &op, sizeof(op));
+            hash = fnv1a(hash, &rs1, sizeof(rs1));
+            hash = fnv1a(hash, &rs2, sizeof(rs2));
+        }
+    }
+    return hash;
+}
+
+size_t static_schedule_loop_end(const inst_t* schedule, size_t length) {
+    for (size_t pc = 0; pc < length; pc++) {
+        if (schedule[pc].op == JMP && schedule[pc].rs1 >= 0 && (size_t)schedule[pc].rs1 <= pc) {
+            return pc;
+        }
+    }
+    return STATIC_SCHEDULE_NO_LOOP;
+}
+
+size_t static_schedule_step(const inst_t* inst, size_t pc, long long int* registers) {
+    switch (inst->op) {
+        case ADDI:
+            registers[inst->rs1] = inst_add_immediate(registers[inst->rs1], inst->rs2);
+            return pc + 1;
+        case BEQ:
+        case BNE:
+        case BLT:
+            return inst_register_branch_taken(inst->op, registers[inst->rs2]) ? (size_t)inst->rs1 : pc + 1;
+        case JMP:
+            return (size_t)inst->rs1;
+        default:
+            return pc + 1;
+    }
+}
+
+void static_schedule_counter_offsets(const static_schedule_t* schedule,
+                                     unsigned long long* base, unsigned long long* per_epoch) {
+    for (size_t c = 0; c < schedule->num_counters; c++) {
+        if (base != NULL) base[c] = 0;
+        per_epoch[c] = 0;
+    }
+    for (size_t w = 0; w < schedule->num_workers; w++) {
+        const inst_t* insts = schedule->schedules[w];
+        size_t length = schedule->schedule_lengths[w];
+        size_t end = static_schedule_loop_end(insts, length);
+        size_t head = end == STATIC_SCHEDULE_NO_LOOP ? length : (size_t)insts[end].rs1;
+        long long int registers[INST_NUM_REGISTERS] = { 0 };
+        bool in_loop = false;
+        size_t pc = 0;
+        for (size_t steps = 0; pc < length && steps < STATIC_SCHEDULE_MAX_STEPS; steps++) {
+            const inst_t* inst = &insts[pc];
+            if (pc == head) in_loop = true;
+            if (inst->op == INC || inst->op == INC2) {
+                if (in_loop) {
+                    per_epoch[inst->rs1] += inst->rs2;
+                } else if (base != NULL) {
+                    base[inst->rs1] += inst->rs2;
+                }
+            }
+            if (pc == end || inst->op == STP) break;
+            pc = static_schedule_step(inst, pc, registers);
+        }
+    }
+}
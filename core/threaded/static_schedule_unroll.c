@@ -0,0 +1,342 @@
+/**
+ * @file static_schedule_unroll.c
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief Hyperperiod unrolling for the schedules of the FS scheduler.
+ *
+ * See static_schedule_unroll.h.
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "static_schedule_unroll.h"
+
+/** The largest WU target that a decoded instruction can hold. */
+#define COUNTER_MAX ((1ULL << 55) - 1)
+
+/** No worker, e.g., for a counter that no worker increments. */
+#define NO_WORKER ((size_t)-1)
+
+/** A counter that more than one worker increments. */
+#define SEVERAL_WORKERS ((size_t)-2)
+
+/**
+ * @brief Where the loop of a worker's schedule is.
+ */
+typedef struct {
+    size_t head;    // The BIT at the start of the loop.
+    size_t sac;     // The SAC at the end of the body, or `jmp` if there is none.
+    size_t jmp;     // The JMP back to `head`.
+} loop_t;
+
+/**
+ * @brief Find the loop of a schedule and check that it has the form that
+ * can be unrolled.
+ *
+ * @return NULL on success, or a description of the problem.
+ */
+static const char* find_loop(const inst_t* schedule, size_t length, size_t num_counters, loop_t* loop) {
+    size_t jmp = length;
+    for (size_t pc = 0; pc < length; pc++) {
+        if (schedule[pc].op == JMP && schedule[pc].rs1 >= 0 && (size_t)schedule[pc].rs1 <= pc) {
+            jmp = pc;
+            break;
+        }
+    }
+    if (jmp == length) return "a schedule has no loop";
+    size_t head = schedule[jmp].rs1;
+    if (schedule[head].op != BIT) return "a loop does not start with BIT";
+    if (schedule[head].rs1 < 0 || (size_t)schedule[head].rs1 <= jmp || (size_t)schedule[head].rs1 >= length) {
+        return "the BIT at the start of a loop does not leave the loop";
+    }
+
+    size_t sac = jmp;
+    for (size_t pc = head + 1; pc < jmp; pc++) {
+        switch (schedule[pc].op) {
+            case BIT:
+            case JMP:
+            case BEQ:
+            case BNE:
+            case BLT:
+            case BNT:
+            case BNM:
+            case STP:
+                return "a loop has branches other than its BIT and JMP";
+            case SAC:
+                if (sac != jmp) return "a loop has more than one SAC";
+                sac = pc;
+                break;
+            case INC:
+            case INC2:
+            case WU:
+                if (schedule[pc].rs1 < 0 || (size_t)schedule[pc].rs1 >= num_counters) {
+                    return "a counter is out of range";
+                }
+                if (sac != jmp) return "a loop uses a counter after its SAC";
+                break;
+            default:
+                break;
+        }
+    }
+    // Nothing outside the loop may jump into it, except to its start.
+    for (size_t pc = 0; pc < length; pc++) {
+        if (pc >= head && pc <= jmp) continue;
+        if (!inst_is_branch(schedule[pc].op)) continue;
+        long long int target = schedule[pc].rs1;
+        if (target < 0 || (size_t)target >= length) return "a jump target is outside the schedule";
+        if ((size_t)target > head && (size_t)target <= jmp) return "an instruction jumps into a loop";
+    }
+
+    loop->head = head;
+    loop->sac = sac;
+    loop->jmp = jmp;
+    return NULL;
+}
+
+/**
+ * @brief Find the loops of all workers and add up how much each counter is
+ * incremented per hyperperiod.
+ *
+ * @param increments Set to the increment of each counter per hyperperiod.
+ * @return NULL on success, or a description of the problem.
+ */
+static const char* analyze(const static_schedule_t* schedule, loop_t* loops, unsigned long long* increments) {
+    for (size_t w = 0; w < schedule->num_workers; w++) {
+        const char* problem = find_loop(schedule->schedules[w], schedule->schedule_lengths[w],
+                                        schedule->num_counters, &loops[w]);
+        if (problem != NULL) return problem;
+    }
+
+    // Which worker increments each counter, and how much.
+    size_t* writers = malloc(schedule->num_counters * sizeof(size_t) + 1);
+    if (writers == NULL) return "out of memory";
+    for (size_t c = 0; c < schedule->num_counters; c++) {
+        writers[c] = NO_WORKER;
+        increments[c] = 0;
+    }
+    for (size_t w = 0; w < schedule->num_workers; w++) {
+        for (size_t pc = loops[w].head + 1; pc < loops[w].sac; pc++) {
+            const inst_t* inst = &schedule->schedules[w][pc];
+            if (inst->op != INC && inst->op != INC2) continue;
+            if (inst->rs2 < 0) {
+                free(writers);
+                return "a counter is decremented";
+            }
+            increments[inst->rs1] += inst->rs2;
+            if (increments[inst->rs1] > COUNTER_MAX) {
+                free(writers);
+                return "a counter overflows";
+            }
+            if (writers[inst->rs1] == NO_WORKER) writers[inst->rs1] = w;
+            else if (writers[inst->rs1] != w) writers[inst->rs1] = SEVERAL_WORKERS;
+        }
+    }
+
+    // A WU must not depend on the increments of two other workers, since one
+    // of them may already be in the next copy.
+    const char* problem = NULL;
+    for (size_t w = 0; w < schedule->num_workers && problem == NULL; w++) {
+        for (size_t pc = loops[w].head + 1; pc < loops[w].sac && problem == NULL; pc++) {
+            const inst_t* inst = &schedule->schedules[w][pc];
+            if (inst->op != WU || writers[inst->rs1] != SEVERAL_WORKERS) continue;
+            size_t other = NO_WORKER;
+            for (size_t v = 0; v < schedule->num_workers && problem == NULL; v++) {
+                if (v == w) continue;
+                for (size_t p = loops[v].head + 1; p < loops[v].sac; p++) {
+                    const inst_t* inc = &schedule->schedules[v][p];
+                    if ((inc->op == INC || inc->op == INC2) && inc->rs1 == inst->rs1) {
+                        if (other == NO_WORKER) other = v;
+                        else if (other != v) problem = "a WU waits for a counter that several other workers increment";
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    free(writers);
+    return problem;
+}
+
+/**
+ * @brief Append an instruction to an unrolled loop, merging it into an ADV
+ * or ADV2 of the same reactor in the run of advances that it ends.
+ *
+ * @return false if the merged amount would overflow.
+ */
+static bool append(inst_t* out, size_t* length, size_t run_start, inst_t inst) {
+    if (inst.op == ADV || inst.op == ADV2) {
+        for (size_t i = *length; i > run_start && (out[i - 1].op == ADV || out[i - 1].op == ADV2); i--) {
+            inst_t* previous = &out[i - 1];
+            if (previous->op == inst.op && previous->rs1 == inst.rs1) {
+                if (inst.rs2 > 0 && previous->rs2 > INT64_MAX - inst.rs2) return false;
+                previous->rs2 += inst.rs2;
+                return true;
+            }
+        }
+    }
+    out[(*length)++] = inst;
+    return true;
+}
+
+/**
+ * @brief Unroll the schedule of one worker.
+ *
+ * @return NULL on success, or a description of the problem.
+ */
+static const char* unroll_worker(const inst_t* schedule, size_t length, const loop_t* loop,
+                                 const unsigned long long* increments, size_t factor,
+                                 inst_t** unrolled, size_t* unrolled_length) {
+    size_t contents = loop->jmp - loop->head - 1;   // Body, SAC, and tail.
+    if (contents == 0) return "a loop is empty";
+    if (factor - 1 > (SIZE_MAX / sizeof(inst_t) - length) / contents) return "the unrolled schedule is too long";
+    size_t copy = loop->sac < loop->jmp ? contents - 1 : contents;
+    size_t max_length = length + (factor - 1) * copy;
+    inst_t* out = malloc(max_length * sizeof(inst_t));
+    if (out == NULL) return "out of memory";
+    bool counts_hyperperiods = schedule[loop->jmp].rs2 > 0;
+
+    // The prologue and the BIT stay where they are.
+    memcpy(out, schedule, (loop->head + 1) * sizeof(inst_t));
+    size_t n = loop->head + 1;
+
+    // Runs of advances are only merged within the loop.
+    size_t run_start = n;
+    for (size_t j = 0; j < factor; j++) {
+        for (size_t pc = loop->head + 1; pc < loop->jmp; pc++) {
+            inst_t inst = schedule[pc];
+            if (inst.op == SAC && j + 1 < factor) continue;
+            if (inst.op == WU && j > 0 && inst.rs2 > 0) {
+                unsigned long long increment = increments[inst.rs1];
+                if (increment > 0 && j > (COUNTER_MAX - inst.rs2) / increment) {
+                    free(out);
+                    return "a counter overflows";
+                }
+                inst.rs2 += j * increment;
+            } else if (inst.op == DU && j > 0 && counts_hyperperiods) {
+                long long int offset = inst.rs2 > 0 ? inst.rs2 : 0;
+                if (inst.rs1 > 0 && (long long int)j > (INT64_MAX - offset) / inst.rs1) {
+                    free(out);
+                    return "a release time overflows";
+                }
+                inst.rs2 = offset + (long long int)j * (inst.rs1 > 0 ? inst.rs1 : 0);
+            }
+            if (!append(out, &n, run_start, inst)) {
+                free(out);
+                return "an advance overflows";
+            }
+        }
+    }
+
+    inst_t jmp = schedule[loop->jmp];
+    if (counts_hyperperiods) {
+        if (jmp.rs2 > INT64_MAX / (long long int)factor) {
+            free(out);
+            return "the hyperperiod count overflows";
+        }
+        jmp.rs2 *= factor;
+    }
+    out[n++] = jmp;
+
+    // The epilogue moves by the growth of the loop; jumps that pass the loop
+    // move with it.
+    size_t shift = n - (loop->jmp + 1);
+    memcpy(&out[n], &schedule[loop->jmp + 1], (length - loop->jmp - 1) * sizeof(inst_t));
+    n += length - loop->jmp - 1;
+    for (size_t pc = 0; pc < n; pc++) {
+        if (pc > loop->head && pc <= loop->jmp + shift) continue;
+        if (!inst_is_branch(out[pc].op)) continue;
+        if ((size_t)out[pc].rs1 > loop->jmp) out[pc].rs1 += shift;
+    }
+
+    *unrolled = out;
+    *unrolled_length = n;
+    return NULL;
+}
+
+int static_schedule_unroll(const static_schedule_t* schedule, size_t factor,
+                           static_schedule_t* unrolled, const char** error) {
+    memset(unrolled, 0, sizeof(*unrolled));
+    if (factor == 0) {
+        *error = "the unroll factor is out of range";
+        return -1;
+    }
+    loop_t* loops = malloc(schedule->num_workers * sizeof(loop_t) + 1);
+    unsigned long long* increments = malloc(schedule->num_counters * sizeof(unsigned long long) + 1);
+    const inst_t** schedules = calloc(schedule->num_workers + 1, sizeof(inst_t*));
+    size_t* lengths = calloc(schedule->num_workers + 1, sizeof(size_t));
+    if (loops == NULL || increments == NULL || schedules == NULL || lengths == NULL) {
+        free(loops);
+        free(increments);
+        free(schedules);
+        free(lengths);
+        *error = "out of memory";
+        return -1;
+    }
+
+    const char* problem = analyze(schedule, loops, increments);
+    for (size_t w = 0; w < schedule->num_workers && problem == NULL; w++) {
+        inst_t* out;
+        problem = unroll_worker(schedule->schedules[w], schedule->schedule_lengths[w], &loops[w],
+                                increments, factor, &out, &lengths[w]);
+        if (problem == NULL) schedules[w] = out;
+    }
+    free(loops);
+    free(increments);
+
+    *unrolled = *schedule;
+    unrolled->schedules = schedules;
+    unrolled->schedule_lengths = lengths;
+    unrolled->mapping = NULL;
+    unrolled->mapping_size = 0;
+    if (problem != NULL) {
+        static_schedule_unroll_free(unrolled);
+        *error = problem;
+        return -1;
+    }
+    return 0;
+}
+
+void static_schedule_unroll_free(static_schedule_t* unrolled) {
+    if (unrolled->schedules != NULL) {
+        for (size_t w = 0; w < unrolled->num_workers; w++) {
+            free((void*)unrolled->schedules[w]);
+        }
+    }
+    free(unrolled->schedules);
+    free(unrolled->schedule_lengths);
+    unrolled->schedules = NULL;
+    unrolled->schedule_lengths = NULL;
+}
+
+size_t static_schedule_choose_unroll_factor(const static_schedule_t* schedule,
+                                            const static_schedule_unroll_profile_t* profile) {
+    double barrier = profile->barrier_ns;
+    double work = profile->hyperperiod_ns - barrier;
+    double max_overhead = profile->max_overhead > 0 ? profile->max_overhead : 0.01;
+    size_t max_instructions = profile->max_instructions > 0
+            ? profile->max_instructions : STATIC_SCHEDULE_UNROLL_MAX_INSTRUCTIONS;
+    if (barrier <= 0) return 1;
+
+    loop_t* loops = malloc(schedule->num_workers * sizeof(loop_t) + 1);
+    unsigned long long* increments = malloc(schedule->num_counters * sizeof(unsigned long long) + 1);
+    size_t factor = 1;
+    if (loops != NULL && increments != NULL && analyze(schedule, loops, increments) == NULL) {
+        // The overhead with factor k is barrier / (k * work + barrier).
+        while (factor < STATIC_SCHEDULE_UNROLL_MAX_FACTOR
+               && barrier > max_overhead * (factor * work + barrier)) {
+            // Without merges, each copy adds the loop without its BIT, SAC,
+            // and JMP.
+            bool fits = true;
+            for (size_t w = 0; w < schedule->num_workers; w++) {
+                size_t copy = loops[w].jmp - loops[w].head - (loops[w].sac < loops[w].jmp ? 2 : 1);
+                if (schedule->schedule_lengths[w] + factor * copy > max_instructions) fits = false;
+            }
+            if (!fits) break;
+            factor++;
+        }
+    }
+    free(loops);
+    free(increments);
+    return factor;
+}
@@ -0,0 +1,564 @@
+/**
+ * @file static_schedule_verify.c
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief A static verifier for the schedules of the FS scheduler.
+ *
+ * See static_schedule_verify.h.
+ */
+#include <limits.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "static_schedule_verify.h"
+
+/** What the rs1 operand of an opcode refers to. */
+typedef enum {
+    RS1_NONE,
+    RS1_REACTION,
+    RS1_REACTOR,
+    RS1_COUNTER,
+    RS1_REGISTER,
+    RS1_TARGET,
+} rs1_kind_t;
+
+static const rs1_kind_t rs1_kinds[] = {
+    [ADV]   = RS1_REACTOR,
+    [ADV2]  = RS1_REACTOR,
+    [BIT]   = RS1_TARGET,
+    [DU]    = RS1_NONE,
+    [EIT]   = RS1_REACTION,
+    [EXE]   = RS1_REACTION,
+    [INC]   = RS1_COUNTER,
+    [INC2]  = RS1_COUNTER,
+    [JMP]   = RS1_TARGET,
+    [SAC]   = RS1_NONE,
+    [STP]   = RS1_NONE,
+    [WU]    = RS1_COUNTER,
+    [ADDI]  = RS1_REGISTER,
+    [BEQ]   = RS1_TARGET,
+    [BNE]   = RS1_TARGET,
+    [BLT]   = RS1_TARGET,
+    [BNT]   = RS1_TARGET,
+    [SRV]   = RS1_NONE,
+    [BNM]   = RS1_TARGET,
+};
+
+#define NUM_OPCODES (sizeof(rs1_kinds) / sizeof(rs1_kinds[0]))
+
+/** The largest amount that INC and INC2 can add to a counter. */
+#define MAX_INCREMENT ((long long int)UINT32_MAX)
+
+typedef struct {
+    const static_schedule_t* schedule;
+    static_schedule_report_t report;
+    void* user_data;
+    int problems;
+} verifier_t;
+
+static void problem(verifier_t* v, size_t worker, size_t line, const char* format, ...) {
+    v->problems++;
+    if (v->report == NULL) return;
+    char message[256];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(message, sizeof(message), format, args);
+    va_end(args);
+    v->report(v->user_data, worker, line, message);
+}
+
+/**
+ * @brief Check that an operand plus the worker's base (see
+ * `static_schedule_reaction_index()`) indexes into a table and that the
+ * table entry indexes into the program's array.
+ */
+static void check_index(verifier_t* v, size_t worker, size_t line, const char* what,
+                        long long int operand, const size_t* bases, const uint32_t* table,
+                        size_t table_size, size_t array_size) {
+    long long int index = operand;
+    if (bases != NULL && bases[worker] > 0) {
+        if (operand > LLONG_MAX - (long long int)bases[worker]) {
+            problem(v, worker, line, "%s %lld is out of range with the worker's base %zu", what, operand, bases[worker]);
+            return;
+        }
+        index += (long long int)bases[worker];
+    }
+    if (table != NULL) {
+        if (index < 0 || (size_t)index >= table_size) {
+            problem(v, worker, line, "%s %lld is not in the %s table (size %zu)", what, index, what, table_size);
+            return;
+        }
+        index = table[index];
+    }
+    if (array_size > 0 && (index < 0 || (size_t)index >= array_size)) {
+        problem(v, worker, line, "%s %lld is out of range (the program has %zu)", what, index, array_size);
+    } else if (index < 0) {
+        problem(v, worker, line, "%s %lld is negative", what, index);
+    }
+}
+
+/**
+ * @brief Check that an operand names a register.
+ */
+static void check_register(verifier_t* v, size_t worker, size_t line, long long int index) {
+    if (index < 0 || index >= INST_NUM_REGISTERS) {
+        problem(v, worker, line, "register %lld is out of range (there are %d)", index, INST_NUM_REGISTERS);
+    }
+}
+
+/**
+ * @brief Check that the BNT or BNM at `line` only skips reactions, so that
+ * the path of the worker does the same whether it branches or not: EIT and
+ * BNT for a BNT, and also EXE and BNM for a BNM.
+ */
+static void check_skip(verifier_t* v, size_t worker, size_t line) {
+    const inst_t* schedule = v->schedule->schedules[worker];
+    const char* name = schedule[line].op == BNT ? "BNT" : "BNM";
+    long long int target = schedule[line].rs1;
+    if (target <= (long long int)line) {
+        problem(v, worker, line, "%s jumps backwards", name);
+        return;
+    }
+    for (size_t pc = line + 1; pc < (size_t)target; pc++) {
+        unsigned int op = schedule[pc].op;
+        if (op == EIT || op == BNT) continue;
+        if (schedule[line].op == BNM && (op == EXE || op == BNM)) continue;
+        if (schedule[line].op == BNT) {
+            problem(v, worker, line, "BNT skips line %zu, which is neither EIT nor BNT", pc);
+        } else {
+            problem(v, worker, line, "BNM skips line %zu, which is not EXE, EIT, BNT, or BNM", pc);
+        }
+        return;
+    }
+}
+
+/**
+ * @brief Check that every worker ends its loop with SAC and JMP if any
+ * schedule has a BNM, so that there is a point at the end of every
+ * hyperperiod where all workers wait and the modes can change.
+ */
+static void check_mode_boundaries(verifier_t* v) {
+    const static_schedule_t* s = v->schedule;
+    bool has_bnm = false;
+    for (size_t w = 0; w < s->num_workers && !has_bnm; w++) {
+        for (size_t pc = 0; pc < s->schedule_lengths[w] && !has_bnm; pc++) {
+            has_bnm = s->schedules[w][pc].op == BNM;
+        }
+    }
+    if (!has_bnm) return;
+    for (size_t w = 0; w < s->num_workers; w++) {
+        size_t end = static_schedule_loop_end(s->schedules[w], s->schedule_lengths[w]);
+        if (end == STATIC_SCHEDULE_NO_LOOP || end == 0 || s->schedules[w][end - 1].op != SAC) {
+            problem(v, w, end == STATIC_SCHEDULE_NO_LOOP ? STATIC_SCHEDULE_NO_LOCATION : end,
+                    "the schedules use BNM, but this worker does not end its loop with SAC and JMP");
+        }
+    }
+}
+
+/**
+ * @brief Check opcodes and operands. Returns false if any instruction is
+ * malformed, in which case the other checks are skipped.
+ */
+static bool check_operands(verifier_t* v, size_t num_reaction_instances, size_t num_reactor_instances) {
+    const static_schedule_t* s = v->schedule;
+    int before = v->problems;
+    for (size_t w = 0; w < s->num_workers; w++) {
+        size_t length = s->schedule_lengths[w];
+        for (size_t pc = 0; pc < length; pc++) {
+            const inst_t* inst = &s->schedules[w][pc];
+            if ((unsigned)inst->op >= NUM_OPCODES) {
+                problem(v, w, pc, "invalid opcode %d", (int)inst->op);
+                continue;
+            }
+            switch (rs1_kinds[inst->op]) {
+                case RS1_REACTION:
+                    check_index(v, w, pc, "reaction", inst->rs1, s->reaction_bases, s->reaction_table,
+                                s->num_reactions, num_reaction_instances);
+                    break;
+                case RS1_REACTOR:
+                    check_index(v, w, pc, "reactor", inst->rs1, s->reactor_bases, s->reactor_table,
+                                s->num_reactors, num_reactor_instances);
+                    break;
+                case RS1_COUNTER:
+                    if (inst->rs1 < 0 || (size_t)inst->rs1 >= s->num_counters) {
+                        problem(v, w, pc, "counter %lld is out of range (there are %zu)", inst->rs1, s->num_counters);
+                    }
+                    // Counters only grow, and a worker sleeping in WU watches
+                    // the low 32 bits of its counter, which an increment by a
+                    // multiple of 2^32 would leave unchanged.
+                    if (inst->op != WU && (inst->rs2 < 0 || inst->rs2 > MAX_INCREMENT)) {
+                        problem(v, w, pc, "increment %lld is out of range (0 to %lld)", inst->rs2, MAX_INCREMENT);
+                    }
+                    break;
+                case RS1_REGISTER:
+                    check_register(v, w, pc, inst->rs1);
+                    break;
+                case RS1_TARGET:
+                    if (inst->rs1 < 0 || (size_t)inst->rs1 >= length) {
+                        problem(v, w, pc, "jump target %lld is outside the schedule (length %zu)", inst->rs1, length);
+                    } else if (inst->op == BNT || inst->op == BNM) {
+                        check_skip(v, w, pc);
+                    }
+                    break;
+                case RS1_NONE:
+                    break;
+            }
+            if (inst->op == BEQ || inst->op == BNE || inst->op == BLT) {
+                check_register(v, w, pc, inst->rs2);
+            } else if (inst->op == BNT || inst->op == BNM) {
+                check_index(v, w, pc, "reaction", inst->rs2, s->reaction_bases, s->reaction_table,
+                            s->num_reactions, num_reaction_instances);
+            } else if (inst->op == SRV && inst->rs1 <= 0) {
+                problem(v, w, pc, "SRV budget %lld is not positive", inst->rs1);
+            }
+        }
+        if (length == 0) {
+            problem(v, w, STATIC_SCHEDULE_NO_LOCATION, "the schedule is empty");
+        }
+    }
+    return v->problems == before;
+}
+
+/**
+ * @brief Check that no counter incremented with INC2 has more than one
+ * writer.
+ */
+static void check_single_writers(verifier_t* v) {
+    const static_schedule_t* s = v->schedule;
+    // For each counter, a worker that writes it and whether that worker
+    // uses INC2.
+    size_t* writer = malloc(s->num_counters * sizeof(size_t));
+    bool* lock_free = calloc(s->num_counters, sizeof(bool));
+    bool* reported = calloc(s->num_counters, sizeof(bool));
+    if (s->num_counters > 0 && (writer == NULL || lock_free == NULL || reported == NULL)) {
+        problem(v, STATIC_SCHEDULE_NO_LOCATION, STATIC_SCHEDULE_NO_LOCATION, "out of memory");
+        goto done;
+    }
+    for (size_t c = 0; c < s->num_counters; c++) writer[c] = STATIC_SCHEDULE_NO_LOCATION;
+
+    // First pass: find one writer per counter and the counters with INC2.
+    for (size_t w = 0; w < s->num_workers; w++) {
+        for (size_t pc = 0; pc < s->schedule_lengths[w]; pc++) {
+            const inst_t* inst = &s->schedules[w][pc];
+            if (inst->op != INC && inst->op != INC2) continue;
+            if (inst->op == INC2) lock_free[inst->rs1] = true;
+            if (writer[inst->rs1] == STATIC_SCHEDULE_NO_LOCATION) writer[inst->rs1] = w;
+        }
+    }
+    // Second pass: report INC2 counters written by a second worker.
+    for (size_t w = 0; w < s->num_workers; w++) {
+        for (size_t pc = 0; pc < s->schedule_lengths[w]; pc++) {
+            const inst_t* inst = &s->schedules[w][pc];
+            if (inst->op != INC && inst->op != INC2) continue;
+            size_t c = inst->rs1;
+            if (lock_free[c] && writer[c] != w && !reported[c]) {
+                reported[c] = true;
+                problem(v, w, pc, "counter %zu is incremented with INC2 but also written by worker %zu", c, writer[c]);
+            }
+        }
+    }
+done:
+    free(writer);
+    free(lock_free);
+    free(reported);
+}
+
+/**
+ * @brief Check that no WU in a loop that does not end with SAC waits for a
+ * counter that two or more other workers increment in their loops.
+ *
+ * Without a SAC at the end of its loop, a worker can run epochs ahead of
+ * the others, and the increments of its next epoch can then make up for
+ * those that another worker has not made in this one yet. The epoch targets
+ * (see `static_schedule_counter_offsets()`) only tell the epochs apart if
+ * each WU depends on one other writer.
+ */
+static void check_epoch_writers(verifier_t* v) {
+    const static_schedule_t* s = v->schedule;
+    size_t n = s->num_workers;
+    // For each counter, up to three different workers that increment it in
+    // their loops, which is enough to tell whether two of them are not the
+    // worker of a given WU.
+    size_t (*writers)[3] = malloc(s->num_counters * sizeof(*writers));
+    size_t* num_writers = calloc(s->num_counters, sizeof(size_t));
+    size_t* loop_head = malloc(n * sizeof(size_t));
+    size_t* loop_end = malloc(n * sizeof(size_t));
+    if (loop_head == NULL || loop_end == NULL
+            || (s->num_counters > 0 && (writers == NULL || num_writers == NULL))) {
+        problem(v, STATIC_SCHEDULE_NO_LOCATION, STATIC_SCHEDULE_NO_LOCATION, "out of memory");
+        goto done;
+    }
+    for (size_t w = 0; w < n; w++) {
+        size_t end = static_schedule_loop_end(s->schedules[w], s->schedule_lengths[w]);
+        loop_head[w] = end == STATIC_SCHEDULE_NO_LOOP ? 0 : (size_t)s->schedules[w][end].rs1;
+        loop_end[w] = end == STATIC_SCHEDULE_NO_LOOP ? 0 : end;
+        for (size_t pc = loop_head[w]; pc < loop_end[w]; pc++) {
+            const inst_t* inst = &s->schedules[w][pc];
+            if (inst->op != INC && inst->op != INC2) continue;
+            size_t c = inst->rs1;
+            bool known = false;
+            for (size_t i = 0; i < num_writers[c]; i++) known |= writers[c][i] == w;
+            if (!known && num_writers[c] < 3) writers[c][num_writers[c]++] = w;
+        }
+    }
+    for (size_t w = 0; w < n; w++) {
+        if (loop_end[w] > 0 && s->schedules[w][loop_end[w] - 1].op == SAC) continue;
+        for (size_t pc = loop_head[w]; pc < loop_end[w]; pc++) {
+            const inst_t* inst = &s->schedules[w][pc];
+            if (inst->op != WU) continue;
+            size_t c = inst->rs1;
+            size_t others = num_writers[c];
+            for (size_t i = 0; i < num_writers[c]; i++) {
+                if (writers[c][i] == w) others--;
+            }
+            if (others >= 2) {
+                problem(v, w, pc, "WU waits for counter %zu, which several other workers increment in their loops; "
+                        "without SAC at the end of the loop, one of them may be in a later epoch", c);
+            }
+        }
+    }
+done:
+    free(writers);
+    free(num_writers);
+    free(loop_head);
+    free(loop_end);
+}
+
+/**
+ * @brief Count the SACs on the hyperperiod path of a worker. Returns false
+ * if the path runs past the end of the schedule or does not end.
+ */
+static bool count_sacs(verifier_t* v, size_t worker, size_t* count) {
+    const inst_t* schedule = v->schedule->schedules[worker];
+    size_t length = v->schedule->schedule_lengths[worker];
+    long long int registers[INST_NUM_REGISTERS] = { 0 };
+    size_t pc = 0;
+    *count = 0;
+    for (size_t steps = 0; steps < STATIC_SCHEDULE_MAX_STEPS; steps++) {
+        const inst_t* inst = &schedule[pc];
+        if (inst->op == STP || (inst->op == JMP && (size_t)inst->rs1 <= pc)) {
+            return true;
+        }
+        if (inst->op == SAC) (*count)++;
+        size_t next = static_schedule_step(inst, pc, registers);
+        if (next >= length) {
+            problem(v, worker, pc, "execution runs past the end of the schedule");
+            return false;
+        }
+        pc = next;
+    }
+    problem(v, worker, pc, "the hyperperiod does not end within %zu instructions", STATIC_SCHEDULE_MAX_STEPS);
+    return false;
+}
+
+/**
+ * @brief Check that every worker reaches SAC the same number of times per
+ * hyperperiod. Returns false if not, in which case the progress check is
+ * skipped.
+ */
+static bool check_sac_counts(verifier_t* v) {
+    const static_schedule_t* s = v->schedule;
+    int before = v->problems;
+    size_t first_count = 0;
+    for (size_t w = 0; w < s->num_workers; w++) {
+        size_t count;
+        if (!count_sacs(v, w, &count)) continue;
+        if (w == 0) {
+            first_count = count;
+        } else if (count != first_count) {
+            problem(v, w, STATIC_SCHEDULE_NO_LOCATION,
+                    "reaches SAC %zu time(s) per hyperperiod, but worker 0 reaches it %zu time(s)",
+                    count, first_count);
+        }
+    }
+    return v->problems == before;
+}
+
+typedef enum {
+    READY,
+    BLOCKED_ON_WU,
+    AT_SAC,
+    FINISHED,
+} worker_state_t;
+
+/**
+ * @brief Execute one hyperperiod of all workers abstractly and report
+ * workers that cannot make progress.
+ *
+ * Follows the same paths as `count_sacs()`, which must have succeeded.
+ */
+static void check_progress(verifier_t* v) {
+    const static_schedule_t* s = v->schedule;
+    size_t n = s->num_workers;
+    size_t* pc = calloc(n, sizeof(size_t));
+    worker_state_t* state = calloc(n, sizeof(worker_state_t));
+    size_t* ready = malloc(n * sizeof(size_t));             // Stack of ready workers.
+    size_t* next_waiter = malloc(n * sizeof(size_t));       // Linked lists of WU waiters.
+    size_t* first_waiter = malloc(s->num_counters * sizeof(size_t));
+    unsigned long long* counters = calloc(s->num_counters, sizeof(unsigned long long));
+    unsigned long long* base = malloc(s->num_counters * sizeof(unsigned long long));
+    unsigned long long* per_epoch = malloc(s->num_counters * sizeof(unsigned long long));
+    size_t* loop_head = malloc(n * sizeof(size_t));
+    // The registers of each worker, and what they were at its loop head.
+    long long int (*registers)[INST_NUM_REGISTERS] = calloc(n, sizeof(*registers));
+    long long int (*head_registers)[INST_NUM_REGISTERS] = calloc(n, sizeof(*head_registers));
+    bool* reached_head = calloc(n, sizeof(bool));
+    if (pc == NULL || state == NULL || ready == NULL || next_waiter == NULL || loop_head == NULL
+            || registers == NULL || head_registers == NULL || reached_head == NULL
+            || (s->num_counters > 0 && (first_waiter == NULL || counters == NULL
+                                        || base == NULL || per_epoch == NULL))) {
+        problem(v, STATIC_SCHEDULE_NO_LOCATION, STATIC_SCHEDULE_NO_LOCATION, "out of memory");
+        goto done;
+    }
+    for (size_t c = 0; c < s->num_counters; c++) first_waiter[c] = STATIC_SCHEDULE_NO_LOCATION;
+    // The hyperperiod is the first epoch, in which a WU in a loop waits for
+    // rs2 on top of what the INCs before the loops add.
+    static_schedule_counter_offsets(s, base, per_epoch);
+
+    size_t num_ready = 0;
+    for (size_t w = 0; w < n; w++) {
+        size_t end = static_schedule_loop_end(s->schedules[w], s->schedule_lengths[w]);
+        loop_head[w] = end == STATIC_SCHEDULE_NO_LOOP ? s->schedule_lengths[w] : (size_t)s->schedules[w][end].rs1;
+        ready[num_ready++] = w;
+    }
+
+    size_t num_at_sac = 0;
+    for (;;) {
+        while (num_ready > 0) {
+            size_t w = ready[--num_ready];
+            state[w] = READY;
+            // Run worker w until it blocks or finishes its hyperperiod.
+            while (state[w] == READY) {
+                const inst_t* inst = &s->schedules[w][pc[w]];
+                if (pc[w] == loop_head[w] && !reached_head[w]) {
+                    reached_head[w] = true;
+                    memcpy(head_registers[w], registers[w], sizeof(registers[w]));
+                }
+                switch (inst->op) {
+                    case INC:
+                    case INC2: {
+                        size_t c = inst->rs1;
+                        counters[c] += inst->rs2;
+                        // Let every waiter on the counter look again.
+                        for (size_t waiter = first_waiter[c]; waiter != STATIC_SCHEDULE_NO_LOCATION;
+                                waiter = next_waiter[waiter]) {
+                            ready[num_ready++] = waiter;
+                        }
+                        first_waiter[c] = STATIC_SCHEDULE_NO_LOCATION;
+                        pc[w]++;
+                        break;
+                    }
+                    case WU: {
+                        size_t c = inst->rs1;
+                        long long int target = inst->rs2 + (pc[w] >= loop_head[w] ? (long long int)base[c] : 0);
+                        if (target > 0 && counters[c] < (unsigned long long)target) {
+                            state[w] = BLOCKED_ON_WU;
+                            next_waiter[w] = first_waiter[c];
+                            first_waiter[c] = w;
+                        } else {
+                            pc[w]++;
+                        }
+                        break;
+                    }
+                    case SAC:
+                        state[w] = AT_SAC;
+                        num_at_sac++;
+                        pc[w]++;
+                        break;
+                    case JMP:
+                        if ((size_t)inst->rs1 <= pc[w]) {
+                            state[w] = FINISHED;
+                            if ((size_t)inst->rs1 != loop_head[w] || !reached_head[w]) break;
+                            // The next epoch has to take the same path.
+                            for (int r = 0; r < INST_NUM_REGISTERS; r++) {
+                                if (registers[w][r] != head_registers[w][r]) {
+                                    problem(v, w, pc[w], "register %d is %lld at the end of the loop but %lld at "
+                                            "its start, so later epochs would take other paths",
+                                            r, registers[w][r], head_registers[w][r]);
+                                }
+                            }
+                        } else {
+                            pc[w] = inst->rs1;
+                        }
+                        break;
+                    case STP:
+                        state[w] = FINISHED;
+                        break;
+                    default:
+                        // BIT, BNT, and BNM are assumed not to be taken. The
+                        // other instructions do not affect progress.
+                        pc[w] = static_schedule_step(inst, pc[w], registers[w]);
+                        break;
+                }
+            }
+        }
+
+        // Nobody can run. If everyone is at SAC, SAC releases them. It no
+        // longer clears the counters.
+        if (num_at_sac == n) {
+            for (size_t w = 0; w < n; w++) ready[num_ready++] = w;
+            num_at_sac = 0;
+            continue;
+        }
+        break;
+    }
+
+    // Anyone still blocked on a WU will never make progress. Workers at SAC
+    // are then only waiting for them.
+    for (size_t w = 0; w < n; w++) {
+        if (state[w] == BLOCKED_ON_WU) {
+            const inst_t* inst = &s->schedules[w][pc[w]];
+            long long int target = inst->rs2 + (pc[w] >= loop_head[w] ? (long long int)base[inst->rs1] : 0);
+            problem(v, w, pc[w], "WU waits for counter %lld to reach %lld, but it only reaches %llu; the workers deadlock",
+                    inst->rs1, target, counters[inst->rs1]);
+        }
+    }
+
+done:
+    free(registers);
+    free(head_registers);
+    free(reached_head);
+    free(pc);
+    free(state);
+    free(ready);
+    free(next_waiter);
+    free(first_waiter);
+    free(counters);
+    free(base);
+    free(per_epoch);
+    free(loop_head);
+}
+
+int static_schedule_verify(const static_schedule_t* schedule,
+                           size_t num_reaction_instances,
+                           size_t num_reactor_instances,
+                           static_schedule_report_t report,
+                           void* user_data) {
+    verifier_t v = {
+        .schedule = schedule,
+        .report = report,
+        .user_data = user_data,
+        .problems = 0,
+    };
+    if (check_operands(&v, num_reaction_instances, num_reactor_instances)) {
+        check_single_writers(&v);
+        check_epoch_writers(&v);
+        check_mode_boundaries(&v);
+        if (check_sac_counts(&v)) check_progress(&v);
+    }
+    return v.problems;
+}
+
+void static_schedule_print_problem(void* user_data, size_t worker, size_t line, const char* message) {
+    const char* path = user_data;
+    if (worker == STATIC_SCHEDULE_NO_LOCATION) {
+        fprintf(stderr, "%s: %s.\n", path, message);
+    } else if (line == STATIC_SCHEDULE_NO_LOCATION) {
+        fprintf(stderr, "%s: worker %zu: %s.\n", path, worker, message);
+    } else {
+        fprintf(stderr, "%s: worker %zu, line %zu: %s.\n", path, worker, line, message);
+    }
+}
@@ -0,0 +1,155 @@
+/**
+ * @file worker_placement.c
+ * @brief Placing the worker threads on CPUs, at a real-time priority, and
+ * with locked memory.
+ *
+ * See worker_placement.h.
+ */
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "platform.h"
+#include "util.h"
+#include "worker_placement.h"
+
+/** The CPU of each worker, `_lf_worker_num_cpus` long. */
+static int* _lf_worker_cpus = NULL;
+static size_t _lf_worker_num_cpus = 0;
+
+/** Whether the CPUs were given with `lf_worker_set_cpus()`. */
+static bool _lf_worker_cpus_given = false;
+
+/** The real-time FIFO priority, or 0. */
+static int _lf_worker_priority = 0;
+
+/** Whether to lock memory, and whether it was locked. */
+static bool _lf_worker_lock_memory = false;
+static bool _lf_worker_memory_locked = false;
+
+/**
+ * @brief Make room for the CPU of `worker_number`. New entries are
+ * `LF_WORKER_NO_CPU`.
+ */
+static void _lf_worker_reserve_cpus(size_t worker_number) {
+    if (worker_number < _lf_worker_num_cpus) return;
+    int* cpus = realloc(_lf_worker_cpus, (worker_number + 1) * sizeof(int));
+    if (cpus == NULL) {
+        lf_print_error_and_exit("Out of memory.");
+    }
+    for (size_t i = _lf_worker_num_cpus; i <= worker_number; i++) {
+        cpus[i] = LF_WORKER_NO_CPU;
+    }
+    _lf_worker_cpus = cpus;
+    _lf_worker_num_cpus = worker_number + 1;
+}
+
+int lf_worker_set_cpus(const char* list) {
+    size_t worker_number = 0;
+    const char* p = list;
+    do {
+        char* end;
+        long cpu = strtol(p, &end, 10);
+        if (end == p || cpu < 0 || cpu > 0xFFFF || (*end != ',' && *end != '\0')) {
+            return -1;
+        }
+        _lf_worker_reserve_cpus(worker_number);
+        _lf_worker_cpus[worker_number++] = (int)cpu;
+        p = *end == ',' ? end + 1 : end;
+    } while (*p != '\0');
+    _lf_worker_cpus_given = true;
+    return 0;
+}
+
+void lf_worker_set_default_cpu(size_t worker_number, int cpu) {
+    if (_lf_worker_cpus_given) return;
+    _lf_worker_reserve_cpus(worker_number);
+    _lf_worker_cpus[worker_number] = cpu;
+}
+
+void lf_worker_set_priority(int priority) {
+    _lf_worker_priority = priority;
+}
+
+void lf_worker_set_lock_memory(bool lock) {
+    _lf_worker_lock_memory = lock;
+}
+
+/**
+ * @brief Why a request was not granted, beyond the error itself, or "".
+ */
+static const char* _lf_worker_hint(int error) {
+    switch (error) {
+        case ENOTSUP:
+            return " (not supported on this platform)";
+        case EPERM:
+            return " (not permitted; needs privileges that unprivileged containers usually lack)";
+        default:
+            return "";
+    }
+}
+
+void lf_worker_placement_init(size_t num_workers) {
+    if (_lf_worker_num_cpus > num_workers && _lf_worker_cpus_given) {
+        lf_print_warning("%zu CPUs are given for %zu workers. The extra CPUs are not used.",
+                         _lf_worker_num_cpus, num_workers);
+    }
+    size_t limit = _lf_worker_num_cpus < num_workers ? _lf_worker_num_cpus : num_workers;
+    for (size_t i = 0; i < limit; i++) {
+        for (size_t j = 0; j < i; j++) {
+            if (_lf_worker_cpus[i] != LF_WORKER_NO_CPU && _lf_worker_cpus[i] == _lf_worker_cpus[j]) {
+                lf_print_warning("Workers %zu and %zu are both pinned to CPU %d and will preempt each other.",
+                                 j, i, _lf_worker_cpus[i]);
+            }
+        }
+    }
+    if (_lf_worker_lock_memory && !_lf_worker_memory_locked) {
+        int error = lf_lock_memory();
+        if (error != 0) {
+            lf_print_warning("Cannot lock the memory of the program: %s%s. "
+                             "Page faults may delay the workers.",
+                             strerror(error), error == ENOMEM || error == EPERM
+                                 ? " (the locked-memory limit, ulimit -l, is too low)" : _lf_worker_hint(error));
+        } else {
+            _lf_worker_memory_locked = true;
+            LF_PRINT_LOG("Locked the memory of the program.");
+        }
+    }
+}
+
+void lf_worker_place(size_t worker_number) {
+    int cpu = worker_number < _lf_worker_num_cpus ? _lf_worker_cpus[worker_number] : LF_WORKER_NO_CPU;
+    if (cpu != LF_WORKER_NO_CPU) {
+        int error = lf_thread_set_cpu(cpu);
+        if (error != 0) {
+            lf_print_warning("Cannot pin worker %zu to CPU %d: %s%s. The OS may migrate it.",
+                             worker_number, cpu, strerror(error), error == EINVAL
+                                 ? " (the CPU is not among those this process may run on)" : _lf_worker_hint(error));
+        } else {
+            LF_PRINT_LOG("Pinned worker %zu to CPU %d.", worker_number, cpu);
+        }
+    }
+    if (_lf_worker_priority != 0) {
+        int error = lf_thread_set_fifo_priority(_lf_worker_priority);
+        if (error != 0) {
+            lf_print_warning("Cannot run worker %zu with the real-time FIFO policy at priority %d: %s%s. "
+                             "Other threads may preempt it.",
+                             worker_number, _lf_worker_priority, strerror(error),
+                             error == EPERM ? " (needs CAP_SYS_NICE or a real-time priority limit, ulimit -r, that high)"
+                             : error == EINVAL ? " (the priority is out of range)"
+                             : _lf_worker_hint(error));
+        } else {
+            LF_PRINT_LOG("Worker %zu runs with the real-time FIFO policy at priority %d.",
+                         worker_number, _lf_worker_priority);
+        }
+    }
+    if (_lf_worker_memory_locked) {
+        // With the memory locked, touching the stack faults its pages in now
+        // rather than in the middle of a reaction. Writes through volatile are
+        // not optimized away.
+        volatile unsigned char stack[LF_WORKER_STACK_PREFAULT];
+        for (size_t i = 0; i < sizeof(stack); i += 1024) {
+            stack[i] = 0;
+        }
+    }
+}
@@ -70,6 +70,10 @@ typedef unsigned short int ushort;
 #define PEDF_NP 6
 #define FS 7
 
+#if SCHEDULER == FS
+#include <stdatomic.h>
+#endif
+
 /**
  * Policy for handling scheduled events that violate the specified
  * minimum interarrival time.
@@ -284,7 +288,11 @@ typedef struct self_base_t {
     reactor_mode_state_t _lf__mode_state;    // The current mode (for modal models).
 #endif
 #if SCHEDULER == FS
-    tag_t tag;                               // The current tag of the reactor instance.
+    // The time of the current tag of the reactor instance. The FS scheduler
+    // only advances reactors to microstep 0, so the time is the whole tag and
+    // can be published with a single atomic write.
+    _Atomic instant_t tag_time;
+    _Atomic bool reached_stop_tag;           // Whether the tag has gone past the stop tag.
 #endif
 } self_base_t;
 
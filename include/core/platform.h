@@ -134,6 +134,32 @@ extern int lf_notify_of_event();
  */
 extern int lf_available_cores();
 
+/**
+ * Pin the calling thread to a CPU.
+ *
+ * @return 0 on success, ENOTSUP if the platform cannot pin threads, or a
+ *  platform-specific error number otherwise.
+ */
+extern int lf_thread_set_cpu(int cpu_number);
+
+/**
+ * Run the calling thread with the real-time FIFO scheduling policy at a
+ * priority.
+ *
+ * @return 0 on success, ENOTSUP if the platform has no such policy, or a
+ *  platform-specific error number otherwise.
+ */
+extern int lf_thread_set_fifo_priority(int priority);
+
+/**
+ * Lock the memory of the program into RAM, both what is mapped now and what
+ * is mapped later.
+ *
+ * @return 0 on success, ENOTSUP if the platform cannot lock memory, or a
+ *  platform-specific error number otherwise.
+ */
+extern int lf_lock_memory();
+
 /**
  * Create a new thread, starting with execution of lf_thread
  * getting passed arguments. The new handle is stored in thread_id.
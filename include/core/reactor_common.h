@@ -18,6 +18,10 @@ extern instant_t duration;
 extern bool _lf_execution_started;
 extern tag_t stop_tag;
 extern bool keepalive_specified;
+#if SCHEDULER == FS
+extern const char* static_schedule_file;
+extern size_t static_schedule_unroll_factor;
+#endif
 extern bool** _lf_is_present_fields;
 extern interval_t _lf_fed_STA_offset;
 extern int _lf_is_present_fields_size;
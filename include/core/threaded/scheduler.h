@@ -49,6 +49,14 @@ THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #define DEFAULT_MAX_REACTION_LEVEL 100
 
+/**
+ * @brief The largest number of reactions that a worker asks for at once with
+ * `lf_sched_get_ready_reactions()`.
+ */
+#ifndef LF_SCHED_MAX_RUN_LIST
+#define LF_SCHED_MAX_RUN_LIST 8
+#endif
+
 /**
  * @brief Struct representing the most common scheduler parameters.
  *
@@ -69,8 +77,8 @@ typedef struct {
     size_t num_reactions_per_level_size;
     struct self_base_t** reactor_self_instances;
     size_t num_reactor_self_instances;
-    bool* reactor_reached_stop_tag;
     reaction_t** reaction_instances;
+    size_t num_reaction_instances;
     instant_t hyperperiod_duration;
 } sched_params_t;
 
@@ -120,6 +128,36 @@ reaction_t* lf_sched_get_ready_reaction(int worker_number);
  */
 void lf_sched_done_with_reaction(size_t worker_number, reaction_t* done_reaction);
 
+/**
+ * @brief Ask the scheduler for a run-list of reactions that the worker can
+ * execute back-to-back, in order.
+ *
+ * Like `lf_sched_get_ready_reaction()`, this blocks until at least one
+ * reaction is ready or it is time for the worker thread to stop and exit. A
+ * scheduler only puts reactions into the same run-list if executing them in
+ * order, and reporting them done only after the last one, is the same as
+ * asking for them one at a time. A scheduler that cannot tell may always
+ * return a single reaction.
+ *
+ * @param worker_number For the calling worker thread.
+ * @param run_list Filled in with the reactions.
+ * @param capacity The length of `run_list`. At least 1.
+ * @return The number of reactions in `run_list`. 0 if the calling worker
+ * thread should exit.
+ */
+size_t lf_sched_get_ready_reactions(int worker_number, reaction_t** run_list, size_t capacity);
+
+/**
+ * @brief Inform the scheduler that worker thread 'worker_number' is done
+ * executing all reactions of a run-list returned by
+ * `lf_sched_get_ready_reactions()`.
+ *
+ * @param worker_number The worker number for the worker thread that has
+ * finished executing the run-list.
+ * @param run_list The reactions that are done.
+ * @param count The number of reactions in `run_list`.
+ */
+void lf_sched_done_with_reactions(size_t worker_number, reaction_t** run_list, size_t count);
 
 /**
  * @brief Inform the scheduler that worker thread 'worker_number' would like to
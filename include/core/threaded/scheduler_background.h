@@ -0,0 +1,82 @@
+/**
+ * @file scheduler_background.h
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief Best-effort work that the FS scheduler runs in the slack of its
+ * static schedules.
+ *
+ * Jobs without a real-time constraint, such as logging, compaction, or
+ * telemetry, can be submitted from any thread to a bounded lock-free queue.
+ * A worker that reaches a DU early runs jobs from the queue before it goes
+ * to sleep, as long as each job is expected to finish `FS_BACKGROUND_GUARD_NS`
+ * before the release time of the DU. How long a job takes is what its
+ * submitter declares; a job that takes longer than declared eats into the
+ * guard band first and delays the release only beyond it. Jobs run in the
+ * order they are submitted: a worker never skips a job that does not fit in
+ * its slack, so that a long job is not starved by short ones.
+ *
+ * WU slack is not used, since how long a worker waits on a counter is not
+ * known in advance.
+ */
+#ifndef SCHEDULER_BACKGROUND_H
+#define SCHEDULER_BACKGROUND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "tag.h"
+
+#ifndef FS_BACKGROUND_QUEUE_SIZE
+/**
+ * @brief How many jobs the background queue holds. Must be a power of 2.
+ */
+#define FS_BACKGROUND_QUEUE_SIZE 1024
+#endif
+
+#ifndef FS_BACKGROUND_GUARD_NS
+/**
+ * @brief How long before a DU release time a background job must be expected
+ * to finish in order to be started.
+ */
+#define FS_BACKGROUND_GUARD_NS 50000
+#endif
+
+/**
+ * @brief A background job.
+ *
+ * @param arg The argument the job was submitted with.
+ */
+typedef void (*lf_sched_background_job_t)(void* arg);
+
+/**
+ * @brief The background work one worker has done.
+ */
+typedef struct {
+    size_t      jobs;           // Jobs run.
+    interval_t  time;           // Slack reclaimed, i.e., time spent running jobs.
+    interval_t  overrun;        // Time jobs took beyond what they declared.
+} lf_sched_background_stats_t;
+
+/**
+ * @brief Submit a job to the background queue. Can be called from any thread,
+ * including from reactions and from background jobs.
+ *
+ * @param job The function to run.
+ * @param arg The argument to pass to `job`.
+ * @param cost How long the job is expected to take, at most. A job is only
+ *  started in slack at least `cost + FS_BACKGROUND_GUARD_NS` long.
+ * @return 0 on success, or -1 if `job` is NULL, `cost` is negative, or the
+ *  queue is full.
+ */
+int lf_sched_submit_background(lf_sched_background_job_t job, void* arg, interval_t cost);
+
+/**
+ * @brief Get the background work a worker has done so far.
+ *
+ * The stats are written by the worker without synchronization, so they are
+ * only exact once the workers have stopped.
+ *
+ * @return false if there is no such worker.
+ */
+bool lf_sched_background_stats(size_t worker_number, lf_sched_background_stats_t* stats);
+
+#endif // SCHEDULER_BACKGROUND_H
@@ -0,0 +1,115 @@
+/**
+ * @file scheduler_compiled.h
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief The interface between the FS scheduler and static schedules that
+ * have been compiled to C ahead of time.
+ *
+ * `tools/fs_schedule_compile` turns a set of static schedules into one C
+ * function per worker, in which every instruction becomes a call to the
+ * runtime functions below (or, for EIT, a check of the reaction status) and
+ * a JMP backwards becomes a loop. A program built with the CMake option
+ * `FS_COMPILED` links such a file and runs its functions instead of
+ * interpreting the schedules: each worker calls its function once, which
+ * executes all of the worker's reactions and returns when the schedule
+ * reaches STP.
+ *
+ * The compiled-in or `--schedule` schedules are still loaded and verified.
+ * Their fingerprint (see `static_schedule_fingerprint()`) must match the one
+ * the compiled code was generated from, so that stale generated code is
+ * caught at startup rather than running a different schedule.
+ *
+ * The build enables link-time optimization where the compiler supports it,
+ * so that the calls below can be inlined into the generated functions.
+ */
+#ifndef SCHEDULER_COMPILED_H
+#define SCHEDULER_COMPILED_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lf_types.h"
+
+/**
+ * @brief The compiled schedule of one worker.
+ *
+ * @param worker_number The worker that runs the schedule.
+ * @param reactions The reaction instances of the program.
+ * @param reactors The reactor self instances of the program.
+ */
+typedef void (*lf_sched_compiled_worker_t)(size_t worker_number,
+                                           reaction_t* const* reactions,
+                                           self_base_t* const* reactors);
+
+///////////////////// Provided by the generated code /////////////////////////
+
+/** The number of workers the schedules were compiled for. */
+extern const size_t lf_sched_compiled_num_workers;
+
+/** The fingerprint of the schedules the code was generated from. */
+extern const uint32_t lf_sched_compiled_fingerprint;
+
+/** The compiled schedule of each worker. */
+extern const lf_sched_compiled_worker_t lf_sched_compiled_workers[];
+
+///////////////////// Provided by the FS scheduler /////////////////////////
+
+/**
+ * @brief EXE, and EIT if the reaction is queued: run a reaction on the
+ * worker, as `_lf_worker_do_work()` would.
+ */
+void lf_sched_compiled_execute(size_t worker_number, reaction_t* reaction);
+
+/**
+ * @brief INC and INC2: increment a counter by an amount.
+ */
+void lf_sched_compiled_increment(size_t counter, long long int amount, bool single_writer);
+
+/**
+ * @brief WU: wait until a counter reaches a value in the worker's epoch.
+ *
+ * @return false if the worker has to leave its loop instead, as the BIT at
+ *  its start would (see `lf_sched_compiled_timeout_reached()`).
+ */
+bool lf_sched_compiled_wait_until(size_t worker_number, size_t counter, long long int value);
+
+/**
+ * @brief ADV and ADV2: advance the tag of a reactor by an amount.
+ */
+void lf_sched_compiled_advance(self_base_t* reactor, interval_t amount, bool single_writer);
+
+/**
+ * @brief BIT: whether every reactor has reached the stop tag, or another
+ * worker has stopped in the worker's epoch.
+ */
+bool lf_sched_compiled_timeout_reached(size_t worker_number);
+
+/**
+ * @brief The JMP that closes the loop of a worker: start a new epoch.
+ */
+void lf_sched_compiled_end_epoch(size_t worker_number);
+
+/**
+ * @brief DU: delay until the release time of a hyperperiod iteration.
+ */
+void lf_sched_compiled_delay_until(size_t worker_number, long long int rs1, long long int rs2, int iteration);
+
+/**
+ * @brief SAC: synchronize with the other workers.
+ *
+ * @param boundary Whether this is the SAC right before the JMP that closes
+ *  the loop, where the modes change.
+ */
+void lf_sched_compiled_sync_and_clear(size_t worker_number, bool boundary);
+
+/**
+ * @brief BNM: whether the mode of a reaction is active.
+ */
+bool lf_sched_compiled_mode_is_active(reaction_t* reaction);
+
+/**
+ * @brief SRV: run triggered sporadic reactions for up to `budget` ns.
+ */
+void lf_sched_compiled_serve(size_t worker_number, interval_t budget);
+
+#endif // SCHEDULER_COMPILED_H
@@ -46,11 +46,229 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "scheduler.h"
 
 #if SCHEDULER == FS
+#include <stdatomic.h>
+
+#include "scheduler_background.h"
 #include "scheduler_instructions.h"
+#include "static_schedule_file.h"
 #endif
 
 extern lf_mutex_t mutex;
 
+#if SCHEDULER == FS
+/**
+ * @brief The alignment of the programs that the workers execute.
+ */
+#define LF_SCHED_CACHE_LINE_SIZE 64
+
+/**
+ * @brief The alignment of the counters used by INC, INC2, and WU.
+ *
+ * By default, every counter has a cache line to itself so that workers that
+ * update different counters do not slow each other down through false
+ * sharing. Define it as 8 to pack the counters into lines instead, e.g.,
+ * to measure the difference (see `scripts/bench_counters.sh`).
+ */
+#ifndef FS_COUNTER_ALIGNMENT
+#define FS_COUNTER_ALIGNMENT LF_SCHED_CACHE_LINE_SIZE
+#endif
+
+/**
+ * @brief A counter used by INC, INC2, and WU.
+ *
+ * See scheduler_instructions.h for the memory ordering that the counters
+ * provide. Counters only grow and are never cleared; a WU waits for its
+ * value on top of `per_epoch` times the epoch of its worker (see
+ * `static_schedule_counter_offsets()`).
+ */
+typedef struct {
+    _Alignas(FS_COUNTER_ALIGNMENT) _Atomic uint64_t value;
+    _Atomic uint32_t waiters;   // Workers sleeping in WU on this counter.
+    uint64_t per_epoch;         // What all workers add per epoch. Read-only.
+} lf_sched_counter_t;
+
+/**
+ * @brief How many workers, or nodes, arrive at a node of the SAC barrier.
+ */
+#ifndef LF_SCHED_BARRIER_FANIN
+#define LF_SCHED_BARRIER_FANIN 4
+#endif
+
+/** The parent of the root node of the SAC barrier. */
+#define LF_SCHED_BARRIER_ROOT SIZE_MAX
+
+/**
+ * @brief A node of the combining tree that SAC synchronizes the workers with.
+ */
+typedef struct {
+    _Alignas(LF_SCHED_CACHE_LINE_SIZE) _Atomic uint32_t arrived;   // Children that have arrived.
+    uint32_t expected;          // Number of children.
+    size_t parent;              // Index of the parent, or LF_SCHED_BARRIER_ROOT.
+} lf_sched_barrier_node_t;
+
+/**
+ * @brief An instruction of a static schedule after it has been loaded by
+ * `lf_sched_init()`.
+ *
+ * Operands that index into the reaction, reactor, and counter arrays are
+ * resolved to pointers so that executing an instruction needs no lookup
+ * through the scheduler instance. Jump targets stay indices into the
+ * worker's program so that the program can be relocated. BNT and BNM swap
+ * their operands, so that the reaction, or its mode, can be a pointer and
+ * the target fits rs2. The opcode is
+ * packed next to rs2, which keeps an instruction at 16 bytes (four per cache
+ * line) instead of the 24 bytes of `inst_t`.
+ */
+typedef struct decoded_inst_t {
+    union {
+        reaction_t*         reaction;   // EIT, EXE, BNT
+        reactor_mode_t*     mode;       // BNM
+        self_base_t*        reactor;    // ADV, ADV2
+        lf_sched_counter_t* counter;    // INC, INC2, WU
+        size_t              target;     // BIT, JMP, BEQ, BNE, BLT
+        long long int       value;      // DU, ADDI, and any other opcode
+    } rs1;
+    long long int   rs2 : 56;
+    unsigned int    op  : 8;
+} decoded_inst_t;
+
+_Static_assert(sizeof(decoded_inst_t) == 16, "A decoded instruction should take 16 bytes.");
+
+#define DECODED_INST_RS2_MAX ((1LL << 55) - 1)
+#define DECODED_INST_RS2_MIN (-(1LL << 55))
+
+#ifdef FS_WAIT_STATS
+/**
+ * @brief How long one worker has waited on one counter in WU.
+ *
+ * Only WUs that find the counter below its value are counted.
+ */
+typedef struct {
+    size_t      waits;          // WUs that had to wait.
+    size_t      sleeps;         // Times the worker went to sleep in those WUs.
+    interval_t  spin_time;      // Time spent spinning.
+    interval_t  sleep_time;     // Time spent sleeping.
+} lf_sched_wait_stats_t;
+#endif
+
+#ifdef FS_RELEASE_STATS
+/**
+ * @brief The number of buckets of a lateness histogram. Bucket 0 counts
+ * releases on time, bucket i releases late by [2^(i-1), 2^i) ns, and the last
+ * bucket everything later.
+ */
+#define LF_SCHED_LATENESS_BUCKETS 32
+
+/**
+ * @brief How late one worker has been released by DU.
+ *
+ * Kept in the worker's context (see `lf_sched_worker_context_t`), so that
+ * recording does not slow down the other workers.
+ */
+typedef struct {
+    size_t      releases;
+    interval_t  total;          // Sum of the lateness of all releases.
+    interval_t  max;
+    size_t      buckets[LF_SCHED_LATENESS_BUCKETS];
+} lf_sched_lateness_stats_t;
+#endif
+
+#ifdef FS_PROFILE
+/**
+ * @brief What the profiler has measured for one instruction of one worker.
+ *
+ * Times are in profiler ticks (see `_lf_sched_profile_ticks()`).
+ */
+typedef struct {
+    uint64_t    count;          // Executions.
+    uint64_t    ticks;          // Time in the instruction, e.g., waiting in WU, DU, or SAC.
+    uint64_t    reaction_ticks; // EXE, EIT: time in the reactions they returned.
+    interval_t  lateness;       // DU: total lateness of the releases, in ns.
+    interval_t  max_lateness;   // DU: in ns.
+} lf_sched_line_profile_t;
+
+/**
+ * @brief The profile of one worker.
+ *
+ * Only the worker writes its profile, so the profile is kept in the worker's
+ * context (see `lf_sched_worker_context_t`) and needs no atomics.
+ */
+typedef struct {
+    lf_sched_line_profile_t* lines;   // One per instruction.
+    size_t      returned_pc;    // The instruction that returned the reaction being executed, or SIZE_MAX.
+    uint64_t    returned_at;    // When it was returned.
+    uint64_t    reaction_ticks; // Spent in reactions run by the current superinstruction.
+} lf_sched_worker_profile_t;
+#endif
+
+/**
+ * @brief The alignment of the execution contexts of the workers.
+ *
+ * By default, a context starts on a pair of cache lines of its own, since
+ * x86 processors prefetch adjacent lines in pairs, so that the pc and
+ * iteration that a worker writes all the time never share a line with those
+ * of another worker. Define it as 8 to pack the contexts into one array, as
+ * the pcs used to be, e.g., to measure the difference (see
+ * `scripts/bench_context.sh`).
+ */
+#ifndef FS_CONTEXT_ALIGNMENT
+#define FS_CONTEXT_ALIGNMENT (2 * LF_SCHED_CACHE_LINE_SIZE)
+#endif
+
+/**
+ * @brief The execution context of one worker: the state of its VM and
+ * everything else it reads on every instruction.
+ *
+ * Only the worker writes its context. `lf_sched_init()` fills the contexts
+ * in, and each worker then moves its context into memory it allocates itself
+ * when it first asks for work, so that on systems with a first-touch page
+ * placement policy the context ends up in the memory of the node that the
+ * worker runs on (see `_lf_sched_load_context()`).
+ */
+typedef struct {
+    _Alignas(FS_CONTEXT_ALIGNMENT) size_t pc;
+    size_t      epoch;          // The number of times the worker has closed its loop.
+    int         iteration;      // The hyperperiod iteration, for DU.
+    bool        loaded;         // Whether the worker has moved the context into its own memory.
+    decoded_inst_t* program;    // The decoded program, or NULL until loaded.
+    size_t      loop_end;       // The JMP that closes the loop, or STATIC_SCHEDULE_NO_LOOP.
+    size_t      loop_exit;      // The target of the BIT at the loop head, i.e., where the worker
+                                // goes when it stops, or SIZE_MAX if the loop has no BIT.
+    long long int registers[INST_NUM_REGISTERS];   // For ADDI and the register branches.
+    size_t      swaps;          // The schedule swaps the worker has adopted (see scheduler_swap.h).
+    lf_sched_background_stats_t background_stats;   // See scheduler_background.h.
+#ifdef FS_RELEASE_STATS
+    lf_sched_lateness_stats_t release_stats;
+#endif
+#ifdef FS_PROFILE
+    lf_sched_worker_profile_t profile;
+#endif
+} lf_sched_worker_context_t;
+
+/**
+ * @brief A schedule set staged by `lf_sched_stage_schedule()` for the
+ * workers to switch to at the end of a hyperperiod.
+ *
+ * Everything is loaded, verified, and decoded when the set is staged, so
+ * that the worker that completes the SAC at the end of the hyperperiod only
+ * swaps pointers with the scheduler instance. After the swap, the struct
+ * holds what the workers ran before, until it is freed outside the barrier.
+ */
+typedef struct lf_sched_staged_schedule_t {
+    static_schedule_t* file;            // The mapped schedule file.
+    static_schedule_t* unrolled;        // Its schedules unrolled with `--unroll`, or NULL.
+    size_t*     lengths;                // The length of each worker's schedule.
+    decoded_inst_t** programs;          // The decoded program of each worker.
+    lf_sched_counter_t* counters;       // Set to where the loops of the workers start.
+    size_t      num_counters;
+    interval_t  hyperperiod;            // The period of the DUs, or 0 if there are none.
+#ifdef FS_WAIT_STATS
+    lf_sched_wait_stats_t* wait_stats;
+#endif
+    struct lf_sched_staged_schedule_t* next;    // In `retired_schedules`.
+} lf_sched_staged_schedule_t;
+#endif
+
 
 /**
  * @brief Paramters used in schedulers of the threaded reactor C runtime.
@@ -140,10 +358,20 @@ typedef struct {
 #if SCHEDULER == FS
 
     /**
-     * @brief Points to an array of program counters for each worker.
+     * @brief Points to an array of pointers to the execution contexts of the
+     * workers.
+     *
+     * A worker's entry points into `staged_contexts` until the worker moves
+     * its context into memory of its own.
+     */
+    lf_sched_worker_context_t** contexts;
+
+    /**
+     * @brief Points to the execution contexts as filled in by
+     * `lf_sched_init()`, one for each worker.
      * 
      */
-    size_t* pc;
+    lf_sched_worker_context_t* staged_contexts;
 
     /**
      * @brief Points to a read-only array of static schedules.
@@ -164,11 +392,12 @@ typedef struct {
     size_t num_reactor_self_instances;
 
     /**
-     * @brief Points to an array of bools indicating whether
-     * a reactor reaches stop.
-     * 
+     * @brief The number of reactors that have not gone past the stop tag yet.
+     *
+     * ADV and ADV2 decrement it when a reactor first goes past the stop tag,
+     * so BIT only has to check it for zero.
      */
-    bool* reactor_reached_stop_tag;
+    _Atomic size_t reactors_remaining;
 
     /**
      * @brief Points to an array of pointers to reaction instances.
@@ -177,10 +406,175 @@ typedef struct {
     reaction_t** reaction_instances;
 
     /**
-     * @brief Points to an array of integer counters.
+     * @brief The total number of reaction instances.
      * 
      */
-    volatile uint32_t* counters;
+    size_t num_reaction_instances;
+
+    /**
+     * @brief If any schedule has an SRV, points to the sporadic reactions,
+     * i.e., those that no schedule names, sorted by address; NULL otherwise.
+     * Triggering one of them inserts it into `_lf_sched_triggered_reactions`
+     * under `_lf_sched_array_of_mutexes[0]`, for SRV to run.
+     *
+     */
+    reaction_t** sporadic_reactions;
+
+    /**
+     * @brief The number of sporadic reactions.
+     *
+     */
+    size_t num_sporadic_reactions;
+
+    /**
+     * @brief The number of sporadic reactions in the queue, so that SRV need
+     * not take the lock when there are none.
+     *
+     */
+    _Atomic size_t sporadic_pending;
+
+    /**
+     * @brief Points to an array of decoded programs, one for each worker,
+     * as produced by `lf_sched_init()`. A worker's entry is NULL once the
+     * worker has moved its program into its context.
+     * 
+     */
+    decoded_inst_t** staged_programs;
+
+    /**
+     * @brief Points to an array of program lengths, one for each worker.
+     * 
+     */
+    size_t* program_lengths;
+
+    /**
+     * @brief Points to an array of counters.
+     * 
+     */
+    lf_sched_counter_t* counters;
+
+    /**
+     * @brief The number of counters.
+     * 
+     */
+    size_t num_counters;
+
+    /**
+     * @brief The first epoch in which a worker has taken the BIT out of its
+     * loop, or SIZE_MAX. Workers that have run ahead into this epoch or later
+     * stop too, rather than wait for increments that will never come.
+     * 
+     */
+    _Atomic size_t stop_epoch;
+
+    /**
+     * @brief The schedule file given with `--schedule`, or NULL if the
+     * compiled-in schedules are used.
+     * 
+     */
+    static_schedule_t* schedule_file;
+
+    /**
+     * @brief The schedules unrolled with `--unroll`, or NULL if they are not
+     * unrolled. Their tables are those of `schedule_file`.
+     * 
+     */
+    static_schedule_t* unrolled_schedule;
+
+    /**
+     * @brief The period of the DUs of the schedules, or 0 if they have none.
+     * Workers that switch schedules start the new ones where the old ones
+     * would have started their next hyperperiod.
+     * 
+     */
+    interval_t hyperperiod;
+
+    /**
+     * @brief What DU adds to its release times so that they stay continuous
+     * across schedule swaps with different hyperperiods. 0 until the first
+     * swap.
+     * 
+     */
+    interval_t release_offset;
+
+    /**
+     * @brief Why the workers cannot switch from the schedules they run to
+     * others, or NULL if they can.
+     * 
+     */
+    const char* swap_problem;
+
+    /**
+     * @brief The schedule set that the workers switch to at the end of the
+     * current hyperperiod, or NULL.
+     * 
+     */
+    _Atomic(lf_sched_staged_schedule_t*) staged_schedule;
+
+    /**
+     * @brief What the workers ran before each swap, to be freed by the next
+     * `lf_sched_stage_schedule()` or by `lf_sched_free()`.
+     * 
+     */
+    _Atomic(lf_sched_staged_schedule_t*) retired_schedules;
+
+    /**
+     * @brief How many times the workers have switched schedules. A worker
+     * whose context has seen fewer loads the schedule of the last swap.
+     * 
+     */
+    _Atomic size_t swaps;
+
+    /**
+     * @brief The hyperperiod iteration that the workers continue with after
+     * the last swap.
+     * 
+     */
+    int swap_iteration;
+
+    /**
+     * @brief How WU waits for a counter.
+     * 
+     */
+    wait_policy_t wait_policy;
+
+    /**
+     * @brief Points to the nodes of the combining tree that SAC synchronizes
+     * the workers with.
+     * 
+     */
+    lf_sched_barrier_node_t* barrier_nodes;
+
+    /**
+     * @brief Incremented every time all workers have reached SAC.
+     * 
+     */
+    _Atomic uint32_t sac_generation;
+
+    /**
+     * @brief The number of workers sleeping in SAC.
+     * 
+     */
+    _Atomic uint32_t sac_waiters;
+
+#ifdef FS_WAIT_STATS
+    /**
+     * @brief Points to an array of wait statistics with one entry per worker
+     * and counter, indexed by `worker * num_counters + counter`.
+     * 
+     */
+    lf_sched_wait_stats_t* wait_stats;
+#endif
+
+#ifdef FS_PROFILE
+    /**
+     * @brief The profiler ticks and physical time when profiling started,
+     * which convert ticks to time.
+     * 
+     */
+    uint64_t profile_start_ticks;
+    instant_t profile_start_time;
+#endif
 
 #endif
 } _lf_sched_instance_t;
@@ -6,16 +6,143 @@
  * - ADV    rs1,    rs2 : ADVance the logical time of a reactor (rs1) by a specified amount (rs2). Add a delay_until here.
  * - ADV2   rs1,    rs2 : Lock-free version of ADV. The compiler needs to guarantee only a single thread can update a reactor's tag.
  * - BIT    rs1,        : (Branch-If-Timeout) Branch to a location (rs1) if all reactors reach timeout.
- * - DU     rs1,    rs2 : Delay Until a physical timepoint (rs1) plus an offset (rs2) is reached.
+ * - DU     rs1,    rs2 : Delay Until a physical timepoint (rs1) plus an offset (rs2) is reached. The timepoint is
+ *                        the physical start time plus rs1 times the hyperperiod iteration (from 1), and the
+ *                        offset is only added if it is positive.
  * - EIT    rs1         : Execute a reaction (rs1) If Triggered. FIXME: Combine with a branch.
  * - EXE    rs1         : EXEcute a reaction (rs1) (used for known triggers such as startup, shutdown, and timers).
  * - INC    rs1,    rs2 : INCrement a counter (rs1) by an amount (rs2).
  * - INC2   rs1,    rs2 : Lock-free version of INC. The compiler needs to guarantee single writer.
- * - JMP    rs1         : JuMP to a location (rs1).
- * - SAC                : (Sync-And-Clear) synchronize all workers until all execute SAC and let the last idle worker reset all counters to 0.
+ * - JMP    rs1,    rs2 : JuMP to a location (rs1). If rs2 is positive, count rs2 hyperperiod iterations.
+ * - SAC                : (Sync-And-Clear) synchronize all workers until all execute SAC. The counters are no longer
+ *                        cleared; see below.
  * - STP                : SToP the execution.
- * - WU     rs1,    rs2 : Wait Until a counting variable (rs1) to reach a desired value (rs2).
+ * - WU     rs1,    rs2 : Wait Until a counting variable (rs1) to reach a desired value (rs2) in the current epoch.
+ * - ADDI   rs1,    rs2 : ADD an Immediate (rs2) to a register (rs1).
+ * - BEQ    rs1,    rs2 : Branch to a location (rs1) if a register (rs2) is EQual to zero.
+ * - BNE    rs1,    rs2 : Branch to a location (rs1) if a register (rs2) is Not Equal to zero.
+ * - BLT    rs1,    rs2 : Branch to a location (rs1) if a register (rs2) is Less Than zero.
+ * - BNT    rs1,    rs2 : Branch to a location (rs1) if a reaction (rs2) is Not Triggered, i.e., not queued because
+ *                        none of its triggers (e.g., input ports) is present. It may only skip forward over EIT
+ *                        and BNT, e.g., a chain of EITs downstream of the reaction.
+ * - SRV    rs1         : SeRVe the triggered sporadic reactions (see below) for up to rs1 nanoseconds.
+ * - BNM    rs1,    rs2 : Branch to a location (rs1) if the mode of a reaction (rs2) is Not active (see below). It
+ *                        may only skip forward over EXE, EIT, BNT, and BNM, e.g., the reactions of the mode.
+ *
+ * How WU waits is chosen per schedule with a `wait_policy_t`.
+ *
+ * Registers
+ *
+ * Each worker has `INST_NUM_REGISTERS` registers of 64 bits, which start at
+ * 0 and keep their values across epochs. They let a schedule repeat part of
+ * a hyperperiod instead of unrolling it, e.g., n times with
+ *
+ *     ADDI r, n;  L: ...;  ADDI r, -1;  BNE L, r
+ *
+ * Inner loops close with a register branch, since the first JMP backwards
+ * closes the worker's loop. The path through a schedule depends only on the
+ * registers, which only change by immediates, and on BNT and BNM, which only
+ * skip reactions, so tools can follow it without running the program (see
+ * `static_schedule_step()`). For the same reason, the loop must leave the
+ * registers as it found them, so that every epoch takes the same path, and a
+ * WU in an inner loop waits for the same value in every iteration.
+ *
+ * Sporadic reactions
+ *
+ * A reaction that no EXE, EIT, or BNT of any worker names, e.g., one
+ * triggered by a physical action, is sporadic. If a schedule has an SRV,
+ * triggering a sporadic reaction puts it in a queue ordered by reaction
+ * index, i.e., by level and then deadline, as the GEDF scheduler does. SRV
+ * runs reactions from the queue on the worker until the queue is empty or
+ * its budget (rs1) is used up. It does not preempt a reaction, so the budget
+ * bounds when the last reaction starts, not when it ends. An SRV slot takes
+ * no longer than its budget plus one reaction, whatever the sporadic load,
+ * so the static part of the schedule keeps its timing, and a sporadic
+ * reaction waits at most until enough SRV slots have come around. Without
+ * an SRV, sporadic reactions are never run.
+ *
+ * Modes
+ *
+ * A schedule for modal reactors gives the reactions of each mode a segment
+ * of their own, headed by a BNM naming one of them, which skips the segment
+ * while the mode is inactive:
+ *
+ *     BNM B, a;  EXE a0;  EXE a1;  B: BNM C, b;  EXE b0;  C: ADV2 x, p
+ *
+ * The reactions of inactive modes then cost a branch per segment instead of
+ * a check per reaction. Reactions only request mode transitions; the worker
+ * that completes the SAC before the JMP closing the loops applies them (see
+ * `_lf_process_mode_changes()`) while the others wait, so every worker sees
+ * the same modes throughout a hyperperiod and takes the new segments from
+ * the next one on. Schedules with BNM must therefore end the loop of every
+ * worker with SAC and JMP. A segment holds only reactions, so the counters
+ * and reactor tags advance the same in every mode. Without modal reactors,
+ * BNM never branches.
+ *
+ * Epochs
+ *
+ * Counters are 64 bits wide, only grow, and are never reset. Each worker
+ * counts its own epoch, which starts at 0 and goes up by one every time the
+ * worker takes the JMP that closes its loop (its first JMP backwards). A WU
+ * in the loop waits for rs2 on top of everything that the INCs before the
+ * loops and the INCs of the earlier epochs add to the counter (see
+ * `static_schedule_counter_offsets()`), which is what it would have waited
+ * for if SAC cleared the counters at the end of every epoch. SAC is thus
+ * only needed where reactions on different workers have to be ordered
+ * across epochs and no counter does it. Without SAC, a worker can start its
+ * next epoch while the others are still in this one, and can run ahead as
+ * far as its WUs allow, and therefore also past the stop tag: BIT, which
+ * checks the reactors of all workers, may only see them stop a few epochs
+ * later. Once one worker has taken BIT, the workers in the same or a later
+ * epoch leave their loops too, from BIT or from WU.
+ *
+ * The epoch targets only tell the epochs apart if no WU in a loop without
+ * SAC at its end waits for a counter that two or more other workers
+ * increment in their loops: otherwise, a worker that runs ahead can make up
+ * with its next epoch's increments for those that another worker has not
+ * made in this one yet. The schedule verifier rejects such schedules.
+ *
+ * Memory ordering
+ *
+ * Reactions on different workers hand data to each other (e.g., through
+ * ports) without locks. The schedule makes this safe with the counters:
+ *
+ * - INC and INC2 increment a counter with release semantics, and WU reads it
+ *   with acquire semantics. Everything a worker wrote before an INC/INC2,
+ *   including the outputs of the reactions it executed, is visible to a
+ *   worker after a WU that observes the incremented value.
+ * - SAC orders everything before it on any worker before everything after it
+ *   on every worker.
+ * - A worker that runs ahead into the next epoch must not overwrite data
+ *   that a slower worker still reads in this one. Without SAC, the schedule
+ *   has to order this with a counter, e.g., one that the reader increments
+ *   and the writer waits for.
+ * - Nothing else orders memory between workers. A reaction may only read
+ *   data written by a reaction on another worker if a chain of INC/INC2 and
+ *   WU, or a SAC, lies between the two, and two reactions on different
+ *   workers that write the same data must be ordered in the same way.
+ * - INC is an atomic read-modify-write and may be used by any number of
+ *   workers. INC2 is a plain store and requires that no other worker ever
+ *   writes the counter, which the schedule verifier checks.
+ * - ADV and ADV2 publish a reactor's new tag with release semantics, and
+ *   likewise ADV is an atomic read-modify-write while ADV2 requires a single
+ *   writer. Neither takes a lock. BIT reads a countdown of the reactors that
+ *   have not gone past the stop tag yet with acquire semantics.
  */
+#ifndef SCHEDULER_INSTRUCTIONS_H
+#define SCHEDULER_INSTRUCTIONS_H
+
+#include <stddef.h>
+
+#ifndef FS_FUSE
+/**
+ * @brief Whether the FS scheduler fuses common instruction sequences into
+ * superinstructions when it loads a schedule. Set to 0 to compare with the
+ * unfused program.
+ */
+#define FS_FUSE 1
+#endif
+
 typedef enum {
     ADV,
     ADV2,
@@ -29,10 +156,108 @@ typedef enum {
     SAC,
     STP,
     WU,
+    ADDI,
+    BEQ,
+    BNE,
+    BLT,
+    BNT,
+    SRV,
+    BNM,
+
+    // Superinstructions. These never appear in a schedule: the scheduler fuses
+    // common sequences into them when it loads a schedule, unless FS_FUSE is 0.
+    // A superinstruction replaces the first instruction of its sequence and
+    // takes its operands from the instructions that follow, which stay in
+    // place so that jumps into the sequence still work. It runs its reaction
+    // on the worker without leaving the VM. INC stands for INC or INC2, and
+    // ADV for ADV or ADV2.
+    EXE_INC,        // EXE r; INC c, n
+    EXE_ADV,        // EXE r; ADV x, p
+    EXE_INC_ADV,    // EXE r; INC c, n; ADV x, p
+    WU_EIT,         // WU c, v; EIT r
 } opcode_t;
 
 typedef struct inst_t {
     opcode_t        op;
     long long int   rs1;
     long long int   rs2;
-} inst_t;
\ No newline at end of file
+} inst_t;
+
+/** The number of registers of each worker. */
+#define INST_NUM_REGISTERS 8
+
+/**
+ * @brief Whether an instruction with opcode `op` may jump, in which case its
+ * rs1 is the target.
+ */
+static inline int inst_is_branch(unsigned int op) {
+    return op == BIT || op == JMP || op == BEQ || op == BNE || op == BLT || op == BNT || op == BNM;
+}
+
+/**
+ * @brief Whether BEQ, BNE, or BLT, given as `op`, is taken for a register
+ * holding `value`.
+ */
+static inline int inst_register_branch_taken(unsigned int op, long long int value) {
+    switch (op) {
+        case BEQ:
+            return value == 0;
+        case BNE:
+            return value != 0;
+        case BLT:
+            return value < 0;
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief ADDI: add an immediate to a register, wrapping around on overflow.
+ */
+static inline long long int inst_add_immediate(long long int value, long long int immediate) {
+    return (long long int)((unsigned long long)value + (unsigned long long)immediate);
+}
+
+/**
+ * @brief How many instructions of the schedule an instruction with opcode
+ * `op` covers, i.e., how far it moves the pc if it does not branch. This is
+ * 1 except for superinstructions.
+ */
+static inline size_t inst_length(unsigned int op) {
+    switch (op) {
+        case EXE_INC:
+        case EXE_ADV:
+        case WU_EIT:
+            return 2;
+        case EXE_INC_ADV:
+            return 3;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * @brief The superinstruction for an instruction `op` followed by `next` and
+ * `after`, or `op` if the sequence does not start with one. The longest
+ * sequence wins.
+ */
+static inline unsigned int inst_fuse(unsigned int op, unsigned int next, unsigned int after) {
+    int next_is_inc = next == INC || next == INC2;
+    int next_is_adv = next == ADV || next == ADV2;
+    if (op == EXE && next_is_inc && (after == ADV || after == ADV2)) return EXE_INC_ADV;
+    if (op == EXE && next_is_inc) return EXE_INC;
+    if (op == EXE && next_is_adv) return EXE_ADV;
+    if (op == WU && next == EIT) return WU_EIT;
+    return op;
+}
+
+/**
+ * @brief How WU waits for a counter that has not reached its value yet.
+ */
+typedef enum {
+    WAIT_SPIN,      // Spin until the value is reached. Lowest latency, but occupies a core.
+    WAIT_HYBRID,    // Spin for a bounded time, then sleep until an INC wakes the worker.
+    WAIT_BLOCK,     // Sleep right away. Leaves the core to others, e.g., on a shared host.
+} wait_policy_t;
+
+#endif // SCHEDULER_INSTRUCTIONS_H
@@ -0,0 +1,64 @@
+/**
+ * @file scheduler_swap.h
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief Switching the FS scheduler to other static schedules while it runs.
+ *
+ * A schedule set for the same program, e.g., a degraded mode that keeps some
+ * workers idle or a mode for high load, can be staged from any thread. The
+ * workers switch to it at the end of the current hyperperiod, i.e., at the
+ * SAC right before the JMP that closes their loops: the worker that
+ * completes that SAC installs the staged set, and every worker leaves the
+ * SAC at the start of the loop of its new schedule, without running the
+ * code before it again. No hyperperiod is dropped and no extra barrier is
+ * needed:
+ *
+ * - The hyperperiod iteration goes on from where the old schedules would
+ *   have continued, and the release times of DU are shifted so that the
+ *   first hyperperiod of the new schedules starts when the next one of the
+ *   old schedules would have started.
+ * - The counters and epochs start over, with the counters set to what the
+ *   code before the loops adds to them (see
+ *   `static_schedule_counter_offsets()`).
+ * - Reactor tags are left as they are.
+ *
+ * Both the schedules that run and the staged ones must end the loop of every
+ * worker with a SAC followed by the JMP, advance the hyperperiod iteration by
+ * the same amount in every worker, and give all their DUs the same period.
+ * The wait policy stays the one the program started with. Reactions that
+ * the staged schedules do not name must be served by SRV if and only if they
+ * are served now.
+ *
+ * With a schedule file given with `--schedule`, `FS_SWAP_SIGNAL` (SIGHUP by
+ * default) stages the file again, so a running program can be switched by
+ * replacing the file and sending the signal.
+ */
+#ifndef SCHEDULER_SWAP_H
+#define SCHEDULER_SWAP_H
+
+#include <stddef.h>
+
+/**
+ * @brief Stage a schedule file for the workers to switch to at the end of
+ * the current hyperperiod. Can be called from any thread but the workers.
+ *
+ * The file is mapped, unrolled as given with `--unroll`, verified, and
+ * decoded before this returns. A set that was staged before and has not been
+ * switched to yet is dropped.
+ *
+ * Not available with compiled schedules (FS_COMPILED) or with FS_PROFILE,
+ * whose profiles are kept per line of the schedules that were loaded first.
+ *
+ * @param path The schedule file, which must be for the same number of workers
+ *  and the same reactions and reactors.
+ * @param error Set to a description of the problem if the file cannot be
+ *  staged. Problems found by the verifier are printed as well.
+ * @return 0 on success, or -1 if the file cannot be staged.
+ */
+int lf_sched_stage_schedule(const char* path, const char** error);
+
+/**
+ * @brief The number of times the workers have switched schedules.
+ */
+size_t lf_sched_schedule_swaps();
+
+#endif // SCHEDULER_SWAP_H
@@ -0,0 +1,224 @@
+/**
+ * @file static_schedule_file.h
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief A binary file format for the static schedules of the FS scheduler.
+ *
+ * A schedule file lets a program run a schedule other than the one compiled
+ * into it (see the `--schedule` command-line option). The file is laid out so
+ * that it can be mapped into memory and used in place:
+ *
+ * | Part           | Contents                                              |
+ * |----------------|-------------------------------------------------------|
+ * | Header         | `static_schedule_file_header_t`                       |
+ * | Sections       | One `static_schedule_file_section_t` per worker       |
+ * | Reaction table | `num_reactions` uint32_t                              |
+ * | Reactor table  | `num_reactors` uint32_t                               |
+ * | Instructions   | One 8-byte aligned array of `inst_t` per worker       |
+ *
+ * Reaction and reactor operands of the instructions, plus the reaction and
+ * reactor bases of the worker's section, index into the reaction and reactor
+ * tables, which in turn hold indices into the reaction and reactor arrays of
+ * the program. The checksum is the 32-bit FNV-1a hash of everything that
+ * follows the header.
+ *
+ * Workers can share instructions. For a bank of identical reactors, one
+ * template of the work of a bank member is stored once, the sections of the
+ * workers that run the members all point at it, and each section's bases
+ * select the member's rows of the tables. `static_schedule_write()` stores
+ * the instructions of workers whose schedules are the same array once.
+ *
+ * A section can also name the CPU that its worker runs on, for schedules
+ * whose timing was worked out for a particular machine. The runtime pins the
+ * worker to it unless the `--cpus` command-line option says otherwise (see
+ * worker_placement.h). Switching to another schedule while the program runs
+ * does not move the workers.
+ *
+ * All integers are stored in the byte order of the machine that wrote the
+ * file, and instructions are stored with the in-memory layout of `inst_t`.
+ * A file written on a machine with a different byte order or `inst_t`
+ * layout is rejected rather than converted.
+ *
+ * This module does not depend on the rest of the runtime so that offline
+ * tools can use it.
+ */
+#ifndef STATIC_SCHEDULE_FILE_H
+#define STATIC_SCHEDULE_FILE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "scheduler_instructions.h"
+
+#define STATIC_SCHEDULE_FILE_MAGIC "LFSS"
+#define STATIC_SCHEDULE_FILE_VERSION 4
+#define STATIC_SCHEDULE_FILE_BYTE_ORDER 0x0102
+
+/** The CPU of a worker that is not pinned to one. */
+#define STATIC_SCHEDULE_NO_CPU (-1)
+
+/**
+ * @brief The header at the start of a schedule file.
+ */
+typedef struct {
+    char        magic[4];       // STATIC_SCHEDULE_FILE_MAGIC, without the '\0'.
+    uint16_t    version;        // STATIC_SCHEDULE_FILE_VERSION.
+    uint16_t    byte_order;     // STATIC_SCHEDULE_FILE_BYTE_ORDER, as written.
+    uint32_t    num_workers;
+    uint32_t    num_counters;
+    uint32_t    num_reactions;  // Length of the reaction table.
+    uint32_t    num_reactors;   // Length of the reactor table.
+    uint32_t    inst_size;      // sizeof(inst_t) on the machine that wrote the file.
+    uint32_t    checksum;
+    uint32_t    wait_policy;    // A wait_policy_t.
+} static_schedule_file_header_t;
+
+/**
+ * @brief Where the instructions of one worker are in a schedule file.
+ */
+typedef struct {
+    uint64_t    offset;         // Offset from the start of the file, in bytes.
+    uint64_t    length;         // Number of instructions.
+    uint32_t    reaction_base;  // Added to the reaction operands of the worker.
+    uint32_t    reactor_base;   // Added to the reactor operands of the worker.
+    int32_t     cpu;            // The CPU to pin the worker to, or STATIC_SCHEDULE_NO_CPU.
+    uint32_t    reserved;       // 0.
+} static_schedule_file_section_t;
+
+/**
+ * @brief A set of static schedules, one per worker, with the tables that
+ * their operands refer to.
+ *
+ * When filled in by `static_schedule_map()`, all pointers except `schedules`,
+ * `schedule_lengths`, and the bases point into the mapped file.
+ */
+typedef struct {
+    size_t              num_workers;
+    const inst_t**      schedules;
+    size_t*             schedule_lengths;
+    size_t*             reaction_bases; // Per worker (see above). NULL if all are 0.
+    size_t*             reactor_bases;  // Per worker. NULL if all are 0.
+    int*                cpus;           // Per worker, or STATIC_SCHEDULE_NO_CPU. NULL if none is pinned.
+    size_t              num_counters;
+    size_t              num_reactions;
+    const uint32_t*     reaction_table;
+    size_t              num_reactors;
+    const uint32_t*     reactor_table;
+    wait_policy_t       wait_policy;
+    void*               mapping;        // Owned by the loader. NULL if not loaded from a file.
+    size_t              mapping_size;
+} static_schedule_t;
+
+/**
+ * @brief Map a schedule file into memory.
+ *
+ * Checks the header, the section bounds, and the checksum. It does not check
+ * the instructions themselves.
+ *
+ * @param path The file to map.
+ * @param schedule Filled in on success. Release with `static_schedule_unmap()`.
+ * @param error On failure, set to a message describing the problem.
+ * @return 0 on success, -1 on failure.
+ */
+int static_schedule_map(const char* path, static_schedule_t* schedule, const char** error);
+
+/**
+ * @brief Release a schedule filled in by `static_schedule_map()`.
+ */
+void static_schedule_unmap(static_schedule_t* schedule);
+
+/**
+ * @brief Write a set of schedules to a file.
+ *
+ * The `mapping` fields of `schedule` are ignored. If `reaction_table` or
+ * `reactor_table` is NULL, the identity table of the given length is written.
+ *
+ * @param path The file to write.
+ * @param schedule The schedules to write.
+ * @param error On failure, set to a message describing the problem.
+ * @return 0 on success, -1 on failure.
+ */
+int static_schedule_write(const char* path, const static_schedule_t* schedule, const char** error);
+
+/**
+ * @brief A hash of what a set of schedules does, for telling whether two
+ * sets are the same program.
+ *
+ * Covers the number of workers and counters and every instruction, with
+ * reaction and reactor operands resolved through the bases and tables (if
+ * any), so a compiled-in schedule and a file written from it with identity
+ * tables, or a bank written as one template, have the same fingerprint. The
+ * wait policy is not covered.
+ */
+uint32_t static_schedule_fingerprint(const static_schedule_t* schedule);
+
+/**
+ * @brief The index into the program's reaction array that a reaction operand
+ * of a worker refers to: the operand plus the worker's reaction base, looked
+ * up in the reaction table if there is one. The operand must be in range, as
+ * the verifier checks.
+ */
+size_t static_schedule_reaction_index(const static_schedule_t* schedule, size_t worker, long long int operand);
+
+/**
+ * @brief The index into the program's reactor array that a reactor operand
+ * of a worker refers to, like `static_schedule_reaction_index()`.
+ */
+size_t static_schedule_reactor_index(const static_schedule_t* schedule, size_t worker, long long int operand);
+
+/** Returned by `static_schedule_loop_end()` for a schedule without a loop. */
+#define STATIC_SCHEDULE_NO_LOOP ((size_t)-1)
+
+/**
+ * @brief The JMP that closes the loop of a schedule, i.e., its first JMP
+ * backwards, or `STATIC_SCHEDULE_NO_LOOP`. The loop starts at the target of
+ * the JMP.
+ *
+ * Every time a worker takes this JMP, it starts a new epoch (see
+ * `static_schedule_counter_offsets()`).
+ */
+size_t static_schedule_loop_end(const inst_t* schedule, size_t length);
+
+/**
+ * @brief The most instructions that the tools follow a worker for, from the
+ * start of its schedule until it closes its loop once. The verifier rejects
+ * schedules whose inner loops take longer.
+ */
+#define STATIC_SCHEDULE_MAX_STEPS ((size_t)1 << 24)
+
+/**
+ * @brief Follow the path of a worker past the instruction at `pc`, as the
+ * tools do without running the program: ADDI updates `registers`, BEQ, BNE,
+ * and BLT branch as the registers say, JMP always jumps, and BIT, BNT, and
+ * BNM never branch. BNT and BNM only skip reactions, so their paths do the
+ * same. Any other instruction moves on to the next.
+ *
+ * @param inst The instruction at `pc`.
+ * @param pc Where the worker is.
+ * @param registers The `INST_NUM_REGISTERS` registers of the worker.
+ * @return The next pc, which may be outside the schedule.
+ */
+size_t static_schedule_step(const inst_t* inst, size_t pc, long long int* registers);
+
+/**
+ * @brief How much the workers add to each counter before and per pass
+ * through their loops.
+ *
+ * Counters are never cleared, so a WU at or after the start of its worker's
+ * loop, in the worker's epoch e (from 0), waits for the counter to reach
+ * `base + e * per_epoch + rs2`, where `base` is what the INC and INC2 that
+ * the workers execute before they reach their loops add to the counter and
+ * `per_epoch` what they execute in one pass through them. A WU before its
+ * worker's loop waits for rs2. The paths are followed as by
+ * `static_schedule_step()`, so an INC in an inner loop counts once per
+ * iteration.
+ *
+ * The operands must be in range, as the verifier checks.
+ *
+ * @param schedule The schedules.
+ * @param base Set to the base of each counter. Can be NULL.
+ * @param per_epoch Set to the increment of each counter per epoch.
+ */
+void static_schedule_counter_offsets(const static_schedule_t* schedule,
+                                     unsigned long long* base, unsigned long long* per_epoch);
+
+#endif // STATIC_SCHEDULE_FILE_H
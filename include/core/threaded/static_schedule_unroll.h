@@ -0,0 +1,116 @@
+/**
+ * @file static_schedule_unroll.h
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief Hyperperiod unrolling for the schedules of the FS scheduler.
+ *
+ * Unrolling a set of schedules k times makes every worker run k hyperperiods
+ * per pass through its loop, so SAC, JMP, and BIT run once every k
+ * hyperperiods instead of every hyperperiod. Each worker's loop must have
+ * the form
+ *
+ *     t:   BIT  exit
+ *          body            (no BIT, JMP, SAC, or STP)
+ *          SAC
+ *          tail            (no BIT, JMP, SAC, STP, INC, INC2, or WU)
+ *          JMP  t
+ *
+ * where the JMP is the first JMP backwards in the schedule, and the SAC and
+ * tail may be left out. Instructions before `t` and after the JMP are kept,
+ * and their jump targets renumbered. The loop becomes
+ *
+ *     t:   BIT  exit'
+ *          body_0  tail_0  body_1  tail_1  ...  body_k-1  SAC  tail_k-1
+ *          JMP  t
+ *
+ * where copy j differs from the original as follows:
+ *
+ * - A pass through the loop is now one epoch of k hyperperiods (see
+ *   `static_schedule_counter_offsets()`), so a WU on a counter waits for its
+ *   value plus j times the amount that all workers add to the counter per
+ *   hyperperiod.
+ * - If the JMP counts hyperperiods (rs2 > 0), it counts k times as many, and
+ *   a DU gets an offset (rs2) of j times its period so that it releases at
+ *   the same time as before.
+ * - A run of ADV or ADV2 instructions that advances the same reactor more
+ *   than once, e.g., at the end of one copy and the start of the next, is
+ *   merged into a single instruction.
+ *
+ * Because the workers only synchronize once every k hyperperiods, unrolling
+ * is only correct if
+ *
+ * - the reactions on different workers are ordered by INC/WU alone, not by
+ *   SAC (this cannot be checked from the schedule and is up to its author);
+ * - a WU never has to tell apart the increments of two other workers, since
+ *   one of them may be a hyperperiod ahead. Unrolling fails otherwise; and
+ * - running up to k - 1 hyperperiods past the stop tag is acceptable, since
+ *   BIT is only checked once every k hyperperiods.
+ *
+ * `schedules/v6.c` and `schedules/v8.c` are `schedules/v5.c` unrolled 2 and
+ * 4 times.
+ *
+ * This module does not depend on the rest of the runtime so that offline
+ * tools can use it.
+ */
+#ifndef STATIC_SCHEDULE_UNROLL_H
+#define STATIC_SCHEDULE_UNROLL_H
+
+#include <stddef.h>
+
+#include "static_schedule_file.h"
+
+/** The largest factor that `static_schedule_choose_unroll_factor()` picks. */
+#define STATIC_SCHEDULE_UNROLL_MAX_FACTOR 64
+
+/** The default limit on the length of an unrolled schedule. */
+#define STATIC_SCHEDULE_UNROLL_MAX_INSTRUCTIONS 2048
+
+/**
+ * @brief A measurement of a schedule that an unroll factor is chosen by.
+ *
+ * With the FS_PROFILE build, `barrier_ns` is the time on the SAC, JMP, and
+ * BIT lines and `hyperperiod_ns` the total time of the slowest worker, both
+ * divided by the number of hyperperiods.
+ */
+typedef struct {
+    double  barrier_ns;         // Time per hyperperiod spent in SAC, JMP, and BIT.
+    double  hyperperiod_ns;     // Time per hyperperiod, including the barrier.
+    double  max_overhead;       // The largest acceptable fraction of time spent in the barrier.
+    size_t  max_instructions;   // The longest acceptable unrolled schedule of a worker.
+} static_schedule_unroll_profile_t;
+
+/**
+ * @brief Unroll the hyperperiod of a set of schedules.
+ *
+ * @param schedule The schedules to unroll.
+ * @param factor How many hyperperiods the unrolled schedules run per loop.
+ *  A factor of 1 copies the schedules.
+ * @param unrolled Filled in on success with newly allocated schedules that
+ *  share the reaction and reactor tables of `schedule`. Release with
+ *  `static_schedule_unroll_free()`.
+ * @param error On failure, set to a message describing the problem.
+ * @return 0 on success, -1 on failure.
+ */
+int static_schedule_unroll(const static_schedule_t* schedule, size_t factor,
+                           static_schedule_t* unrolled, const char** error);
+
+/**
+ * @brief Release schedules filled in by `static_schedule_unroll()`.
+ */
+void static_schedule_unroll_free(static_schedule_t* unrolled);
+
+/**
+ * @brief Choose how many times to unroll a set of schedules.
+ *
+ * Picks the smallest factor that brings the time spent in the barrier down
+ * to `profile->max_overhead` of the total, but no factor that makes any
+ * worker's schedule longer than `profile->max_instructions` (or
+ * `STATIC_SCHEDULE_UNROLL_MAX_INSTRUCTIONS` if 0), since a schedule that no
+ * longer fits the cache costs more than the barrier it saves.
+ *
+ * @return A factor between 1 and `STATIC_SCHEDULE_UNROLL_MAX_FACTOR`, or 1
+ *  if the schedules cannot be unrolled.
+ */
+size_t static_schedule_choose_unroll_factor(const static_schedule_t* schedule,
+                                            const static_schedule_unroll_profile_t* profile);
+
+#endif // STATIC_SCHEDULE_UNROLL_H
@@ -0,0 +1,96 @@
+/**
+ * @file static_schedule_verify.h
+ * @author Shaokai Lin <shaokai@berkeley.edu>
+ * @brief A static verifier for the schedules of the FS scheduler.
+ *
+ * The verifier checks a set of schedules before they run:
+ *
+ * - Every opcode is known and every operand is in range: reactions and
+ *   reactors, with the bases of their worker added, against the index tables
+ *   (or the program's arrays), counters
+ *   against the counter count, registers against `INST_NUM_REGISTERS`, and
+ *   branch targets against the schedule. A BNT only skips forward over EIT
+ *   and BNT, and a BNM over EXE, EIT, BNT, and BNM, so that neither changes
+ *   the path of its worker. An SRV has a positive budget.
+ * - If any schedule has a BNM, every worker ends its loop with SAC and JMP,
+ *   where the modes change (see scheduler_instructions.h).
+ * - Every worker executes SAC the same number of times per hyperperiod.
+ * - No INC or INC2 decrements its counter or adds 2^32 or more to it.
+ * - No WU can wait forever. One hyperperiod of all workers, i.e., their
+ *   first epoch (see `static_schedule_counter_offsets()`), is executed
+ *   abstractly, with counters but without reactions or time, and any worker
+ *   that ends up blocked on a WU is reported. This catches both targets that
+ *   the INC/INC2 of an epoch never add up to and cyclic waits across
+ *   workers. Later epochs wait for the same increments on top of those of
+ *   the epochs before.
+ * - No counter that is incremented with INC2 is written by more than one
+ *   worker.
+ * - No WU in a loop that does not end with SAC waits for a counter that
+ *   two or more other workers increment in their loops (see the epochs in
+ *   scheduler_instructions.h).
+ * - Every register is the same when a worker closes its loop as when it
+ *   entered it, so that every epoch takes the same path.
+ *
+ * A hyperperiod is the path from line 0 of each schedule, with BIT, BNT, and
+ * BNM not taken and the other branches taken as the registers say, up to the
+ * first JMP backwards or STP (see `static_schedule_step()`). Paths longer
+ * than `STATIC_SCHEDULE_MAX_STEPS` instructions are rejected. A WU is
+ * re-examined at most once per INC of its counter, so verification takes
+ * time linear in the number of instructions the workers execute in a
+ * hyperperiod.
+ *
+ * This module does not depend on the rest of the runtime so that offline
+ * tools can use it.
+ */
+#ifndef STATIC_SCHEDULE_VERIFY_H
+#define STATIC_SCHEDULE_VERIFY_H
+
+#include <stddef.h>
+
+#include "static_schedule_file.h"
+
+/** Passed as the worker or line to a report that is not about one. */
+#define STATIC_SCHEDULE_NO_LOCATION ((size_t)-1)
+
+/**
+ * @brief Called for every problem the verifier finds.
+ *
+ * @param user_data The pointer given to `static_schedule_verify()`.
+ * @param worker The worker whose schedule has the problem, or
+ *  `STATIC_SCHEDULE_NO_LOCATION`.
+ * @param line The instruction with the problem, or
+ *  `STATIC_SCHEDULE_NO_LOCATION`.
+ * @param message A description of the problem. Only valid during the call.
+ */
+typedef void (*static_schedule_report_t)(void* user_data, size_t worker, size_t line, const char* message);
+
+/**
+ * @brief Verify a set of schedules.
+ *
+ * If `schedule->reaction_table` is NULL, reaction operands plus the
+ * worker's reaction base index the program's reaction array directly, and
+ * likewise for reactors.
+ *
+ * @param schedule The schedules to verify.
+ * @param num_reaction_instances The length of the program's reaction array,
+ *  or 0 if it is not known (e.g., in an offline tool).
+ * @param num_reactor_instances The length of the program's reactor array, or
+ *  0 if it is not known.
+ * @param report Called once for every problem. Can be NULL.
+ * @param user_data Passed to `report`.
+ * @return The number of problems found.
+ */
+int static_schedule_verify(const static_schedule_t* schedule,
+                           size_t num_reaction_instances,
+                           size_t num_reactor_instances,
+                           static_schedule_report_t report,
+                           void* user_data);
+
+/**
+ * @brief A `static_schedule_report_t` for the offline tools that prints a
+ * problem to stderr, prefixed with the worker and line, if any, and with
+ * the path of the schedule file, which is passed as `user_data`.
+ */
+void static_schedule_print_problem(void* user_data, size_t worker, size_t line, const char* message);
+
+#endif // STATIC_SCHEDULE_VERIFY_H
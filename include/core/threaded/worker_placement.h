@@ -0,0 +1,90 @@
+/**
+ * @file worker_placement.h
+ * @brief Where and how the worker threads run: the CPU of each worker, a
+ * real-time priority, and memory locked into RAM.
+ *
+ * The workers are created with default attributes, so the OS may migrate
+ * them between CPUs, preempt them for other threads, and stall them on page
+ * faults. A static schedule of the FS scheduler assumes that none of this
+ * happens. A program can therefore ask for:
+ *
+ * - A CPU per worker, with the `--cpus` command-line option or, with the FS
+ *   scheduler, in the sections of the schedule file (see
+ *   static_schedule_file.h). `--cpus` takes precedence.
+ * - The real-time FIFO policy at a priority, with `--priority`. A worker at
+ *   a real-time priority that spins, e.g., in WU or before a DU release,
+ *   keeps threads of lower priority off its CPU, so give it a CPU of its own.
+ * - Memory locked into RAM, with `--lock-memory`. The memory that is mapped
+ *   later is locked as it is mapped, and every worker touches the first
+ *   `LF_WORKER_STACK_PREFAULT` bytes of its stack before it runs reactions.
+ *
+ * Each worker places itself before it asks the scheduler for work. Memory
+ * that a worker allocates afterwards, such as the context that an FS worker
+ * moves into its own memory, is therefore first touched on the CPU it is
+ * pinned to. What cannot be granted, e.g., a real-time priority in an
+ * unprivileged container or a CPU outside the cpuset of the process, is
+ * reported with a warning, and the worker runs without it.
+ *
+ * This works with all schedulers.
+ */
+#ifndef WORKER_PLACEMENT_H
+#define WORKER_PLACEMENT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifndef LF_WORKER_STACK_PREFAULT
+/**
+ * @brief How much of its stack a worker touches when memory is locked, in
+ * bytes. Must be below the stack size of a thread.
+ */
+#define LF_WORKER_STACK_PREFAULT (64 * 1024)
+#endif
+
+/** The CPU of a worker that is not pinned. */
+#define LF_WORKER_NO_CPU (-1)
+
+/**
+ * @brief Set the CPUs of the workers from a comma-separated list, e.g.,
+ * "2,3,4", where worker i runs on the i-th CPU. Workers beyond the end of the
+ * list are not pinned by it.
+ *
+ * @return 0 on success, or -1 if the list is malformed.
+ */
+int lf_worker_set_cpus(const char* list);
+
+/**
+ * @brief Set the CPU of a worker unless the CPUs were given with
+ * `lf_worker_set_cpus()`. The FS scheduler calls this for the CPUs in the
+ * schedule file.
+ *
+ * @param cpu The CPU, or `LF_WORKER_NO_CPU`.
+ */
+void lf_worker_set_default_cpu(size_t worker_number, int cpu);
+
+/**
+ * @brief Run the workers with the real-time FIFO policy at `priority`, or,
+ * if it is 0, with the default policy.
+ */
+void lf_worker_set_priority(int priority);
+
+/**
+ * @brief Whether to lock the memory of the program into RAM.
+ */
+void lf_worker_set_lock_memory(bool lock);
+
+/**
+ * @brief Prepare the placement of `num_workers` workers. Called once before
+ * the workers are started. Locks the memory if requested and warns about
+ * CPUs that are given to more than one worker.
+ */
+void lf_worker_placement_init(size_t num_workers);
+
+/**
+ * @brief Place the calling thread as worker `worker_number`: pin it to its
+ * CPU, set its priority, and touch its stack, as requested. Called by every
+ * worker before it asks the scheduler for work.
+ */
+void lf_worker_place(size_t worker_number);
+
+#endif // WORKER_PLACEMENT_H
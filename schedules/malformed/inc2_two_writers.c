@@ -0,0 +1,41 @@
+/**
+ * @brief A malformed schedule that the verifier must reject: both workers increment counter 0 with INC2, which requires a single writer.
+ */
+
+#include <stddef.h> // size_t
+#include "../core/threaded/scheduler_instructions.h"
+
+
+const inst_t schedule_0[] = {
+    {.op=BIT,   .rs1=5,     .rs2=-1},       // BIT if timeout, jump to line 5.
+    {.op=EXE,   .rs1=0,     .rs2=-1},       // EXE reaction 0
+    {.op=INC2,  .rs1=0,     .rs2=1},        // INC2 counter 0 by 1
+    {.op=SAC,   .rs1=-1,    .rs2=-1},       // Sync all workers
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t schedule_1[] = {
+    {.op=BIT,   .rs1=5,     .rs2=-1},       // BIT if timeout, jump to line 5.
+    {.op=EXE,   .rs1=1,     .rs2=-1},       // EXE reaction 1
+    {.op=INC2,  .rs1=0,     .rs2=1},        // INC2 counter 0 by 1, also written by worker 0
+    {.op=SAC,   .rs1=-1,    .rs2=-1},       // Sync all workers
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t* static_schedules[] = {
+    schedule_0,
+    schedule_1,
+};
+
+const size_t schedule_lengths[] = {
+    sizeof(schedule_0) / sizeof(inst_t),
+    sizeof(schedule_1) / sizeof(inst_t),
+};
+
+const size_t num_schedules = 2;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
+const size_t num_counters = 1;
@@ -0,0 +1,28 @@
+/**
+ * @brief A malformed schedule that the verifier must reject: a BIT jumps past the end of the schedule.
+ */
+
+#include <stddef.h> // size_t
+#include "../core/threaded/scheduler_instructions.h"
+
+
+const inst_t schedule_0[] = {
+    {.op=BIT,   .rs1=4,     .rs2=-1},       // BIT if timeout, jump to line 4, of 4.
+    {.op=EXE,   .rs1=0,     .rs2=-1},       // EXE reaction 0
+    {.op=ADV,   .rs1=0,     .rs2=1000000},  // ADV reactor 0, 1000000
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+};
+
+const inst_t* static_schedules[] = {
+    schedule_0,
+};
+
+const size_t schedule_lengths[] = {
+    sizeof(schedule_0) / sizeof(inst_t),
+};
+
+const size_t num_schedules = 1;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
+const size_t num_counters = 0;
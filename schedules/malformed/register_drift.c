@@ -0,0 +1,32 @@
+/**
+ * @brief A malformed schedule that the verifier must reject: register 0 grows by one every epoch, so later epochs would take another path.
+ */
+
+#include <stddef.h> // size_t
+#include "../core/threaded/scheduler_instructions.h"
+
+
+const inst_t schedule_0[] = {
+    {.op=BIT,   .rs1=7,     .rs2=-1},       // BIT if timeout, jump to line 7.
+    {.op=BNE,   .rs1=3,     .rs2=0},        // BNE to line 3 if register 0 is not 0
+    {.op=EXE,   .rs1=0,     .rs2=-1},       // EXE reaction 0, only in the first epoch
+    {.op=EXE,   .rs1=1,     .rs2=-1},       // EXE reaction 1
+    {.op=ADDI,  .rs1=0,     .rs2=1},        // ADDI register 0 += 1, never undone
+    {.op=SAC,   .rs1=-1,    .rs2=-1},       // Sync all workers
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t* static_schedules[] = {
+    schedule_0,
+};
+
+const size_t schedule_lengths[] = {
+    sizeof(schedule_0) / sizeof(inst_t),
+};
+
+const size_t num_schedules = 1;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
+const size_t num_counters = 0;
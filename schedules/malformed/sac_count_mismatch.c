@@ -0,0 +1,41 @@
+/**
+ * @brief A malformed schedule that the verifier must reject: worker 0 reaches SAC twice per hyperperiod and worker 1 once.
+ */
+
+#include <stddef.h> // size_t
+#include "../core/threaded/scheduler_instructions.h"
+
+
+const inst_t schedule_0[] = {
+    {.op=BIT,   .rs1=6,     .rs2=-1},       // BIT if timeout, jump to line 6.
+    {.op=EXE,   .rs1=0,     .rs2=-1},       // EXE reaction 0
+    {.op=SAC,   .rs1=-1,    .rs2=-1},       // Sync all workers
+    {.op=EXE,   .rs1=1,     .rs2=-1},       // EXE reaction 1
+    {.op=SAC,   .rs1=-1,    .rs2=-1},       // Sync all workers, which worker 1 never does again
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t schedule_1[] = {
+    {.op=BIT,   .rs1=4,     .rs2=-1},       // BIT if timeout, jump to line 4.
+    {.op=EXE,   .rs1=2,     .rs2=-1},       // EXE reaction 2
+    {.op=SAC,   .rs1=-1,    .rs2=-1},       // Sync all workers
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t* static_schedules[] = {
+    schedule_0,
+    schedule_1,
+};
+
+const size_t schedule_lengths[] = {
+    sizeof(schedule_0) / sizeof(inst_t),
+    sizeof(schedule_1) / sizeof(inst_t),
+};
+
+const size_t num_schedules = 2;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
+const size_t num_counters = 0;
@@ -0,0 +1,51 @@
+/**
+ * @brief A malformed schedule that the verifier must reject: the loops do
+ * not end with SAC, and worker 2 waits for counter 0, which workers 0 and 1
+ * both increment. Worker 0 can run an epoch ahead and release the WU of
+ * worker 2 before worker 1 has run.
+ */
+
+#include <stddef.h> // size_t
+#include "../core/threaded/scheduler_instructions.h"
+
+const inst_t schedule_0[] = {
+    {.op=BIT,   .rs1=4,     .rs2=-1},       // BIT if timeout, jump to line 4.
+    {.op=EXE,   .rs1=0,     .rs2=-1},       // EXE reaction 0
+    {.op=INC,   .rs1=0,     .rs2=1},        // INC counter 0 by 1
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t schedule_1[] = {
+    {.op=BIT,   .rs1=4,     .rs2=-1},       // BIT if timeout, jump to line 4.
+    {.op=EXE,   .rs1=1,     .rs2=-1},       // EXE reaction 1
+    {.op=INC,   .rs1=0,     .rs2=1},        // INC counter 0 by 1
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t schedule_2[] = {
+    {.op=BIT,   .rs1=4,     .rs2=-1},       // BIT if timeout, jump to line 4.
+    {.op=WU,    .rs1=0,     .rs2=2},        // WU  counter 0 reaches 2
+    {.op=EXE,   .rs1=2,     .rs2=-1},       // EXE reaction 2
+    {.op=JMP,   .rs1=0,     .rs2=-1},       // JMP to line 0
+    {.op=STP,   .rs1=-1,    .rs2=-1},       // STP
+};
+
+const inst_t* static_schedules[] = {
+    schedule_0,
+    schedule_1,
+    schedule_2,
+};
+
+const size_t schedule_lengths[] = {
+    sizeof(schedule_0) / sizeof(inst_t),
+    sizeof(schedule_1) / sizeof(inst_t),
+    sizeof(schedule_2) / sizeof(inst_t),
+};
+
+const size_t num_schedules = 3;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
+const size_t num_counters = 1;
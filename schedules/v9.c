@@ -50,10 +50,15 @@ const inst_t* static_schedules[] = {
     schedule_1,
 };
 
-volatile uint32_t counters[] = {
-    0
+const size_t schedule_lengths[] = {
+    sizeof(schedule_0) / sizeof(inst_t),
+    sizeof(schedule_1) / sizeof(inst_t),
 };
 
+const size_t num_schedules = 2;
+
+const wait_policy_t wait_policy = WAIT_HYBRID;
+
 // Note: there would be a race condition if the threads are not keeping track of
 // its own hyperperiod.
 volatile uint32_t hyperperiod_iterations[] = {
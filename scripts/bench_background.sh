@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+
+# Compare how precisely DU releases the workers of the FS scheduler without
+# background jobs and with background jobs of a given cost in the slack
+# before each release, and how much of the slack the jobs reclaim.
+# Usage: bench_background.sh [hyperperiods] [period in us] [background job in us]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-1000}
+PERIOD_US=${2:-1000}
+JOB_US=${3:-100}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release -DFS_RELEASE_STATS=1"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_background $FLAGS
+cmake --build $ROOT_DIR/build_bench_background -j --target fs_release_bench
+
+for job in 0 $JOB_US; do
+    $ROOT_DIR/build_bench_background/benchmarks/fs_release_bench 2 $HYPERPERIODS $PERIOD_US $job
+done
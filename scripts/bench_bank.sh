@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+
+# Compare the schedule file size and load time of a bank of identical
+# reactors written as one template with bases per member against a copy of
+# the instructions per member, for a range of bank sizes.
+# Usage: bench_bank.sh [reactions per member]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+REACTIONS=${1:-8}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_bank $FLAGS
+cmake --build $ROOT_DIR/build_bench_bank -j --target fs_bank_bench
+
+for members in 10 100 1000; do
+    for layout in template copies; do
+        $ROOT_DIR/build_bench_bank/benchmarks/fs_bank_bench $layout $members $REACTIONS
+    done
+done
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+# Measure the time per SAC of the FS scheduler against the number of workers.
+# With the hybrid policy, workers only spin if every worker has a core of its
+# own; otherwise they sleep right away.
+# Usage: bench_barrier.sh [hyperperiods] [spin|hybrid|block]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-100000}
+POLICY=${2:-hybrid}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_barrier $FLAGS
+cmake --build $ROOT_DIR/build_bench_barrier -j --target fs_barrier_bench
+
+for workers in 1 2 4 8 16 32; do
+    $ROOT_DIR/build_bench_barrier/benchmarks/fs_barrier_bench $workers $HYPERPERIODS $POLICY
+done
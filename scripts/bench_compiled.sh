@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+
+# Compare the FS scheduler interpreting every schedule in schedules/ with the
+# same schedules compiled to C ahead of time.
+# Usage: bench_compiled.sh [hyperperiods]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-100000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_interpreted $FLAGS -DFS_THREADED_DISPATCH=1
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_compiled $FLAGS -DFS_COMPILED=ON
+
+for build in interpreted compiled; do
+    cmake --build $ROOT_DIR/build_bench_$build -j
+    for v in 1 2 3 4 5 6 7 8 9 10; do
+        $ROOT_DIR/build_bench_$build/benchmarks/fs_dispatch_bench_v$v $HYPERPERIODS
+    done
+done
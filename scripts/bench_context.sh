@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+
+# Compare worker contexts that each start on a pair of cache lines of their
+# own (the default) with contexts packed into one array, against the number
+# of workers, using workers of the FS scheduler that never synchronize.
+# Usage: bench_context.sh [hyperperiods]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-1000000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_context_aligned $FLAGS
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_context_packed $FLAGS -DFS_CONTEXT_ALIGNMENT=8
+
+for layout in aligned packed; do
+    cmake --build $ROOT_DIR/build_bench_context_$layout -j --target fs_context_bench
+    for workers in 2 4 8 16 32; do
+        $ROOT_DIR/build_bench_context_$layout/benchmarks/fs_context_bench $workers $HYPERPERIODS
+    done
+done
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+
+# Compare counters that each have a cache line of their own (the default) with
+# counters packed into shared cache lines, using the eight-worker counter
+# stress test of the FS scheduler, both with a SAC per hyperperiod and
+# pipelined without one.
+# Usage: bench_counters.sh [hyperperiods]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-100000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_counters_aligned $FLAGS
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_counters_packed $FLAGS -DFS_COUNTER_ALIGNMENT=8
+
+for layout in aligned packed; do
+    cmake --build $ROOT_DIR/build_bench_counters_$layout -j --target fs_counter_stress
+    $ROOT_DIR/build_bench_counters_$layout/benchmarks/fs_counter_stress $HYPERPERIODS
+    $ROOT_DIR/build_bench_counters_$layout/benchmarks/fs_counter_stress $HYPERPERIODS pipelined
+done
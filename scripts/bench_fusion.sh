@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+
+# Compare the FS scheduler with and without superinstructions on every
+# schedule in schedules/, with both dispatch engines. `dispatches` and
+# `returns` in the output are the instructions dispatched and the reactions
+# handed back to the worker loop.
+# Usage: bench_fusion.sh [hyperperiods]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-100000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_unfused_switch $FLAGS -DFS_FUSE=0
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_fused_switch $FLAGS -DFS_FUSE=1
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_unfused_threaded $FLAGS -DFS_FUSE=0 -DFS_THREADED_DISPATCH=1
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_fused_threaded $FLAGS -DFS_FUSE=1 -DFS_THREADED_DISPATCH=1
+
+for build in unfused_switch fused_switch unfused_threaded fused_threaded; do
+    cmake --build $ROOT_DIR/build_bench_$build -j
+    for v in 1 2 3 4 5 6 7 8 9 10; do
+        $ROOT_DIR/build_bench_$build/benchmarks/fs_dispatch_bench_v$v $HYPERPERIODS
+    done
+done
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+# Time fs_schedule_generate on random layered reaction graphs of growing size
+# (see gen_graph.sh).
+# Usage: bench_generate.sh [workers]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+WORKERS=${1:-8}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_generate $FLAGS
+cmake --build $ROOT_DIR/build_bench_generate -j --target fs_schedule_generate
+
+for reactions in 100 1000 5000; do
+    $SCRIPT_DIR/gen_graph.sh $reactions 1 > /tmp/fs_generate_$reactions.tg
+    $ROOT_DIR/build_bench_generate/tools/fs_schedule_generate /tmp/fs_generate_$reactions.tg \
+        /tmp/fs_generate_$reactions.lfs $WORKERS
+done
@@ -0,0 +1,27 @@
+#!/usr/bin/env bash
+
+# Measure what the reactions of inactive modes cost the FS scheduler when
+# each mode is a schedule segment that BNM skips, against polling every
+# reaction with EIT, and check that the mode transitions take effect at the
+# next hyperperiod.
+# Usage: bench_modes.sh [hyperperiods] [modes] [reactions per mode] [switch every]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-100000}
+MODES=${2:-4}
+REACTIONS=${3:-8}
+SWITCH_EVERY=${4:-10}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release -DMODAL_REACTORS=1"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_modes $FLAGS
+cmake --build $ROOT_DIR/build_bench_modes -j --target fs_mode_bench
+
+for workers in 1 2; do
+    for variant in eit bnm; do
+        $ROOT_DIR/build_bench_modes/benchmarks/fs_mode_bench $variant $workers $HYPERPERIODS $MODES $REACTIONS $SWITCH_EVERY
+    done
+done
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+
+# Compare how precisely DU releases the workers of the FS scheduler when they
+# run where the OS puts them with when they are pinned to CPUs 0 and 1, and
+# when they also run at real-time priority 50 with the memory locked. What
+# the OS does not grant, e.g., a real-time priority in an unprivileged
+# container, is reported with a warning.
+# Usage: bench_placement.sh [hyperperiods] [period in us]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-1000}
+PERIOD_US=${2:-1000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release -DFS_RELEASE_STATS=1"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_placement $FLAGS
+cmake --build $ROOT_DIR/build_bench_placement -j --target fs_release_bench
+
+$ROOT_DIR/build_bench_placement/benchmarks/fs_release_bench 2 $HYPERPERIODS $PERIOD_US 0
+$ROOT_DIR/build_bench_placement/benchmarks/fs_release_bench 2 $HYPERPERIODS $PERIOD_US 0 0,1
+$ROOT_DIR/build_bench_placement/benchmarks/fs_release_bench 2 $HYPERPERIODS $PERIOD_US 0 0,1 50 1
@@ -0,0 +1,22 @@
+#!/usr/bin/env bash
+
+# Compare how precisely DU releases the workers of the FS scheduler when they
+# sleep until the release time with when they spin for the last 50 us.
+# Usage: bench_release.sh [hyperperiods] [period in us]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+HYPERPERIODS=${1:-1000}
+PERIOD_US=${2:-1000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release -DFS_RELEASE_STATS=1"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_release_sleep $FLAGS
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_release_spin $FLAGS -DFS_DU_SPIN_NS=50000
+
+for mode in sleep spin; do
+    cmake --build $ROOT_DIR/build_bench_release_$mode -j --target fs_release_bench
+    $ROOT_DIR/build_bench_release_$mode/benchmarks/fs_release_bench 2 $HYPERPERIODS $PERIOD_US
+done
@@ -0,0 +1,39 @@
+#!/usr/bin/env bash
+
+# Generate schedules for a random layered reaction graph (see gen_graph.sh,
+# as in bench_generate.sh) for a range of worker counts and simulate each with
+# reaction times drawn around the WCETs, to compare their makespans and
+# check that every DU is reached in time.
+# Usage: bench_simulate.sh [reactions] [hyperperiods]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+REACTIONS=${1:-1000}
+HYPERPERIODS=${2:-1000}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_simulate $FLAGS
+cmake --build $ROOT_DIR/build_bench_simulate -j --target fs_schedule_generate fs_schedule_simulate
+
+GRAPH=/tmp/fs_simulate_$REACTIONS.tg
+MODEL=/tmp/fs_simulate_$REACTIONS.model
+$SCRIPT_DIR/gen_graph.sh $REACTIONS 1 > $GRAPH
+
+# Reactions take between half their WCET and all of it, and every
+# instruction and wakeup costs a little.
+awk '$1 == "reaction" {
+    wcet = $4; sub(/us$/, "", wcet)
+    print "wcet", $2, "uniform", int(wcet * 500) "ns", wcet "us"
+}
+END { print "overhead 50ns"; print "wakeup 5us" }' $GRAPH > $MODEL
+cat $GRAPH >> $MODEL
+
+for workers in 1 2 4 8 16; do
+    $ROOT_DIR/build_bench_simulate/tools/fs_schedule_generate $GRAPH /tmp/fs_simulate_w$workers.lfs $workers
+    # Exits with 2 if a DU is reached late, which is a result here.
+    $ROOT_DIR/build_bench_simulate/tools/fs_schedule_simulate /tmp/fs_simulate_w$workers.lfs $MODEL $HYPERPERIODS \
+        | sed -n 1p || true
+done
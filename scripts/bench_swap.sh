@@ -0,0 +1,23 @@
+#!/usr/bin/env bash
+
+# Measure what it costs to switch the FS scheduler between a normal and a
+# degraded schedule set while it runs, and whether the periodic reactions
+# keep their timing across the switches, against a run without switches.
+# Usage: bench_swap.sh [periods] [period in us] [swap every]
+
+set -euxo pipefail
+
+SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+PERIODS=${1:-1000}
+PERIOD_US=${2:-1000}
+SWAP_EVERY=${3:-10}
+
+FLAGS="-DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release"
+
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_bench_swap $FLAGS
+cmake --build $ROOT_DIR/build_bench_swap -j --target fs_swap_bench
+
+for every in $((PERIODS * 2)) $SWAP_EVERY; do
+    $ROOT_DIR/build_bench_swap/benchmarks/fs_swap_bench 2 $PERIODS $PERIOD_US $every
+done
@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+
+# Print a random layered reaction graph in the format of
+# fs_schedule_generate. The graph has 10 layers of reactions, one reactor per
+# 4 reactions, periods of 10, 20, and 50 ms on the first layer, WCETs of 1 to
+# 9 us, and 2 random edges into every reaction of the other layers from the
+# layer before it. The same arguments always give the same graph.
+# Usage: gen_graph.sh <reactions> [seed]
+
+set -euo pipefail
+
+awk -v n=$1 -v seed=${2:-1} 'BEGIN {
+    srand(seed)
+    width = int(n / 10)
+    for (x = 0; x < n / 4; x++) print "reactor r" x
+    split("10ms 20ms 50ms", periods, " ")
+    for (i = 0; i < n; i++) {
+        wcet = 1 + int(rand() * 9) "us"
+        if (i < width) print "reaction n" i, "r" int(i / 4), wcet, periods[i % 3 + 1]
+        else print "reaction n" i, "r" int(i / 4), wcet
+    }
+    for (i = width; i < n; i++) {
+        layer = int(i / width)
+        for (e = 0; e < 2; e++) print "edge n" ((layer - 1) * width + int(rand() * width)), "n" i
+    }
+}'
@@ -1,11 +1,17 @@
 #!/usr/bin/env bash
 
+# Profile the FS scheduler with its built-in per-instruction profiler
+# (FS_PROFILE). The program prints an annotated listing of every worker's
+# schedule when it exits, including when it is stopped with Ctrl-C.
+# Usage: profile.sh [seconds]
+
 set -euxo pipefail
 
 SCRIPT_DIR=$( cd -- "$( dirname -- "${BASH_SOURCE[0]}" )" &> /dev/null && pwd )
+ROOT_DIR=$SCRIPT_DIR/..
+SECONDS_TO_RUN=${1:-60}
 
-$SCRIPT_DIR/clean.sh
-$SCRIPT_DIR/rebuild.sh
-### perf (great for multithreaded program)
-sudo perf record -g --user-callchains -F max -- $SCRIPT_DIR/../build/ScheduleTest -o 1 minute
-$SCRIPT_DIR/gen_report.sh
+cmake -S $ROOT_DIR -B $ROOT_DIR/build_profile -DLF_REACTION_GRAPH_BREADTH=3 -DLF_THREADED=1 -DNUMBER_OF_WORKERS=2 -DSCHEDULER=FS -DLOG_LEVEL=LOG_LEVEL_INFO -DCMAKE_BUILD_TYPE=Release -DFS_PROFILE=1
+cmake --build $ROOT_DIR/build_profile -j --target ScheduleTest
+# SIGINT makes the program exit, which prints the profile.
+timeout -s INT --preserve-status $SECONDS_TO_RUN $ROOT_DIR/build_profile/ScheduleTest || true
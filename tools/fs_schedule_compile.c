@@ -0,0 +1,302 @@
+/**
+ * @file fs_schedule_compile.c
+ * @brief Compile a schedule file to C ahead of time.
+ *
+ * Writes one C function per worker that does what the FS scheduler would do
+ * when interpreting the worker's schedule (see scheduler_compiled.h):
+ * reactions are run directly, counters, tags, waits, and SAC become calls
+ * into the runtime, registers become locals, and the branches become
+ * conditional gotos. A JMP backwards whose range nests with those of the
+ * other backward JMPs becomes a loop; any other jump becomes a goto.
+ * Reaction and reactor operands are resolved through the bases and tables of
+ * the file, so the output indexes the reaction and reactor arrays of the
+ * program directly, and a WU in the worker's loop waits for its value plus
+ * the base of its counter (see `static_schedule_counter_offsets()`), as the
+ * scheduler decodes it. Workers that share a template get a function each.
+ *
+ * The schedules are verified first, and the output records their
+ * fingerprint, which the runtime compares with that of the schedule it
+ * loads. To compile one of `schedules/v*.c`, convert it with
+ * `fs_schedule_convert_vN` first.
+ *
+ * Usage: fs_schedule_compile <input file> <output file>
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "static_schedule_file.h"
+#include "static_schedule_verify.h"
+
+/** The names of the opcodes that can appear in a schedule. */
+static const char* const opcode_names[] = {
+    [ADV]   = "ADV",
+    [ADV2]  = "ADV2",
+    [BIT]   = "BIT",
+    [DU]    = "DU",
+    [EIT]   = "EIT",
+    [EXE]   = "EXE",
+    [INC]   = "INC",
+    [INC2]  = "INC2",
+    [JMP]   = "JMP",
+    [SAC]   = "SAC",
+    [STP]   = "STP",
+    [WU]    = "WU",
+    [ADDI]  = "ADDI",
+    [BEQ]   = "BEQ",
+    [BNE]   = "BNE",
+    [BLT]   = "BLT",
+    [BNT]   = "BNT",
+    [SRV]   = "SRV",
+    [BNM]   = "BNM",
+};
+
+/**
+ * @brief How one worker's schedule is laid out as C.
+ */
+typedef struct {
+    size_t*     loop_opens;     // Loops that start at each line.
+    bool*       is_loop_end;    // Whether the JMP at a line closes a loop.
+    bool*       needs_label;    // Whether a line, or the end, is the target of a goto.
+    size_t      epoch_end;      // The JMP that starts a new epoch, or STATIC_SCHEDULE_NO_LOOP.
+    size_t      exit;           // Where a WU goes if the worker stops, or SIZE_MAX.
+} layout_t;
+
+/**
+ * @brief Decide which backward JMPs become loops and which lines need a
+ * label.
+ *
+ * Backward JMPs are considered in the order they appear, and one becomes a
+ * loop if its range [target, JMP] is either disjoint from or nested in the
+ * range of every loop so far, so that the braces of the loops nest. The
+ * target of the BIT at the start of the first one is where a WU goes if the
+ * worker stops.
+ */
+static void lay_out(const inst_t* schedule, size_t length, layout_t* layout) {
+    layout->loop_opens = calloc(length + 1, sizeof(size_t));
+    layout->is_loop_end = calloc(length + 1, sizeof(bool));
+    layout->needs_label = calloc(length + 1, sizeof(bool));
+    if (layout->loop_opens == NULL || layout->is_loop_end == NULL || layout->needs_label == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        exit(1);
+    }
+    layout->epoch_end = static_schedule_loop_end(schedule, length);
+    layout->exit = SIZE_MAX;
+    if (layout->epoch_end != STATIC_SCHEDULE_NO_LOOP) {
+        const inst_t* head = &schedule[schedule[layout->epoch_end].rs1];
+        if (head->op == BIT) {
+            layout->exit = (size_t)head->rs1;
+            layout->needs_label[layout->exit] = true;
+        }
+    }
+    for (size_t pc = 0; pc < length; pc++) {
+        if (!inst_is_branch(schedule[pc].op)) continue;
+        size_t target = (size_t)schedule[pc].rs1;
+        bool loop = schedule[pc].op == JMP && target <= pc;
+        for (size_t end = 0; loop && end < pc; end++) {
+            if (!layout->is_loop_end[end]) continue;
+            size_t start = (size_t)schedule[end].rs1;
+            bool disjoint = end < target;
+            bool nested = start >= target;
+            loop = disjoint || nested;
+        }
+        if (loop) {
+            layout->is_loop_end[pc] = true;
+            layout->loop_opens[target]++;
+        } else {
+            layout->needs_label[target] = true;
+        }
+    }
+}
+
+static void lay_out_free(layout_t* layout) {
+    free(layout->loop_opens);
+    free(layout->is_loop_end);
+    free(layout->needs_label);
+}
+
+/**
+ * @brief Write the function that runs the schedule of one worker.
+ */
+static void compile_worker(FILE* out, const static_schedule_t* schedule, const unsigned long long* base,
+                           size_t worker) {
+    const inst_t* insts = schedule->schedules[worker];
+    size_t length = schedule->schedule_lengths[worker];
+    layout_t layout;
+    lay_out(insts, length, &layout);
+    size_t loop_head = layout.epoch_end == STATIC_SCHEDULE_NO_LOOP ? length : (size_t)insts[layout.epoch_end].rs1;
+
+    fprintf(out, "static void worker_%zu(size_t worker_number, reaction_t* const* reactions, "
+                 "self_base_t* const* reactors) {\n", worker);
+    fprintf(out, "    int iteration = 0;\n");
+    fprintf(out, "    (void)iteration;\n");
+    fprintf(out, "    long long int registers[%d] = { 0 };\n", INST_NUM_REGISTERS);
+    fprintf(out, "    (void)registers;\n");
+    int depth = 1;
+    for (size_t pc = 0; pc <= length; pc++) {
+        if (layout.needs_label[pc]) {
+            fprintf(out, "line_%zu:;\n", pc);
+        }
+        for (size_t i = 0; i < layout.loop_opens[pc]; i++) {
+            fprintf(out, "%*sfor (;;) {\n", 4 * depth, "");
+            depth++;
+        }
+        if (pc == length) break;
+
+        const inst_t* inst = &insts[pc];
+        long long int rs1 = inst->rs1;
+        long long int rs2 = inst->rs2;
+        if (inst->op == EXE || inst->op == EIT) {
+            rs1 = (long long int)static_schedule_reaction_index(schedule, worker, rs1);
+        } else if (inst->op == BNT || inst->op == BNM) {
+            rs2 = (long long int)static_schedule_reaction_index(schedule, worker, rs2);
+        } else if (inst->op == ADV || inst->op == ADV2) {
+            rs1 = (long long int)static_schedule_reactor_index(schedule, worker, rs1);
+        }
+        int indent = 4 * depth;
+        fprintf(out, "%*s// %zu: %s %lld, %lld\n", indent, "", pc, opcode_names[inst->op],
+                inst->rs1, inst->rs2);
+        switch (inst->op) {
+            case ADV:
+            case ADV2:
+                fprintf(out, "%*slf_sched_compiled_advance(reactors[%lld], %lldLL, %s);\n", indent, "",
+                        rs1, rs2, inst->op == ADV2 ? "true" : "false");
+                break;
+            case BIT:
+                fprintf(out, "%*sif (lf_sched_compiled_timeout_reached(worker_number)) goto line_%lld;\n",
+                        indent, "", rs1);
+                break;
+            case DU:
+                fprintf(out, "%*slf_sched_compiled_delay_until(worker_number, %lldLL, %lldLL, iteration);\n",
+                        indent, "", rs1, rs2);
+                break;
+            case EIT:
+                fprintf(out, "%*sif (reactions[%lld]->status == queued) "
+                             "lf_sched_compiled_execute(worker_number, reactions[%lld]);\n",
+                        indent, "", rs1, rs1);
+                break;
+            case EXE:
+                fprintf(out, "%*slf_sched_compiled_execute(worker_number, reactions[%lld]);\n", indent, "", rs1);
+                break;
+            case INC:
+            case INC2:
+                fprintf(out, "%*slf_sched_compiled_increment(%lld, %lldLL, %s);\n", indent, "",
+                        rs1, rs2, inst->op == INC2 ? "true" : "false");
+                break;
+            case JMP:
+                if (rs2 > 0) {
+                    fprintf(out, "%*siteration += %lld;\n", indent, "", rs2);
+                }
+                if (pc == layout.epoch_end) {
+                    fprintf(out, "%*slf_sched_compiled_end_epoch(worker_number);\n", indent, "");
+                }
+                if (layout.is_loop_end[pc]) {
+                    depth--;
+                    fprintf(out, "%*s}\n", 4 * depth, "");
+                } else {
+                    fprintf(out, "%*sgoto line_%lld;\n", indent, "", rs1);
+                }
+                break;
+            case SAC:
+                fprintf(out, "%*slf_sched_compiled_sync_and_clear(worker_number, %s);\n", indent, "",
+                        pc + 1 == layout.epoch_end ? "true" : "false");
+                break;
+            case STP:
+                fprintf(out, "%*sreturn;\n", indent, "");
+                break;
+            case WU:
+                if (pc >= loop_head) rs2 += (long long int)base[rs1];
+                if (layout.exit != SIZE_MAX) {
+                    fprintf(out, "%*sif (!lf_sched_compiled_wait_until(worker_number, %lld, %lldLL)) goto line_%zu;\n",
+                            indent, "", rs1, rs2, layout.exit);
+                } else {
+                    fprintf(out, "%*slf_sched_compiled_wait_until(worker_number, %lld, %lldLL);\n", indent, "",
+                            rs1, rs2);
+                }
+                break;
+            case ADDI:
+                // Wraps around like the interpreter (see `inst_add_immediate()`).
+                fprintf(out, "%*sregisters[%lld] = (long long int)((unsigned long long)registers[%lld] "
+                             "+ (unsigned long long)%lldLL);\n", indent, "", rs1, rs1, rs2);
+                break;
+            case BEQ:
+            case BNE:
+            case BLT:
+                fprintf(out, "%*sif (registers[%lld] %s 0) goto line_%lld;\n", indent, "", rs2,
+                        inst->op == BEQ ? "==" : inst->op == BNE ? "!=" : "<", rs1);
+                break;
+            case BNT:
+                fprintf(out, "%*sif (reactions[%lld]->status != queued) goto line_%lld;\n", indent, "", rs2, rs1);
+                break;
+            case BNM:
+                fprintf(out, "%*sif (!lf_sched_compiled_mode_is_active(reactions[%lld])) goto line_%lld;\n",
+                        indent, "", rs2, rs1);
+                break;
+            case SRV:
+                fprintf(out, "%*slf_sched_compiled_serve(worker_number, %lldLL);\n", indent, "", rs1);
+                break;
+            default:
+                break;
+        }
+    }
+    fprintf(out, "}\n\n");
+    lay_out_free(&layout);
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <input file> <output file>\n", argv[0]);
+        return 1;
+    }
+
+    static_schedule_t schedule;
+    const char* error;
+    if (static_schedule_map(argv[1], &schedule, &error) != 0) {
+        fprintf(stderr, "Cannot load %s: %s.\n", argv[1], error);
+        return 1;
+    }
+    int problems = static_schedule_verify(&schedule, 0, 0, static_schedule_print_problem, (void*)argv[1]);
+    if (problems > 0) {
+        fprintf(stderr, "%s: %d problem(s).\n", argv[1], problems);
+        static_schedule_unmap(&schedule);
+        return 1;
+    }
+
+    FILE* out = fopen(argv[2], "w");
+    if (out == NULL) {
+        fprintf(stderr, "Cannot create %s.\n", argv[2]);
+        static_schedule_unmap(&schedule);
+        return 1;
+    }
+    fprintf(out, "// Generated by fs_schedule_compile from %s. Do not edit.\n", argv[1]);
+    fprintf(out, "#include \"scheduler_compiled.h\"\n\n");
+    fprintf(out, "const size_t lf_sched_compiled_num_workers = %zu;\n", schedule.num_workers);
+    fprintf(out, "const uint32_t lf_sched_compiled_fingerprint = 0x%08xu;\n\n",
+            static_schedule_fingerprint(&schedule));
+    unsigned long long* base = malloc((schedule.num_counters + 1) * sizeof(unsigned long long));
+    unsigned long long* per_epoch = malloc((schedule.num_counters + 1) * sizeof(unsigned long long));
+    if (base == NULL || per_epoch == NULL) {
+        fprintf(stderr, "Out of memory.\n");
+        return 1;
+    }
+    static_schedule_counter_offsets(&schedule, base, per_epoch);
+    for (size_t i = 0; i < schedule.num_workers; i++) {
+        compile_worker(out, &schedule, base, i);
+    }
+    free(base);
+    free(per_epoch);
+    fprintf(out, "const lf_sched_compiled_worker_t lf_sched_compiled_workers[] = {\n");
+    for (size_t i = 0; i < schedule.num_workers; i++) {
+        fprintf(out, "    worker_%zu,\n", i);
+    }
+    fprintf(out, "};\n");
+
+    int status = 0;
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Cannot write %s.\n", argv[2]);
+        status = 1;
+    }
+    static_schedule_unmap(&schedule);
+    return status;
+}
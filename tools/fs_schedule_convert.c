@@ -0,0 +1,57 @@
+/**
+ * @file fs_schedule_convert.c
+ * @brief Write the static schedule compiled into this tool to a schedule file.
+ *
+ * The tool is linked with one of `schedules/v*.c`. The reaction and reactor
+ * tables of the file are identity tables that are just long enough to cover
+ * the operands that the schedule uses, so the file runs on any program whose
+ * reaction and reactor arrays have the layout the schedule was written for.
+ *
+ * Usage: fs_schedule_convert_vN <output file>
+ */
+#include <stdio.h>
+
+#include "scheduler_instructions.h"
+#include "static_schedule_file.h"
+
+extern const inst_t* static_schedules[];
+extern const size_t schedule_lengths[];
+extern const size_t num_schedules;
+extern const size_t num_counters;
+extern const wait_policy_t wait_policy;
+
+int main(int argc, const char* argv[]) {
+    if (argc != 2) {
+        fprintf(stderr, "Usage: %s <output file>\n", argv[0]);
+        return 1;
+    }
+
+    size_t num_reactions = 0;
+    size_t num_reactors = 0;
+    for (size_t i = 0; i < num_schedules; i++) {
+        for (size_t pc = 0; pc < schedule_lengths[i]; pc++) {
+            const inst_t* inst = &static_schedules[i][pc];
+            if ((inst->op == EXE || inst->op == EIT) && inst->rs1 >= (long long)num_reactions) {
+                num_reactions = inst->rs1 + 1;
+            } else if ((inst->op == ADV || inst->op == ADV2) && inst->rs1 >= (long long)num_reactors) {
+                num_reactors = inst->rs1 + 1;
+            }
+        }
+    }
+
+    static_schedule_t schedule = {
+        .num_workers = num_schedules,
+        .schedules = (const inst_t**)static_schedules,
+        .schedule_lengths = (size_t*)schedule_lengths,
+        .num_counters = num_counters,
+        .num_reactions = num_reactions,
+        .num_reactors = num_reactors,
+        .wait_policy = wait_policy,
+    };
+    const char* error;
+    if (static_schedule_write(argv[1], &schedule, &error) != 0) {
+        fprintf(stderr, "Cannot write %s: %s.\n", argv[1], error);
+        return 1;
+    }
+    return 0;
+}
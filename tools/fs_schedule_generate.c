@@ -0,0 +1,869 @@
+/**
+ * @file fs_schedule_generate.c
+ * @brief Generate static schedules for the FS scheduler from a description
+ * of the reaction graph of a program.
+ *
+ * The description is a text file with one declaration per line; `#` starts
+ * a comment, and times are nanoseconds unless they end in ns, us, ms, or s:
+ *
+ *     workers  <number>
+ *     sync     <time>                  # Cost of a WU between workers; default 0.
+ *     cpus     <cpu>,<cpu>,...         # The CPU of each worker; default none.
+ *     reactor  <name>
+ *     reaction <name> <reactor> <wcet> [<period> [<offset>]]
+ *     edge     <reaction> <reaction>   # A port from the first to the second.
+ *
+ * The reactions and reactors are numbered in the order they are declared,
+ * which is the layout of the reaction and reactor arrays that the schedules
+ * run on, and the reactions of a reactor are ordered by their declaration
+ * as well. A reaction with a period is triggered by a timer with that period
+ * and offset. Any reaction is also triggered at each tag at which a reaction
+ * upstream of it runs, in which case it runs with EIT, since the upstream
+ * reaction may not set its output.
+ *
+ * The hyperperiod is the least common multiple of the periods. Each reaction
+ * becomes one job per tag in the hyperperiod at which it may run. A job
+ * comes after:
+ * - the jobs upstream of it at the same tag;
+ * - the job of its reactor before it, at the same tag or an earlier one;
+ * - the jobs downstream of its reaction at earlier tags, so that it does
+ *   not overwrite an output that they still read.
+ * The jobs are list-scheduled in the manner of HEFT. Tag by tag, they are
+ * taken by decreasing upward rank, which is the WCET of the longest path
+ * from the job to the end of the hyperperiod. Each goes to the worker on
+ * which it would finish first, given when the worker is free, when its
+ * predecessors finish (plus `sync` on another worker), and when its tag is
+ * released.
+ *
+ * Each worker then gets a loop over the hyperperiod in which, for each of
+ * its jobs in the order assigned:
+ * - DU releases a timer-triggered job at its tag;
+ * - WU waits for the counter of every other worker that a predecessor ran on;
+ * - EXE or EIT runs the reaction;
+ * - ADV or ADV2 (if the reactor has one worker) advances the tag of the
+ *   reactor to that of its next job;
+ * - INC2 counts the job on the worker's own counter if a job on another
+ *   worker comes after it.
+ * The loop ends with SAC, so that no worker starts a hyperperiod before all
+ * others have finished the previous one. DU counts releases from 1 (see
+ * scheduler_instructions.h), so hyperperiod i starts i + 1 hyperperiods
+ * after the physical start time.
+ *
+ * The schedules are verified and written as a schedule file or, if the
+ * output file ends in .c, as C source in the form of `schedules/v*.c`. Only
+ * a schedule file records the CPUs (see worker_placement.h).
+ *
+ * Usage: fs_schedule_generate <description> <output file> [workers]
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scheduler_instructions.h"
+#include "static_schedule_file.h"
+#include "static_schedule_verify.h"
+
+#define NONE SIZE_MAX
+
+typedef struct {
+    char*           name;
+    size_t          first_job;      // In the order of the reactor's jobs, see `chain`.
+    size_t          worker;         // The only worker that runs its jobs, or NONE.
+    bool            has_jobs;
+} reactor_t;
+
+typedef struct {
+    char*           name;
+    char*           reactor_name;
+    size_t          reactor;
+    long long int   wcet;
+    long long int   period;         // 0 if no timer triggers it.
+    long long int   offset;
+    size_t*         upstream;
+    size_t          num_upstream;
+    long long int*  tags;           // The tags in the hyperperiod at which it may run, sorted.
+    size_t          num_tags;
+    size_t          first_job;      // Its job at tags[i] is first_job + i.
+} reaction_t;
+
+typedef struct {
+    size_t          reaction;
+    long long int   tag;
+    long long int   rank;
+    long long int   finish;
+    size_t          order;          // Position in a topological order of the jobs.
+    size_t          worker;
+    size_t          next;           // The next job of the reactor, or NONE.
+    long long int   count;          // The value of its worker's counter after it, or 0.
+} job_t;
+
+typedef struct {
+    size_t          from;
+    size_t          to;
+} edge_t;
+
+typedef struct {
+    size_t          workers;
+    long long int   sync;
+    int*            cpus;           // Of the first `num_cpus` workers.
+    size_t          num_cpus;
+    reactor_t*      reactors;
+    size_t          num_reactors;
+    reaction_t*     reactions;
+    size_t          num_reactions;
+    char**          edge_names;     // Pairs of reaction names.
+    size_t          num_edges;
+    long long int   hyperperiod;
+    job_t*          jobs;
+    size_t          num_jobs;
+    edge_t*         edges;          // Between jobs.
+    size_t          num_job_edges;
+    size_t*         succ_start;     // The successors of job j are succ[succ_start[j]..succ_start[j + 1]).
+    size_t*         succ;
+    size_t*         pred_start;
+    size_t*         pred;
+} graph_t;
+
+/** An array that grows as needed. */
+#define PUSH(array, length, capacity, value)                                        \
+    do {                                                                            \
+        if ((length) == (capacity)) {                                               \
+            (capacity) = (capacity) == 0 ? 16 : 2 * (capacity);                     \
+            (array) = realloc((array), (capacity) * sizeof(*(array)));              \
+            if ((array) == NULL) fail("out of memory");                             \
+        }                                                                           \
+        (array)[(length)++] = (value);                                              \
+    } while (0)
+
+static const char* input_path;
+static size_t input_line;
+
+static void fail(const char* message) {
+    if (input_line > 0) {
+        fprintf(stderr, "%s:%zu: %s.\n", input_path, input_line, message);
+    } else {
+        fprintf(stderr, "%s: %s.\n", input_path, message);
+    }
+    exit(1);
+}
+
+static char* copy(const char* s) {
+    char* result = strdup(s);
+    if (result == NULL) fail("out of memory");
+    return result;
+}
+
+static long long int parse_time(const char* s) {
+    char* end;
+    long long int value = strtoll(s, &end, 10);
+    long long int unit = 1;
+    if (strcmp(end, "us") == 0) unit = 1000LL;
+    else if (strcmp(end, "ms") == 0) unit = 1000000LL;
+    else if (strcmp(end, "s") == 0) unit = 1000000000LL;
+    else if (*end != '\0' && strcmp(end, "ns") != 0) fail("invalid time");
+    if (end == s || value < 0 || value > INT64_MAX / unit) fail("invalid time");
+    return value * unit;
+}
+
+static void parse(graph_t* g, FILE* in) {
+    size_t reactor_capacity = 0, reaction_capacity = 0, edge_capacity = 0;
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        input_line++;
+        char* comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+        char* words[8];
+        size_t n = 0;
+        for (char* word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+            if (n == 8) fail("too many words");
+            words[n++] = word;
+        }
+        if (n == 0) continue;
+        if (strcmp(words[0], "workers") == 0 && n == 2) {
+            g->workers = strtoull(words[1], NULL, 10);
+        } else if (strcmp(words[0], "sync") == 0 && n == 2) {
+            g->sync = parse_time(words[1]);
+        } else if (strcmp(words[0], "cpus") == 0 && n == 2) {
+            size_t cpus_capacity = 0;
+            g->num_cpus = 0;
+            for (char* cpu = strtok(words[1], ","); cpu != NULL; cpu = strtok(NULL, ",")) {
+                char* end;
+                long value = strtol(cpu, &end, 10);
+                if (end == cpu || *end != '\0' || value < 0 || value > 0xFFFF) fail("a CPU must be a number");
+                PUSH(g->cpus, g->num_cpus, cpus_capacity, (int)value);
+            }
+        } else if (strcmp(words[0], "reactor") == 0 && n == 2) {
+            reactor_t reactor = { .name = copy(words[1]), .worker = NONE };
+            PUSH(g->reactors, g->num_reactors, reactor_capacity, reactor);
+        } else if (strcmp(words[0], "reaction") == 0 && n >= 4 && n <= 6) {
+            reaction_t reaction = {
+                .name = copy(words[1]),
+                .reactor_name = copy(words[2]),
+                .wcet = parse_time(words[3]),
+                .period = n > 4 ? parse_time(words[4]) : 0,
+                .offset = n > 5 ? parse_time(words[5]) : 0,
+            };
+            if (n > 4 && reaction.period == 0) fail("a period must be positive");
+            if (reaction.offset >= reaction.period && reaction.period > 0) fail("an offset must be below the period");
+            PUSH(g->reactions, g->num_reactions, reaction_capacity, reaction);
+        } else if (strcmp(words[0], "edge") == 0 && n == 3) {
+            PUSH(g->edge_names, g->num_edges, edge_capacity, copy(words[1]));
+            PUSH(g->edge_names, g->num_edges, edge_capacity, copy(words[2]));
+        } else {
+            fail("unknown declaration");
+        }
+    }
+    g->num_edges /= 2;
+    input_line = 0;
+}
+
+///////////////////////////// Names /////////////////////////////
+
+typedef struct {
+    const char*     name;
+    size_t          index;
+} name_t;
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(((const name_t*)a)->name, ((const name_t*)b)->name);
+}
+
+/** Sort `count` names for `lookup()`, failing on duplicates. */
+static name_t* index_names(size_t count, const char* (*get)(const graph_t*, size_t), const graph_t* g,
+                           const char* what) {
+    name_t* names = malloc((count + 1) * sizeof(name_t));
+    if (names == NULL) fail("out of memory");
+    for (size_t i = 0; i < count; i++) names[i] = (name_t) { get(g, i), i };
+    qsort(names, count, sizeof(name_t), compare_names);
+    for (size_t i = 1; i < count; i++) {
+        if (strcmp(names[i - 1].name, names[i].name) == 0) {
+            fprintf(stderr, "%s: %s %s is declared twice.\n", input_path, what, names[i].name);
+            exit(1);
+        }
+    }
+    return names;
+}
+
+static size_t lookup(const name_t* names, size_t count, const char* name, const char* what) {
+    name_t key = { name, 0 };
+    const name_t* found = bsearch(&key, names, count, sizeof(name_t), compare_names);
+    if (found == NULL) {
+        fprintf(stderr, "%s: unknown %s %s.\n", input_path, what, name);
+        exit(1);
+    }
+    return found->index;
+}
+
+static const char* reactor_name(const graph_t* g, size_t i) { return g->reactors[i].name; }
+static const char* reaction_name(const graph_t* g, size_t i) { return g->reactions[i].name; }
+
+static void resolve(graph_t* g) {
+    name_t* reactors = index_names(g->num_reactors, reactor_name, g, "reactor");
+    name_t* reactions = index_names(g->num_reactions, reaction_name, g, "reaction");
+    for (size_t r = 0; r < g->num_reactions; r++) {
+        g->reactions[r].reactor = lookup(reactors, g->num_reactors, g->reactions[r].reactor_name, "reactor");
+    }
+    size_t* counts = calloc(g->num_reactions + 1, sizeof(size_t));
+    size_t* ends = malloc(2 * g->num_edges * sizeof(size_t) + 1);
+    if (counts == NULL || ends == NULL) fail("out of memory");
+    for (size_t e = 0; e < 2 * g->num_edges; e++) {
+        ends[e] = lookup(reactions, g->num_reactions, g->edge_names[e], "reaction");
+    }
+    for (size_t e = 0; e < g->num_edges; e++) counts[ends[2 * e + 1]]++;
+    for (size_t r = 0; r < g->num_reactions; r++) {
+        g->reactions[r].upstream = malloc((counts[r] + 1) * sizeof(size_t));
+        if (g->reactions[r].upstream == NULL) fail("out of memory");
+    }
+    for (size_t e = 0; e < g->num_edges; e++) {
+        reaction_t* to = &g->reactions[ends[2 * e + 1]];
+        to->upstream[to->num_upstream++] = ends[2 * e];
+    }
+    free(counts);
+    free(ends);
+    free(reactors);
+    free(reactions);
+}
+
+///////////////////////////// Jobs /////////////////////////////
+
+static long long int gcd(long long int a, long long int b) {
+    while (b != 0) {
+        long long int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+static int compare_tags(const void* a, const void* b) {
+    long long int x = *(const long long int*)a, y = *(const long long int*)b;
+    return (x > y) - (x < y);
+}
+
+/** The index of the first tag of `r` that is at least (or, if `after`, above) `tag`. */
+static size_t find_tag(const reaction_t* r, long long int tag, bool after) {
+    size_t low = 0, high = r->num_tags;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        if (r->tags[mid] < tag || (after && r->tags[mid] == tag)) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+static bool timer_tag(const reaction_t* r, long long int tag) {
+    return r->period > 0 && tag >= r->offset && (tag - r->offset) % r->period == 0;
+}
+
+/** Find the tags at which each reaction may run, in a topological order of the reactions. */
+static void find_tags(graph_t* g) {
+    g->hyperperiod = 0;
+    for (size_t r = 0; r < g->num_reactions; r++) {
+        long long int period = g->reactions[r].period;
+        if (period == 0) continue;
+        if (g->hyperperiod == 0) {
+            g->hyperperiod = period;
+        } else {
+            long long int factor = period / gcd(g->hyperperiod, period);
+            if (g->hyperperiod > INT64_MAX / 4 / factor) fail("the hyperperiod is too long");
+            g->hyperperiod *= factor;
+        }
+    }
+    if (g->hyperperiod == 0) fail("no reaction has a period");
+
+    // Kahn's algorithm over the edges between reactions.
+    size_t n = g->num_reactions;
+    size_t* waiting = calloc(n + 1, sizeof(size_t));
+    size_t* down_start = calloc(n + 2, sizeof(size_t));
+    size_t* down = malloc((g->num_edges + 1) * sizeof(size_t));
+    size_t* order = malloc((n + 1) * sizeof(size_t));
+    if (waiting == NULL || down_start == NULL || down == NULL || order == NULL) fail("out of memory");
+    for (size_t r = 0; r < n; r++) {
+        waiting[r] = g->reactions[r].num_upstream;
+        for (size_t i = 0; i < g->reactions[r].num_upstream; i++) down_start[g->reactions[r].upstream[i] + 2]++;
+    }
+    for (size_t r = 0; r < n; r++) down_start[r + 2] += down_start[r + 1];
+    for (size_t r = 0; r < n; r++) {
+        for (size_t i = 0; i < g->reactions[r].num_upstream; i++) {
+            down[down_start[g->reactions[r].upstream[i] + 1]++] = r;
+        }
+    }
+    size_t head = 0, tail = 0;
+    for (size_t r = 0; r < n; r++) {
+        if (waiting[r] == 0) order[tail++] = r;
+    }
+    while (head < tail) {
+        size_t r = order[head++];
+        for (size_t i = down_start[r]; i < down_start[r + 1]; i++) {
+            if (--waiting[down[i]] == 0) order[tail++] = down[i];
+        }
+    }
+    if (tail < n) fail("the reactions form a cycle");
+
+    g->num_jobs = 0;
+    for (size_t k = 0; k < n; k++) {
+        reaction_t* r = &g->reactions[order[k]];
+        size_t count = r->period > 0 ? (size_t)(g->hyperperiod / r->period) : 0;
+        for (size_t i = 0; i < r->num_upstream; i++) count += g->reactions[r->upstream[i]].num_tags;
+        if (count == 0) {
+            fprintf(stderr, "%s: reaction %s has neither a period nor an edge into it.\n", input_path, r->name);
+            exit(1);
+        }
+        if (count > STATIC_SCHEDULE_MAX_STEPS) fail("a reaction runs too often in the hyperperiod");
+        r->tags = malloc(count * sizeof(long long int));
+        if (r->tags == NULL) fail("out of memory");
+        size_t m = 0;
+        for (long long int t = r->offset; r->period > 0 && t < g->hyperperiod; t += r->period) r->tags[m++] = t;
+        for (size_t i = 0; i < r->num_upstream; i++) {
+            const reaction_t* u = &g->reactions[r->upstream[i]];
+            memcpy(&r->tags[m], u->tags, u->num_tags * sizeof(long long int));
+            m += u->num_tags;
+        }
+        qsort(r->tags, m, sizeof(long long int), compare_tags);
+        r->num_tags = 0;
+        for (size_t i = 0; i < m; i++) {
+            if (r->num_tags == 0 || r->tags[r->num_tags - 1] != r->tags[i]) r->tags[r->num_tags++] = r->tags[i];
+        }
+        g->num_jobs += r->num_tags;
+        if (g->num_jobs > STATIC_SCHEDULE_MAX_STEPS) fail("the hyperperiod has too many jobs");
+    }
+    free(waiting);
+    free(down_start);
+    free(down);
+    free(order);
+}
+
+static graph_t* sort_graph;
+
+/** Order the jobs of a reactor by tag and then by reaction. */
+static int compare_reactor_jobs(const void* a, const void* b) {
+    const job_t* x = &sort_graph->jobs[*(const size_t*)a];
+    const job_t* y = &sort_graph->jobs[*(const size_t*)b];
+    if (x->tag != y->tag) return (x->tag > y->tag) - (x->tag < y->tag);
+    return (x->reaction > y->reaction) - (x->reaction < y->reaction);
+}
+
+/** Order the jobs for list scheduling: by tag, then by decreasing rank, then topologically. */
+static int compare_priority(const void* a, const void* b) {
+    const job_t* x = &sort_graph->jobs[*(const size_t*)a];
+    const job_t* y = &sort_graph->jobs[*(const size_t*)b];
+    if (x->tag != y->tag) return (x->tag > y->tag) - (x->tag < y->tag);
+    if (x->rank != y->rank) return (x->rank < y->rank) - (x->rank > y->rank);
+    return (x->order > y->order) - (x->order < y->order);
+}
+
+/** Build the adjacency lists of the jobs from `edges`, one way or the other. */
+static void adjacency(const graph_t* g, bool forward, size_t** start_out, size_t** list_out) {
+    size_t* start = calloc(g->num_jobs + 2, sizeof(size_t));
+    size_t* list = malloc((g->num_job_edges + 1) * sizeof(size_t));
+    if (start == NULL || list == NULL) fail("out of memory");
+    for (size_t e = 0; e < g->num_job_edges; e++) {
+        start[(forward ? g->edges[e].from : g->edges[e].to) + 2]++;
+    }
+    for (size_t j = 0; j < g->num_jobs; j++) start[j + 2] += start[j + 1];
+    for (size_t e = 0; e < g->num_job_edges; e++) {
+        size_t key = forward ? g->edges[e].from : g->edges[e].to;
+        list[start[key + 1]++] = forward ? g->edges[e].to : g->edges[e].from;
+    }
+    *start_out = start;
+    *list_out = list;
+}
+
+static void build_jobs(graph_t* g) {
+    g->jobs = calloc(g->num_jobs + 1, sizeof(job_t));
+    if (g->jobs == NULL) fail("out of memory");
+    size_t j = 0;
+    for (size_t r = 0; r < g->num_reactions; r++) {
+        reaction_t* reaction = &g->reactions[r];
+        reaction->first_job = j;
+        for (size_t i = 0; i < reaction->num_tags; i++, j++) {
+            g->jobs[j] = (job_t) { .reaction = r, .tag = reaction->tags[i], .next = NONE, .worker = NONE };
+        }
+    }
+
+    size_t capacity = 0;
+    for (size_t v = 0; v < g->num_reactions; v++) {
+        const reaction_t* to = &g->reactions[v];
+        for (size_t i = 0; i < to->num_upstream; i++) {
+            const reaction_t* from = &g->reactions[to->upstream[i]];
+            for (size_t k = 0; k < to->num_tags; k++) {
+                size_t same = find_tag(from, to->tags[k], false);
+                if (same < from->num_tags && from->tags[same] == to->tags[k]) {
+                    edge_t edge = { from->first_job + same, to->first_job + k };
+                    PUSH(g->edges, g->num_job_edges, capacity, edge);
+                }
+                // The output must not change before the reader is done.
+                size_t next = find_tag(from, to->tags[k], true);
+                if (next < from->num_tags) {
+                    edge_t edge = { to->first_job + k, from->first_job + next };
+                    PUSH(g->edges, g->num_job_edges, capacity, edge);
+                }
+            }
+        }
+    }
+
+    // Chain the jobs of each reactor.
+    size_t* by_reactor = malloc((g->num_jobs + 1) * sizeof(size_t));
+    size_t* reactor_start = calloc(g->num_reactors + 2, sizeof(size_t));
+    if (by_reactor == NULL || reactor_start == NULL) fail("out of memory");
+    for (size_t k = 0; k < g->num_jobs; k++) reactor_start[g->reactions[g->jobs[k].reaction].reactor + 2]++;
+    for (size_t x = 0; x < g->num_reactors; x++) reactor_start[x + 2] += reactor_start[x + 1];
+    for (size_t k = 0; k < g->num_jobs; k++) by_reactor[reactor_start[g->reactions[g->jobs[k].reaction].reactor + 1]++] = k;
+    sort_graph = g;
+    for (size_t x = 0; x < g->num_reactors; x++) {
+        size_t first = reactor_start[x], end = reactor_start[x + 1];
+        if (first == end) continue;
+        qsort(&by_reactor[first], end - first, sizeof(size_t), compare_reactor_jobs);
+        g->reactors[x].first_job = by_reactor[first];
+        g->reactors[x].has_jobs = true;
+        for (size_t k = first; k + 1 < end; k++) {
+            g->jobs[by_reactor[k]].next = by_reactor[k + 1];
+            edge_t edge = { by_reactor[k], by_reactor[k + 1] };
+            PUSH(g->edges, g->num_job_edges, capacity, edge);
+        }
+    }
+    free(by_reactor);
+    free(reactor_start);
+
+    adjacency(g, true, &g->succ_start, &g->succ);
+    adjacency(g, false, &g->pred_start, &g->pred);
+}
+
+/** Order the jobs topologically and rank them. */
+static void rank_jobs(graph_t* g) {
+    size_t* waiting = malloc((g->num_jobs + 1) * sizeof(size_t));
+    size_t* order = malloc((g->num_jobs + 1) * sizeof(size_t));
+    if (waiting == NULL || order == NULL) fail("out of memory");
+    size_t head = 0, tail = 0;
+    for (size_t j = 0; j < g->num_jobs; j++) {
+        waiting[j] = g->pred_start[j + 1] - g->pred_start[j];
+        if (waiting[j] == 0) order[tail++] = j;
+    }
+    while (head < tail) {
+        size_t j = order[head++];
+        g->jobs[j].order = head;
+        for (size_t i = g->succ_start[j]; i < g->succ_start[j + 1]; i++) {
+            if (--waiting[g->succ[i]] == 0) order[tail++] = g->succ[i];
+        }
+    }
+    if (tail < g->num_jobs) {
+        fail("the reactions of a reactor are declared in an order that contradicts the edges");
+    }
+    for (size_t k = g->num_jobs; k-- > 0;) {
+        job_t* job = &g->jobs[order[k]];
+        long long int longest = 0;
+        for (size_t i = g->succ_start[order[k]]; i < g->succ_start[order[k] + 1]; i++) {
+            if (g->jobs[g->succ[i]].rank > longest) longest = g->jobs[g->succ[i]].rank;
+        }
+        job->rank = g->reactions[job->reaction].wcet + longest;
+    }
+    free(waiting);
+    free(order);
+}
+
+/**
+ * @brief Assign the jobs to workers.
+ *
+ * @return The jobs of each worker, in the order the worker runs them, as
+ *  lists in one array, and the makespan of the hyperperiod in `makespan`.
+ */
+static size_t* assign_jobs(graph_t* g, size_t* worker_start, long long int* makespan) {
+    size_t* priority = malloc((g->num_jobs + 1) * sizeof(size_t));
+    long long int* free_at = calloc(g->workers, sizeof(long long int));
+    long long int* ready = malloc(g->workers * sizeof(long long int));
+    size_t* by_worker = malloc((g->num_jobs + 1) * sizeof(size_t));
+    if (priority == NULL || free_at == NULL || ready == NULL || by_worker == NULL) fail("out of memory");
+    for (size_t j = 0; j < g->num_jobs; j++) priority[j] = j;
+    sort_graph = g;
+    qsort(priority, g->num_jobs, sizeof(size_t), compare_priority);
+
+    *makespan = 0;
+    for (size_t k = 0; k < g->num_jobs; k++) {
+        job_t* job = &g->jobs[priority[k]];
+        for (size_t w = 0; w < g->workers; w++) ready[w] = job->tag > free_at[w] ? job->tag : free_at[w];
+        for (size_t i = g->pred_start[priority[k]]; i < g->pred_start[priority[k] + 1]; i++) {
+            const job_t* pred = &g->jobs[g->pred[i]];
+            for (size_t w = 0; w < g->workers; w++) {
+                long long int t = pred->finish + (pred->worker == w ? 0 : g->sync);
+                if (t > ready[w]) ready[w] = t;
+            }
+        }
+        size_t best = 0;
+        for (size_t w = 1; w < g->workers; w++) {
+            if (ready[w] < ready[best]) best = w;
+        }
+        job->worker = best;
+        job->finish = ready[best] + g->reactions[job->reaction].wcet;
+        free_at[best] = job->finish;
+        if (job->finish > *makespan) *makespan = job->finish;
+        worker_start[best + 2]++;
+    }
+    for (size_t w = 0; w < g->workers; w++) worker_start[w + 2] += worker_start[w + 1];
+    for (size_t k = 0; k < g->num_jobs; k++) {
+        by_worker[worker_start[g->jobs[priority[k]].worker + 1]++] = priority[k];
+    }
+
+    // A reactor whose jobs all run on one worker can be advanced with ADV2.
+    for (size_t j = 0; j < g->num_jobs; j++) {
+        reactor_t* reactor = &g->reactors[g->reactions[g->jobs[j].reaction].reactor];
+        if (j == reactor->first_job || reactor->worker == g->jobs[j].worker) {
+            reactor->worker = g->jobs[j].worker;
+        }
+    }
+    for (size_t j = 0; j < g->num_jobs; j++) {
+        reactor_t* reactor = &g->reactors[g->reactions[g->jobs[j].reaction].reactor];
+        if (reactor->worker != g->jobs[j].worker) reactor->worker = NONE;
+    }
+    free(priority);
+    free(free_at);
+    free(ready);
+    return by_worker;
+}
+
+///////////////////////////// Instructions /////////////////////////////
+
+typedef struct {
+    inst_t*         insts;
+    size_t          length;
+    size_t          capacity;
+} program_t;
+
+static void emit(program_t* p, opcode_t op, long long int rs1, long long int rs2) {
+    inst_t inst = { .op = op, .rs1 = rs1, .rs2 = rs2 };
+    PUSH(p->insts, p->length, p->capacity, inst);
+}
+
+/** Emit ADV or ADV2 of the reactor of `job` to the tag of its next job. */
+static void emit_advance(const graph_t* g, program_t* p, const job_t* job) {
+    size_t x = g->reactions[job->reaction].reactor;
+    const reactor_t* reactor = &g->reactors[x];
+    long long int amount = job->next != NONE ? g->jobs[job->next].tag - job->tag
+                                             : g->hyperperiod - job->tag + g->jobs[reactor->first_job].tag;
+    if (amount > 0) emit(p, reactor->worker == NONE ? ADV : ADV2, (long long int)x, amount);
+}
+
+static program_t* generate(graph_t* g, const size_t* by_worker, const size_t* worker_start) {
+    program_t* programs = calloc(g->workers, sizeof(program_t));
+    long long int* waited = malloc(g->workers * sizeof(long long int));
+    long long int* counts = calloc(g->workers, sizeof(long long int));
+    if (programs == NULL || waited == NULL || counts == NULL) fail("out of memory");
+
+    for (size_t j = 0; j < g->num_jobs; j++) {
+        for (size_t i = g->succ_start[j]; i < g->succ_start[j + 1]; i++) {
+            if (g->jobs[g->succ[i]].worker != g->jobs[j].worker) {
+                g->jobs[j].count = 1;
+                break;
+            }
+        }
+    }
+    for (size_t w = 0; w < g->workers; w++) {
+        for (size_t k = worker_start[w]; k < worker_start[w + 1]; k++) {
+            job_t* job = &g->jobs[by_worker[k]];
+            if (job->count > 0) job->count = ++counts[w];
+        }
+    }
+
+    for (size_t w = 0; w < g->workers; w++) {
+        program_t* p = &programs[w];
+        // Before the loop, bring the reactors whose first job is late in the
+        // hyperperiod to its tag. The loop then advances them from job to job.
+        for (size_t x = 0; x < g->num_reactors; x++) {
+            const reactor_t* reactor = &g->reactors[x];
+            if (!reactor->has_jobs || g->jobs[reactor->first_job].worker != w) continue;
+            long long int tag = g->jobs[reactor->first_job].tag;
+            if (tag > 0) emit(p, reactor->worker == NONE ? ADV : ADV2, (long long int)x, tag);
+        }
+        size_t head = p->length;
+        emit(p, BIT, 0, -1);
+        for (size_t c = 0; c < g->workers; c++) waited[c] = 0;
+        long long int released = -1;
+        for (size_t k = worker_start[w]; k < worker_start[w + 1]; k++) {
+            const job_t* job = &g->jobs[by_worker[k]];
+            const reaction_t* reaction = &g->reactions[job->reaction];
+            bool timer = timer_tag(reaction, job->tag);
+            if (timer && job->tag > released) {
+                emit(p, DU, g->hyperperiod, job->tag > 0 ? job->tag : -1);
+                released = job->tag;
+            }
+            for (size_t i = g->pred_start[by_worker[k]]; i < g->pred_start[by_worker[k] + 1]; i++) {
+                const job_t* pred = &g->jobs[g->pred[i]];
+                if (pred->worker == w || waited[pred->worker] >= pred->count) continue;
+                emit(p, WU, (long long int)pred->worker, pred->count);
+                waited[pred->worker] = pred->count;
+            }
+            emit(p, timer ? EXE : EIT, (long long int)job->reaction, -1);
+            emit_advance(g, p, job);
+            if (job->count > 0) emit(p, INC2, (long long int)w, 1);
+        }
+        // Reactors without reactions still have to reach the stop tag.
+        for (size_t x = 0; w == 0 && x < g->num_reactors; x++) {
+            if (!g->reactors[x].has_jobs) emit(p, ADV2, (long long int)x, g->hyperperiod);
+        }
+        emit(p, SAC, -1, -1);
+        emit(p, JMP, (long long int)head, 1);
+        p->insts[head].rs1 = (long long int)p->length;
+        emit(p, STP, -1, -1);
+    }
+    free(waited);
+    free(counts);
+    return programs;
+}
+
+///////////////////////////// Output /////////////////////////////
+
+static const char* const opcode_names[] = {
+    [ADV]   = "ADV",
+    [ADV2]  = "ADV2",
+    [BIT]   = "BIT",
+    [DU]    = "DU",
+    [EIT]   = "EIT",
+    [EXE]   = "EXE",
+    [INC]   = "INC",
+    [INC2]  = "INC2",
+    [JMP]   = "JMP",
+    [SAC]   = "SAC",
+    [STP]   = "STP",
+    [WU]    = "WU",
+};
+
+static bool ends_with(const char* s, const char* suffix) {
+    size_t n = strlen(s), m = strlen(suffix);
+    return n >= m && strcmp(s + n - m, suffix) == 0;
+}
+
+/** Write a list of names as `[0=a, 1=b, ...]` in a comment. */
+static void write_names(FILE* out, const char* title, size_t count, const char* (*get)(const graph_t*, size_t),
+                        const graph_t* g) {
+    fprintf(out, " * %s:\n * [", title);
+    size_t column = 4;
+    for (size_t i = 0; i < count; i++) {
+        char entry[256];
+        int n = snprintf(entry, sizeof(entry), "%zu=%s", i, get(g, i));
+        if (i > 0 && column + n > 98) {
+            fprintf(out, ",\n *  ");
+            column = 4;
+        } else if (i > 0) {
+            fprintf(out, ", ");
+            column += 2;
+        }
+        fputs(entry, out);
+        column += n;
+    }
+    fprintf(out, "]\n");
+}
+
+static const char* worker_name(const graph_t* g, size_t i) {
+    (void)g;
+    static char name[32];
+    snprintf(name, sizeof(name), "jobs done by worker %zu", i);
+    return name;
+}
+
+static void write_comment(FILE* out, const graph_t* g, const inst_t* inst) {
+    switch (inst->op) {
+        case EXE:
+        case EIT:
+            fprintf(out, "%s %s", opcode_names[inst->op], g->reactions[inst->rs1].name);
+            break;
+        case ADV:
+        case ADV2:
+            fprintf(out, "%s %s, %lld", opcode_names[inst->op], g->reactors[inst->rs1].name, inst->rs2);
+            break;
+        case DU:
+            fprintf(out, "DU until %lld ns into the hyperperiod", inst->rs2 > 0 ? inst->rs2 : 0);
+            break;
+        case WU:
+            fprintf(out, "WU counter %lld reaches %lld", inst->rs1, inst->rs2);
+            break;
+        case INC2:
+            fprintf(out, "INC2 counter %lld by %lld", inst->rs1, inst->rs2);
+            break;
+        case BIT:
+            fprintf(out, "BIT if timeout, jump to line %lld", inst->rs1);
+            break;
+        case JMP:
+            fprintf(out, "JMP to line %lld, increment hyperperiod iteration", inst->rs1);
+            break;
+        default:
+            fputs(opcode_names[inst->op], out);
+            break;
+    }
+}
+
+static int write_c(const char* path, const graph_t* g, const program_t* programs) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) return -1;
+    fprintf(out, "/**\n * @brief Generated by fs_schedule_generate from %s.\n *\n", input_path);
+    write_names(out, "reaction array", g->num_reactions, reaction_name, g);
+    fprintf(out, " * \n");
+    write_names(out, "reactor array", g->num_reactors, reactor_name, g);
+    fprintf(out, " * \n");
+    write_names(out, "counting variable arrays", g->workers, worker_name, g);
+    fprintf(out, " */\n\n#include <stdint.h>\n#include <stddef.h> // size_t\n"
+                 "#include \"../core/threaded/scheduler_instructions.h\"\n\n");
+    for (size_t w = 0; w < g->workers; w++) {
+        fprintf(out, "const inst_t schedule_%zu[] = {\n", w);
+        for (size_t pc = 0; pc < programs[w].length; pc++) {
+            const inst_t* inst = &programs[w].insts[pc];
+            char op[16], rs1[32], rs2[32];
+            snprintf(op, sizeof(op), "{.op=%s,", opcode_names[inst->op]);
+            snprintf(rs1, sizeof(rs1), ".rs1=%lld,", inst->rs1);
+            snprintf(rs2, sizeof(rs2), ".rs2=%lld},", inst->rs2);
+            fprintf(out, "    %-12s%-16s%-16s// %zu: ", op, rs1, rs2, pc);
+            write_comment(out, g, inst);
+            fprintf(out, "\n");
+        }
+        fprintf(out, "};\n\n");
+    }
+    fprintf(out, "const inst_t* static_schedules[] = {\n");
+    for (size_t w = 0; w < g->workers; w++) fprintf(out, "    schedule_%zu,\n", w);
+    fprintf(out, "};\n\nconst size_t schedule_lengths[] = {\n");
+    for (size_t w = 0; w < g->workers; w++) fprintf(out, "    sizeof(schedule_%zu) / sizeof(inst_t),\n", w);
+    fprintf(out, "};\n\nconst size_t num_schedules = %zu;\n\n", g->workers);
+    fprintf(out, "const wait_policy_t wait_policy = WAIT_HYBRID;\n\n");
+    fprintf(out, "volatile uint32_t hyperperiod_iterations[%zu];\n\n", g->workers);
+    fprintf(out, "const size_t num_counters = %zu;\n", g->workers);
+    return fclose(out);
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s <description> <output file> [workers]\n", argv[0]);
+        return 1;
+    }
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+
+    input_path = argv[1];
+    FILE* in = fopen(input_path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Cannot read %s.\n", input_path);
+        return 1;
+    }
+    graph_t g = { .workers = 1 };
+    parse(&g, in);
+    fclose(in);
+    if (argc == 4) g.workers = strtoull(argv[3], NULL, 10);
+    if (g.workers == 0) fail("there must be at least one worker");
+    if (g.num_cpus > g.workers) fail("there are more CPUs than workers");
+
+    resolve(&g);
+    find_tags(&g);
+    build_jobs(&g);
+    rank_jobs(&g);
+    size_t* worker_start = calloc(g.workers + 2, sizeof(size_t));
+    if (worker_start == NULL) fail("out of memory");
+    long long int makespan;
+    size_t* by_worker = assign_jobs(&g, worker_start, &makespan);
+    program_t* programs = generate(&g, by_worker, worker_start);
+
+    const inst_t** schedules = malloc(g.workers * sizeof(inst_t*));
+    size_t* lengths = malloc(g.workers * sizeof(size_t));
+    if (schedules == NULL || lengths == NULL) fail("out of memory");
+    size_t instructions = 0;
+    for (size_t w = 0; w < g.workers; w++) {
+        schedules[w] = programs[w].insts;
+        lengths[w] = programs[w].length;
+        instructions += programs[w].length;
+    }
+    int* cpus = NULL;
+    if (g.num_cpus > 0) {
+        cpus = malloc(g.workers * sizeof(int));
+        if (cpus == NULL) fail("out of memory");
+        for (size_t w = 0; w < g.workers; w++) cpus[w] = w < g.num_cpus ? g.cpus[w] : STATIC_SCHEDULE_NO_CPU;
+    }
+    static_schedule_t schedule = {
+        .num_workers = g.workers,
+        .schedules = schedules,
+        .schedule_lengths = lengths,
+        .cpus = cpus,
+        .num_counters = g.workers,
+        .num_reactions = g.num_reactions,
+        .num_reactors = g.num_reactors,
+        .wait_policy = WAIT_HYBRID,
+    };
+    if (static_schedule_verify(&schedule, g.num_reactions, g.num_reactors, static_schedule_print_problem, (void*)argv[2]) != 0) {
+        fprintf(stderr, "%s: the generated schedules do not verify.\n", argv[2]);
+        return 1;
+    }
+    const char* error = "cannot write the file";
+    if (ends_with(argv[2], ".c") ? write_c(argv[2], &g, programs) != 0
+                                 : static_schedule_write(argv[2], &schedule, &error) != 0) {
+        fprintf(stderr, "Cannot write %s: %s.\n", argv[2], error);
+        return 1;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) / 1e6;
+    printf("workers=%zu reactions=%zu jobs=%zu hyperperiod_ns=%lld makespan_ns=%lld instructions=%zu "
+           "generate_ms=%.3f\n", g.workers, g.num_reactions, g.num_jobs, g.hyperperiod, makespan, instructions,
+           elapsed_ms);
+    if (makespan > g.hyperperiod) {
+        fprintf(stderr, "%s: warning: the jobs of a hyperperiod take %lld ns, longer than the hyperperiod.\n",
+                input_path, makespan);
+    }
+    return 0;
+}
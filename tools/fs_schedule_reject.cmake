@@ -0,0 +1,15 @@
+# Run fs_schedule_verify on a schedule file that must not pass verification
+# and fail if it does, or if it fails for another reason, e.g., because the
+# file cannot be read.
+#
+# Usage: cmake -DVERIFIER=<fs_schedule_verify> -DSCHEDULE_FILE=<file> -P fs_schedule_reject.cmake
+execute_process(
+    COMMAND ${VERIFIER} ${SCHEDULE_FILE}
+    RESULT_VARIABLE VERIFY_RESULT
+    ERROR_VARIABLE VERIFY_ERROR
+)
+if(VERIFY_RESULT EQUAL 0)
+    message(FATAL_ERROR "${SCHEDULE_FILE} is malformed, but fs_schedule_verify accepts it.")
+elseif(NOT VERIFY_ERROR MATCHES "problem\\(s\\)")
+    message(FATAL_ERROR "fs_schedule_verify does not verify ${SCHEDULE_FILE}:\n${VERIFY_ERROR}")
+endif()
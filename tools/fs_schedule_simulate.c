@@ -0,0 +1,984 @@
+/**
+ * @file fs_schedule_simulate.c
+ * @brief Simulate the schedules of a schedule file on virtual time.
+ *
+ * The workers run the instructions as `scheduler_FS.c` does, with the same
+ * epochs, counter targets, release times, and stop condition, but a reaction
+ * takes a time drawn from its distribution instead of running, and waiting
+ * takes no time beyond what it waits for. This predicts, before a schedule
+ * is deployed, how long the reactions of a hyperperiod take from the first
+ * start to the last end (the makespan), how busy each worker is, how long
+ * WUs wait, and whether every worker reaches each DU before its release
+ * time. It also finds the critical path of the hyperperiod with the longest
+ * makespan: the chain of reactions, WU wakeups, and SAC releases, back to a
+ * DU release, that its last reaction waited for.
+ *
+ * The model is a text file with one declaration per line, in the format of
+ * fs_schedule_generate, whose description can be used as is: `#` starts a
+ * comment, and times are nanoseconds unless they end in ns, us, ms, or s.
+ *
+ *     reaction <name> <reactor> <wcet> ...   # The next reaction takes <wcet>.
+ *     wcet     <reaction> <distribution>     # A reaction by name or index.
+ *     default  <distribution>                # For reactions not given; default 0.
+ *     trigger  <reaction> <probability>      # That EIT and BNT find it queued; default 1.
+ *     inactive <reaction>                    # That BNM finds its mode inactive; default active.
+ *     overhead <time>                        # Per instruction; default 0.
+ *     wakeup   <time>                        # Per wakeup from DU, WU, or SAC; default 0.
+ *     seed     <number>
+ *
+ * where a distribution is `<time>`, `uniform <min> <max>`, or
+ * `normal <mean> <deviation>` (approximated by the sum of 12 uniforms and cut
+ * off at 0). Reactions are numbered as in the program's reaction array,
+ * which is the order of their `reaction` lines. Other declarations of
+ * fs_schedule_generate are ignored. SRV is assumed to find no sporadic
+ * reactions, and the modes do not change.
+ *
+ * As with the benchmarks, the physical start time is 0 and the stop tag is
+ * one nanosecond before the given number of hyperperiods, where a
+ * hyperperiod is the most that the loops of the workers advance a reactor
+ * per pass. If a timeline file is given, the reactions and waits of the
+ * hyperperiod with the longest makespan are written to it as CSV.
+ *
+ * The exit status is 1 if the schedules cannot be simulated or a worker gets
+ * stuck, 2 if a worker reaches a DU after its release time, and 0 otherwise.
+ *
+ * Usage: fs_schedule_simulate <schedule file> <model file> [hyperperiods] [timeline file]
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "scheduler_instructions.h"
+#include "static_schedule_file.h"
+#include "static_schedule_verify.h"
+
+#define NONE SIZE_MAX
+
+typedef enum {
+    FIXED,
+    UNIFORM,
+    NORMAL,
+} distribution_kind_t;
+
+typedef struct {
+    distribution_kind_t kind;
+    long long int       a;              // The time, the minimum, or the mean.
+    long long int       b;              // The maximum or the deviation.
+} distribution_t;
+
+typedef struct {
+    char*               name;           // A reaction name or index.
+    distribution_t      wcet;
+    double              trigger;
+    bool                is_trigger;
+    bool                is_inactive;
+    size_t              line;
+} setting_t;
+
+typedef struct {
+    size_t              num_reactions;
+    distribution_t*     wcet;
+    double*             trigger;
+    bool*               inactive;       // Whether BNM finds the mode of a reaction inactive.
+    distribution_t      default_wcet;
+    long long int       overhead;
+    long long int       wakeup;
+    uint64_t            seed;
+} model_t;
+
+typedef enum {
+    RUNNING,
+    BLOCKED_ON_WU,
+    AT_SAC,
+    FINISHED,
+} worker_state_t;
+
+typedef enum {
+    EVENT_REACTION,
+    EVENT_WU,
+    EVENT_DU,
+    EVENT_SAC,
+} event_kind_t;
+
+/** Something a worker did in the traced hyperperiod. */
+typedef struct {
+    event_kind_t        kind;
+    size_t              line;
+    long long int       start;          // When the worker got there.
+    long long int       end;            // When it went on.
+    size_t              what;           // The reaction, or the counter of a WU.
+    size_t              from_worker;    // The worker that let it go on, or NONE.
+    size_t              from_event;     // How many events that worker had recorded by then.
+} event_t;
+
+typedef struct {
+    worker_state_t      state;
+    size_t              pc;
+    long long int       time;
+    size_t              epoch;
+    long long int       iteration;
+    long long int       registers[INST_NUM_REGISTERS];
+    uint64_t            random;
+    size_t              loop_head;
+    size_t              loop_end;
+    size_t              loop_exit;      // Where WU leaves the loop when stopping, or NONE.
+    size_t              next_waiter;    // In the list of the counter it waits on.
+    long long int       target;         // What it waits for in WU.
+    long long int       busy;
+    long long int       wu_wait;
+    long long int       du_idle;
+    long long int       sac_wait;
+    size_t              reactions;
+    long long int*      line_wait;      // The longest WU wait per line.
+    event_t*            events;
+    size_t              num_events;
+    size_t              events_capacity;
+} worker_t;
+
+typedef struct {
+    const static_schedule_t* schedule;
+    const model_t*      model;
+    size_t              num_workers;
+    worker_t*           workers;
+    size_t*             heap;           // Running workers, by time.
+    size_t              heap_size;
+    unsigned long long* counters;
+    unsigned long long* base;
+    unsigned long long* per_epoch;
+    size_t*             first_waiter;
+    long long int*      tags;           // Of the reactors.
+    bool*               stopped;        // Whether the reactor has gone past the stop tag.
+    size_t              num_reactors;
+    size_t              reactors_remaining;
+    long long int       stop_time;
+    size_t              stop_epoch;
+    size_t              at_sac;
+    size_t*             trigger_epoch;  // The epoch of each reaction's last draw, or NONE.
+    bool*               triggered;
+    size_t              trace_epoch;    // The epoch to record events of, or NONE.
+    // Per epoch: the first start and the last end of a reaction.
+    long long int*      first_start;
+    long long int*      last_end;
+    size_t*             last_worker;
+    size_t              num_epochs;
+    size_t              epochs_capacity;
+    // DU releases.
+    size_t              releases;
+    size_t              late;
+    long long int       max_lateness;
+    size_t              late_worker;
+    size_t              late_line;
+} simulation_t;
+
+static void fail(const char* message) {
+    fprintf(stderr, "%s.\n", message);
+    exit(1);
+}
+
+///////////////////////////// Model /////////////////////////////
+
+static const char* model_path;
+static size_t model_line;
+
+static void model_error(const char* message) {
+    fprintf(stderr, "%s:%zu: %s.\n", model_path, model_line, message);
+    exit(1);
+}
+
+static long long int parse_time(const char* s) {
+    char* end;
+    long long int value = strtoll(s, &end, 10);
+    long long int unit = 1;
+    if (strcmp(end, "us") == 0) unit = 1000LL;
+    else if (strcmp(end, "ms") == 0) unit = 1000000LL;
+    else if (strcmp(end, "s") == 0) unit = 1000000000LL;
+    else if (*end != '\0' && strcmp(end, "ns") != 0) model_error("invalid time");
+    if (end == s || value < 0 || value > INT64_MAX / unit) model_error("invalid time");
+    return value * unit;
+}
+
+static distribution_t parse_distribution(char** words, size_t n) {
+    if (n == 1) return (distribution_t) { FIXED, parse_time(words[0]), 0 };
+    if (n == 3 && strcmp(words[0], "uniform") == 0) {
+        distribution_t d = { UNIFORM, parse_time(words[1]), parse_time(words[2]) };
+        if (d.b < d.a) model_error("the maximum is below the minimum");
+        return d;
+    }
+    if (n == 3 && strcmp(words[0], "normal") == 0) {
+        return (distribution_t) { NORMAL, parse_time(words[1]), parse_time(words[2]) };
+    }
+    model_error("invalid distribution");
+    return (distribution_t) { FIXED, 0, 0 };
+}
+
+static char* copy(const char* s) {
+    char* result = strdup(s);
+    if (result == NULL) fail("Out of memory");
+    return result;
+}
+
+typedef struct {
+    const char*         name;
+    size_t              index;
+} name_t;
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(((const name_t*)a)->name, ((const name_t*)b)->name);
+}
+
+/** Grow `array` of `length` elements to hold at least `needed`. */
+static void* grow(void* array, size_t* capacity, size_t needed, size_t size) {
+    if (needed <= *capacity) return array;
+    size_t new_capacity = *capacity == 0 ? 16 : *capacity;
+    while (new_capacity < needed) new_capacity *= 2;
+    array = realloc(array, new_capacity * size);
+    if (array == NULL) fail("Out of memory");
+    *capacity = new_capacity;
+    return array;
+}
+
+/**
+ * @brief Read the model for a program with `num_reactions` reactions. The
+ * model may declare more.
+ */
+static void read_model(const char* path, size_t num_reactions, model_t* model) {
+    model_path = path;
+    FILE* in = fopen(path, "r");
+    if (in == NULL) {
+        fprintf(stderr, "Cannot read %s.\n", path);
+        exit(1);
+    }
+    *model = (model_t) { .default_wcet = { FIXED, 0, 0 }, .seed = 1 };
+    name_t* names = NULL;
+    size_t num_names = 0, names_capacity = 0;
+    distribution_t* declared = NULL;
+    size_t declared_capacity = 0;
+    setting_t* settings = NULL;
+    size_t num_settings = 0, settings_capacity = 0;
+
+    char line[4096];
+    while (fgets(line, sizeof(line), in) != NULL) {
+        model_line++;
+        char* comment = strchr(line, '#');
+        if (comment != NULL) *comment = '\0';
+        char* words[8];
+        size_t n = 0;
+        for (char* word = strtok(line, " \t\r\n"); word != NULL; word = strtok(NULL, " \t\r\n")) {
+            if (n == 8) model_error("too many words");
+            words[n++] = word;
+        }
+        if (n == 0) continue;
+        if (strcmp(words[0], "reaction") == 0 && n >= 4) {
+            names = grow(names, &names_capacity, num_names + 1, sizeof(name_t));
+            declared = grow(declared, &declared_capacity, num_names + 1, sizeof(distribution_t));
+            declared[num_names] = (distribution_t) { FIXED, parse_time(words[3]), 0 };
+            names[num_names] = (name_t) { copy(words[1]), num_names };
+            num_names++;
+        } else if ((strcmp(words[0], "wcet") == 0 && n >= 3) || (strcmp(words[0], "trigger") == 0 && n == 3)) {
+            setting_t setting = { .name = copy(words[1]), .line = model_line };
+            if (words[0][0] == 'w') {
+                setting.wcet = parse_distribution(&words[2], n - 2);
+            } else {
+                char* end;
+                setting.is_trigger = true;
+                setting.trigger = strtod(words[2], &end);
+                if (*end != '\0' || setting.trigger < 0 || setting.trigger > 1) model_error("invalid probability");
+            }
+            settings = grow(settings, &settings_capacity, num_settings + 1, sizeof(setting_t));
+            settings[num_settings++] = setting;
+        } else if (strcmp(words[0], "inactive") == 0 && n == 2) {
+            settings = grow(settings, &settings_capacity, num_settings + 1, sizeof(setting_t));
+            settings[num_settings++] = (setting_t) { .name = copy(words[1]), .is_inactive = true, .line = model_line };
+        } else if (strcmp(words[0], "default") == 0 && n >= 2) {
+            model->default_wcet = parse_distribution(&words[1], n - 1);
+        } else if (strcmp(words[0], "overhead") == 0 && n == 2) {
+            model->overhead = parse_time(words[1]);
+        } else if (strcmp(words[0], "wakeup") == 0 && n == 2) {
+            model->wakeup = parse_time(words[1]);
+        } else if (strcmp(words[0], "seed") == 0 && n == 2) {
+            model->seed = strtoull(words[1], NULL, 10);
+        } else if (strcmp(words[0], "workers") != 0 && strcmp(words[0], "sync") != 0
+                   && strcmp(words[0], "reactor") != 0 && strcmp(words[0], "edge") != 0) {
+            model_error("unknown declaration");
+        }
+    }
+    fclose(in);
+
+    model->num_reactions = num_reactions > num_names ? num_reactions : num_names;
+    model->wcet = malloc((model->num_reactions + 1) * sizeof(distribution_t));
+    model->trigger = malloc((model->num_reactions + 1) * sizeof(double));
+    model->inactive = calloc(model->num_reactions + 1, sizeof(bool));
+    if (model->wcet == NULL || model->trigger == NULL || model->inactive == NULL) fail("Out of memory");
+    for (size_t r = 0; r < model->num_reactions; r++) {
+        model->wcet[r] = r < num_names ? declared[r] : model->default_wcet;
+        model->trigger[r] = 1;
+    }
+    if (num_names > 0) qsort(names, num_names, sizeof(name_t), compare_names);
+    for (size_t i = 0; i < num_settings; i++) {
+        setting_t* setting = &settings[i];
+        model_line = setting->line;
+        name_t key = { setting->name, 0 };
+        const name_t* found = num_names > 0 ? bsearch(&key, names, num_names, sizeof(name_t), compare_names) : NULL;
+        char* end;
+        size_t r = found != NULL ? found->index : strtoull(setting->name, &end, 10);
+        if (found == NULL && (*end != '\0' || end == setting->name || r >= model->num_reactions)) {
+            model_error("unknown reaction");
+        }
+        if (setting->is_trigger) model->trigger[r] = setting->trigger;
+        else if (setting->is_inactive) model->inactive[r] = true;
+        else model->wcet[r] = setting->wcet;
+        free(setting->name);
+    }
+    for (size_t i = 0; i < num_names; i++) free((char*)names[i].name);
+    free(names);
+    free(declared);
+    free(settings);
+}
+
+///////////////////////////// Simulation /////////////////////////////
+
+static uint64_t next_random(uint64_t* state) {
+    uint64_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+/** A uniform draw from [0, 1). */
+static double next_uniform(uint64_t* state) {
+    return (next_random(state) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+static long long int sample(const distribution_t* d, uint64_t* state) {
+    switch (d->kind) {
+        case UNIFORM:
+            return d->a + (long long int)(next_uniform(state) * (double)(d->b - d->a + 1));
+        case NORMAL: {
+            double sum = -6;
+            for (int i = 0; i < 12; i++) sum += next_uniform(state);
+            double value = (double)d->a + sum * (double)d->b;
+            return value > 0 ? (long long int)value : 0;
+        }
+        default:
+            return d->a;
+    }
+}
+
+/** Whether worker `w` is before worker `v` in the heap, i.e., earlier. */
+static bool earlier(const simulation_t* s, size_t w, size_t v) {
+    long long int a = s->workers[w].time, b = s->workers[v].time;
+    return a < b || (a == b && w < v);
+}
+
+static void push(simulation_t* s, size_t w) {
+    size_t i = s->heap_size++;
+    while (i > 0 && earlier(s, w, s->heap[(i - 1) / 2])) {
+        s->heap[i] = s->heap[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    s->heap[i] = w;
+}
+
+static size_t pop(simulation_t* s) {
+    size_t top = s->heap[0];
+    size_t last = s->heap[--s->heap_size];
+    size_t i = 0;
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= s->heap_size) break;
+        if (child + 1 < s->heap_size && earlier(s, s->heap[child + 1], s->heap[child])) child++;
+        if (!earlier(s, s->heap[child], last)) break;
+        s->heap[i] = s->heap[child];
+        i = child;
+    }
+    if (s->heap_size > 0) s->heap[i] = last;
+    return top;
+}
+
+/**
+ * @brief How many events worker `w` has recorded in the traced epoch, or 0
+ * if it is in another epoch.
+ */
+static size_t events_so_far(const simulation_t* s, size_t w) {
+    return s->workers[w].epoch == s->trace_epoch ? s->workers[w].num_events : 0;
+}
+
+static void record(simulation_t* s, worker_t* worker, event_t event) {
+    if (worker->epoch != s->trace_epoch) return;
+    worker->events = grow(worker->events, &worker->events_capacity, worker->num_events + 1, sizeof(event_t));
+    worker->events[worker->num_events++] = event;
+}
+
+/** Wake a worker that waited since its `time` at `now`, and charge the wait. */
+static long long int wake(simulation_t* s, worker_t* worker, long long int now) {
+    if (now <= worker->time) return 0;
+    long long int waited = now - worker->time + s->model->wakeup;
+    worker->time = now + s->model->wakeup;
+    return waited;
+}
+
+/** Make every worker in the stopping epoch or later leave its WU. */
+static void stop_waiters(simulation_t* s, long long int now) {
+    for (size_t c = 0; c < s->schedule->num_counters; c++) {
+        size_t* link = &s->first_waiter[c];
+        while (*link != NONE) {
+            size_t w = *link;
+            worker_t* worker = &s->workers[w];
+            if (worker->epoch >= s->stop_epoch && worker->loop_exit != NONE) {
+                *link = worker->next_waiter;
+                worker->wu_wait += wake(s, worker, now);
+                worker->pc = worker->loop_exit;
+                worker->state = RUNNING;
+                push(s, w);
+            } else {
+                link = &worker->next_waiter;
+            }
+        }
+    }
+}
+
+static void run_reaction(simulation_t* s, size_t w, size_t reaction) {
+    worker_t* worker = &s->workers[w];
+    long long int start = worker->time;
+    long long int duration = sample(&s->model->wcet[reaction], &worker->random);
+    worker->time += duration;
+    worker->busy += duration;
+    worker->reactions++;
+    size_t e = worker->epoch;
+    if (e >= s->num_epochs) {
+        size_t capacity = s->epochs_capacity;
+        s->first_start = grow(s->first_start, &capacity, e + 1, sizeof(long long int));
+        capacity = s->epochs_capacity;
+        s->last_end = grow(s->last_end, &capacity, e + 1, sizeof(long long int));
+        capacity = s->epochs_capacity;
+        s->last_worker = grow(s->last_worker, &capacity, e + 1, sizeof(size_t));
+        s->epochs_capacity = capacity;
+        for (size_t i = s->num_epochs; i <= e; i++) {
+            s->first_start[i] = INT64_MAX;
+            s->last_end[i] = INT64_MIN;
+        }
+        s->num_epochs = e + 1;
+    }
+    if (start < s->first_start[e]) s->first_start[e] = start;
+    if (worker->time > s->last_end[e]) {
+        s->last_end[e] = worker->time;
+        s->last_worker[e] = w;
+    }
+    record(s, worker, (event_t) { EVENT_REACTION, worker->pc, start, worker->time, reaction, NONE, 0 });
+}
+
+/** Whether a reaction is queued when worker `w` checks it. */
+static bool is_triggered(simulation_t* s, size_t w, size_t reaction) {
+    double p = s->model->trigger[reaction];
+    if (p >= 1) return true;
+    worker_t* worker = &s->workers[w];
+    // Draw once per epoch, so that a BNT and the EIT it guards agree.
+    if (s->trigger_epoch[reaction] != worker->epoch) {
+        s->trigger_epoch[reaction] = worker->epoch;
+        s->triggered[reaction] = next_uniform(&worker->random) < p;
+    }
+    return s->triggered[reaction];
+}
+
+/**
+ * @brief Execute one instruction of worker `w`.
+ *
+ * @return Whether the worker can go on.
+ */
+static bool step(simulation_t* s, size_t w) {
+    worker_t* worker = &s->workers[w];
+    const inst_t* inst = &s->schedule->schedules[w][worker->pc];
+    worker->time += s->model->overhead;
+    switch (inst->op) {
+        case EXE:
+            run_reaction(s, w, static_schedule_reaction_index(s->schedule, w, inst->rs1));
+            worker->pc++;
+            return true;
+        case EIT: {
+            size_t reaction = static_schedule_reaction_index(s->schedule, w, inst->rs1);
+            if (is_triggered(s, w, reaction)) run_reaction(s, w, reaction);
+            worker->pc++;
+            return true;
+        }
+        case BNT: {
+            size_t reaction = static_schedule_reaction_index(s->schedule, w, inst->rs2);
+            worker->pc = is_triggered(s, w, reaction) ? worker->pc + 1 : (size_t)inst->rs1;
+            return true;
+        }
+        case BNM: {
+            size_t reaction = static_schedule_reaction_index(s->schedule, w, inst->rs2);
+            worker->pc = s->model->inactive[reaction] ? (size_t)inst->rs1 : worker->pc + 1;
+            return true;
+        }
+        case DU: {
+            long long int release = (inst->rs2 > 0 ? inst->rs2 : 0) + inst->rs1 * (worker->iteration + 1);
+            long long int arrival = worker->time;
+            s->releases++;
+            if (arrival < release) {
+                worker->du_idle += wake(s, worker, release);
+            } else if (arrival > release) {
+                s->late++;
+                if (arrival - release > s->max_lateness) {
+                    s->max_lateness = arrival - release;
+                    s->late_worker = w;
+                    s->late_line = worker->pc;
+                }
+            }
+            record(s, worker, (event_t) { EVENT_DU, worker->pc, arrival, worker->time, release, NONE, 0 });
+            worker->pc++;
+            return true;
+        }
+        case WU: {
+            size_t c = inst->rs1;
+            long long int target = inst->rs2;
+            if (worker->pc >= worker->loop_head) {
+                target += (long long int)(s->base[c] + worker->epoch * s->per_epoch[c]);
+            }
+            if ((long long int)s->counters[c] >= target) {
+                record(s, worker, (event_t) { EVENT_WU, worker->pc, worker->time, worker->time, c, NONE, 0 });
+                worker->pc++;
+                return true;
+            }
+            if (worker->loop_exit != NONE && worker->epoch >= s->stop_epoch) {
+                worker->pc = worker->loop_exit;
+                return true;
+            }
+            worker->target = target;
+            worker->state = BLOCKED_ON_WU;
+            worker->next_waiter = s->first_waiter[c];
+            s->first_waiter[c] = w;
+            return false;
+        }
+        case INC:
+        case INC2: {
+            size_t c = inst->rs1;
+            s->counters[c] += inst->rs2;
+            worker->pc++;
+            size_t from_event = events_so_far(s, w);
+            size_t* link = &s->first_waiter[c];
+            while (*link != NONE) {
+                size_t v = *link;
+                worker_t* waiter = &s->workers[v];
+                if ((long long int)s->counters[c] < waiter->target) {
+                    link = &waiter->next_waiter;
+                    continue;
+                }
+                *link = waiter->next_waiter;
+                long long int arrival = waiter->time;
+                long long int waited = wake(s, waiter, worker->time);
+                waiter->wu_wait += waited;
+                if (waited > waiter->line_wait[waiter->pc]) waiter->line_wait[waiter->pc] = waited;
+                record(s, waiter, (event_t) { EVENT_WU, waiter->pc, arrival, waiter->time, c, w, from_event });
+                waiter->pc++;
+                waiter->state = RUNNING;
+                push(s, v);
+            }
+            return true;
+        }
+        case ADV:
+        case ADV2: {
+            size_t r = static_schedule_reactor_index(s->schedule, w, inst->rs1);
+            s->tags[r] += inst->rs2;
+            if (s->tags[r] > s->stop_time && !s->stopped[r]) {
+                s->stopped[r] = true;
+                s->reactors_remaining--;
+            }
+            worker->pc++;
+            return true;
+        }
+        case BIT:
+            if (worker->epoch >= s->stop_epoch || s->reactors_remaining == 0) {
+                if (worker->epoch < s->stop_epoch) {
+                    s->stop_epoch = worker->epoch;
+                    stop_waiters(s, worker->time);
+                }
+                worker->pc = inst->rs1;
+            } else {
+                worker->pc++;
+            }
+            return true;
+        case JMP:
+            if (inst->rs2 > 0) worker->iteration += inst->rs2;
+            if (worker->pc == worker->loop_end) worker->epoch++;
+            worker->pc = inst->rs1;
+            return true;
+        case SAC:
+            worker->state = AT_SAC;
+            if (++s->at_sac < s->num_workers) return false;
+            // The last to arrive releases everyone.
+            s->at_sac = 0;
+            size_t from_event = events_so_far(s, w);
+            for (size_t v = 0; v < s->num_workers; v++) {
+                worker_t* waiter = &s->workers[v];
+                long long int arrival = waiter->time;
+                waiter->sac_wait += wake(s, waiter, worker->time);
+                record(s, waiter, (event_t) { EVENT_SAC, waiter->pc, arrival, waiter->time, 0, w, from_event });
+                waiter->pc++;
+                waiter->state = RUNNING;
+                if (v != w) push(s, v);
+            }
+            return true;
+        case STP:
+            worker->state = FINISHED;
+            return false;
+        case ADDI:
+        case BEQ:
+        case BNE:
+        case BLT:
+        case SRV:
+            worker->pc = static_schedule_step(inst, worker->pc, worker->registers);
+            return true;
+        default:
+            fprintf(stderr, "Worker %zu, line %zu: cannot simulate opcode %d.\n", w, worker->pc, (int)inst->op);
+            exit(1);
+    }
+}
+
+/**
+ * @brief The most that the loops of the workers advance a reactor per pass.
+ *
+ * @param advance Set to how much they advance each reactor per pass.
+ */
+static long long int logical_hyperperiod(const static_schedule_t* schedule, long long int* advance,
+                                         size_t num_reactors) {
+    for (size_t w = 0; w < schedule->num_workers; w++) {
+        const inst_t* insts = schedule->schedules[w];
+        size_t end = static_schedule_loop_end(insts, schedule->schedule_lengths[w]);
+        if (end == STATIC_SCHEDULE_NO_LOOP) continue;
+        long long int registers[INST_NUM_REGISTERS] = { 0 };
+        size_t head = (size_t)insts[end].rs1;
+        bool in_loop = false;
+        size_t pc = 0;
+        for (size_t steps = 0; steps < 2 * STATIC_SCHEDULE_MAX_STEPS && !(in_loop && pc == end); steps++) {
+            if (pc == head) in_loop = true;
+            if (in_loop && (insts[pc].op == ADV || insts[pc].op == ADV2)) {
+                advance[static_schedule_reactor_index(schedule, w, insts[pc].rs1)] += insts[pc].rs2;
+            }
+            pc = static_schedule_step(&insts[pc], pc, registers);
+        }
+    }
+    long long int hyperperiod = 0;
+    for (size_t r = 0; r < num_reactors; r++) {
+        if (advance[r] > hyperperiod) hyperperiod = advance[r];
+    }
+    return hyperperiod;
+}
+
+/** The length of the program's array that a table or a count indexes. */
+static size_t table_extent(const uint32_t* table, size_t length) {
+    if (table == NULL) return length;
+    size_t extent = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (table[i] + (size_t)1 > extent) extent = table[i] + (size_t)1;
+    }
+    return extent;
+}
+
+/**
+ * @brief Set up a simulation. A reactor that the loops do not advance
+ * (`advance`) starts at the stop tag, as one without reactions does in the
+ * program; otherwise no worker would ever stop.
+ */
+static void init(simulation_t* s, const static_schedule_t* schedule, const model_t* model,
+                 const long long int* advance, size_t num_reactors, long long int stop_time, size_t trace_epoch) {
+    size_t n = schedule->num_workers, counters = schedule->num_counters;
+    *s = (simulation_t) {
+        .schedule = schedule,
+        .model = model,
+        .num_workers = n,
+        .workers = calloc(n, sizeof(worker_t)),
+        .heap = malloc(n * sizeof(size_t)),
+        .counters = calloc(counters + 1, sizeof(unsigned long long)),
+        .base = malloc((counters + 1) * sizeof(unsigned long long)),
+        .per_epoch = malloc((counters + 1) * sizeof(unsigned long long)),
+        .first_waiter = malloc((counters + 1) * sizeof(size_t)),
+        .tags = calloc(num_reactors + 1, sizeof(long long int)),
+        .stopped = calloc(num_reactors + 1, sizeof(bool)),
+        .num_reactors = num_reactors,
+        .reactors_remaining = num_reactors,
+        .stop_time = stop_time,
+        .stop_epoch = NONE,
+        .trigger_epoch = malloc((model->num_reactions + 1) * sizeof(size_t)),
+        .triggered = calloc(model->num_reactions + 1, sizeof(bool)),
+        .trace_epoch = trace_epoch,
+    };
+    if (s->workers == NULL || s->heap == NULL || s->counters == NULL || s->base == NULL || s->per_epoch == NULL
+            || s->first_waiter == NULL || s->tags == NULL || s->stopped == NULL || s->trigger_epoch == NULL
+            || s->triggered == NULL) {
+        fail("Out of memory");
+    }
+    static_schedule_counter_offsets(schedule, s->base, s->per_epoch);
+    for (size_t c = 0; c < counters; c++) s->first_waiter[c] = NONE;
+    for (size_t r = 0; r < num_reactors; r++) {
+        if (advance[r] > 0) continue;
+        s->stopped[r] = true;
+        s->reactors_remaining--;
+    }
+    for (size_t r = 0; r < model->num_reactions; r++) s->trigger_epoch[r] = NONE;
+    for (size_t w = 0; w < n; w++) {
+        worker_t* worker = &s->workers[w];
+        const inst_t* insts = schedule->schedules[w];
+        size_t length = schedule->schedule_lengths[w];
+        worker->random = model->seed * 0x9E3779B97F4A7C15ULL + w + 1;
+        if (worker->random == 0) worker->random = 1;
+        worker->loop_end = static_schedule_loop_end(insts, length);
+        worker->loop_head = worker->loop_end == STATIC_SCHEDULE_NO_LOOP ? length : (size_t)insts[worker->loop_end].rs1;
+        worker->loop_exit = NONE;
+        if (worker->loop_end != STATIC_SCHEDULE_NO_LOOP && insts[worker->loop_head].op == BIT) {
+            worker->loop_exit = insts[worker->loop_head].rs1;
+        }
+        worker->line_wait = calloc(length + 1, sizeof(long long int));
+        if (worker->line_wait == NULL) fail("Out of memory");
+        push(s, w);
+    }
+}
+
+static void release(simulation_t* s) {
+    for (size_t w = 0; w < s->num_workers; w++) {
+        free(s->workers[w].line_wait);
+        free(s->workers[w].events);
+    }
+    free(s->workers);
+    free(s->heap);
+    free(s->counters);
+    free(s->base);
+    free(s->per_epoch);
+    free(s->first_waiter);
+    free(s->tags);
+    free(s->stopped);
+    free(s->trigger_epoch);
+    free(s->triggered);
+    free(s->first_start);
+    free(s->last_end);
+    free(s->last_worker);
+}
+
+/**
+ * @brief Run the workers until none can go on.
+ *
+ * @return Whether all of them finished.
+ */
+static bool run(simulation_t* s) {
+    while (s->heap_size > 0) {
+        size_t w = pop(s);
+        worker_t* worker = &s->workers[w];
+        // Run the worker for as long as it is the earliest.
+        while (step(s, w)) {
+            if (worker->pc >= s->schedule->schedule_lengths[w]) {
+                fprintf(stderr, "Worker %zu runs past the end of its schedule.\n", w);
+                return false;
+            }
+            if (s->heap_size > 0 && earlier(s, s->heap[0], w)) {
+                push(s, w);
+                break;
+            }
+        }
+    }
+    bool finished = true;
+    for (size_t w = 0; w < s->num_workers; w++) {
+        if (s->workers[w].state != FINISHED) {
+            fprintf(stderr, "Worker %zu is stuck at line %zu in %s.\n", w, s->workers[w].pc,
+                    s->workers[w].state == AT_SAC ? "SAC" : "WU");
+            finished = false;
+        }
+    }
+    return finished;
+}
+
+///////////////////////////// Report /////////////////////////////
+
+static const char* const event_names[] = {
+    [EVENT_REACTION]    = "reaction",
+    [EVENT_WU]          = "WU",
+    [EVENT_DU]          = "DU",
+    [EVENT_SAC]         = "SAC",
+};
+
+/**
+ * @brief Print the critical path of the traced epoch: from its last
+ * reaction, follow back what each worker waited for.
+ */
+static void print_critical_path(const simulation_t* s, size_t epoch) {
+    size_t w = s->last_worker[epoch];
+    size_t i = s->workers[w].num_events;
+    // Collect the steps last to first, then print them first to last.
+    event_t* path = NULL;
+    size_t* path_workers = NULL;
+    size_t length = 0, capacity = 0, workers_capacity = 0;
+    const char* origin = "the start of the hyperperiod";
+    // Each step goes back to an event recorded earlier, so this ends.
+    while (i-- > 0) {
+        const event_t* event = &s->workers[w].events[i];
+        bool waited = event->end > event->start;
+        if (event->kind != EVENT_REACTION && !waited) continue;
+        path = grow(path, &capacity, length + 1, sizeof(event_t));
+        path_workers = grow(path_workers, &workers_capacity, length + 1, sizeof(size_t));
+        path[length] = *event;
+        path_workers[length++] = w;
+        if (event->kind == EVENT_DU) {
+            origin = "a DU release";
+            break;
+        }
+        if (event->from_worker != NONE && event->from_worker != w) {
+            // Go on with what the worker that let this one go did before.
+            w = event->from_worker;
+            i = event->from_event;
+            if (i == 0) origin = "the previous hyperperiod";
+        }
+    }
+    printf("critical path of hyperperiod %zu, from %s:\n", epoch, origin);
+    for (size_t k = length; k-- > 0;) {
+        const event_t* event = &path[k];
+        switch (event->kind) {
+            case EVENT_REACTION:
+                printf("  worker %zu line %zu: reaction %zu from %lld to %lld ns\n", path_workers[k], event->line,
+                       event->what, event->start, event->end);
+                break;
+            case EVENT_DU:
+                printf("  worker %zu line %zu: DU released at %lld ns\n", path_workers[k], event->line, event->end);
+                break;
+            case EVENT_WU:
+                printf("  worker %zu line %zu: WU on counter %zu waited for worker %zu until %lld ns\n",
+                       path_workers[k], event->line, event->what, event->from_worker, event->end);
+                break;
+            case EVENT_SAC:
+                printf("  worker %zu line %zu: SAC waited for worker %zu until %lld ns\n", path_workers[k],
+                       event->line, event->from_worker, event->end);
+                break;
+        }
+    }
+    free(path);
+    free(path_workers);
+}
+
+static int write_timeline(const char* path, const simulation_t* s, size_t epoch) {
+    FILE* out = fopen(path, "w");
+    if (out == NULL) return -1;
+    fprintf(out, "hyperperiod,worker,line,event,start_ns,end_ns,reaction_or_counter,woken_by\n");
+    for (size_t w = 0; w < s->num_workers; w++) {
+        const worker_t* worker = &s->workers[w];
+        for (size_t i = 0; i < worker->num_events; i++) {
+            const event_t* event = &worker->events[i];
+            if (event->kind == EVENT_DU) {
+                fprintf(out, "%zu,%zu,%zu,DU,%lld,%lld,,\n", epoch, w, event->line, event->start, event->end);
+                continue;
+            }
+            fprintf(out, "%zu,%zu,%zu,%s,%lld,%lld,", epoch, w, event->line, event_names[event->kind],
+                    event->start, event->end);
+            if (event->kind != EVENT_SAC) fprintf(out, "%zu", event->what);
+            fprintf(out, ",");
+            if (event->from_worker != NONE) fprintf(out, "%zu", event->from_worker);
+            fprintf(out, "\n");
+        }
+    }
+    return fclose(out);
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 3 || argc > 5) {
+        fprintf(stderr, "Usage: %s <schedule file> <model file> [hyperperiods] [timeline file]\n", argv[0]);
+        return 1;
+    }
+    size_t hyperperiods = argc > 3 ? strtoull(argv[3], NULL, 10) : 1000;
+    if (hyperperiods == 0) fail("There must be at least one hyperperiod");
+
+    static_schedule_t schedule;
+    const char* error;
+    if (static_schedule_map(argv[1], &schedule, &error) != 0) {
+        fprintf(stderr, "Cannot load %s: %s.\n", argv[1], error);
+        return 1;
+    }
+    if (static_schedule_verify(&schedule, 0, 0, static_schedule_print_problem, (void*)argv[1]) != 0) {
+        fprintf(stderr, "%s: the schedules do not verify.\n", argv[1]);
+        return 1;
+    }
+    size_t num_reactions = table_extent(schedule.reaction_table, schedule.num_reactions);
+    size_t num_reactors = table_extent(schedule.reactor_table, schedule.num_reactors);
+    model_t model;
+    read_model(argv[2], num_reactions, &model);
+    long long int* advance = calloc(num_reactors + 1, sizeof(long long int));
+    if (advance == NULL) fail("Out of memory");
+    long long int hyperperiod = logical_hyperperiod(&schedule, advance, num_reactors);
+    if (hyperperiod <= 0) fail("The loops of the workers do not advance any reactor, so they never stop");
+    if ((long long int)hyperperiods > INT64_MAX / 2 / hyperperiod) fail("Too many hyperperiods");
+    long long int stop_time = (long long int)hyperperiods * hyperperiod - 1;
+
+    struct timespec begin, end;
+    clock_gettime(CLOCK_MONOTONIC, &begin);
+    simulation_t s;
+    init(&s, &schedule, &model, advance, num_reactors, stop_time, NONE);
+    bool finished = run(&s);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed_ms = (end.tv_sec - begin.tv_sec) * 1e3 + (end.tv_nsec - begin.tv_nsec) / 1e6;
+    if (!finished) return 1;
+
+    long long int total = 0;
+    for (size_t w = 0; w < s.num_workers; w++) {
+        if (s.workers[w].time > total) total = s.workers[w].time;
+    }
+    size_t measured = s.num_epochs < hyperperiods ? s.num_epochs : hyperperiods;
+    size_t worst = NONE;
+    double sum = 0;
+    for (size_t e = 0; e < measured; e++) {
+        if (s.last_end[e] < s.first_start[e]) continue;
+        long long int makespan = s.last_end[e] - s.first_start[e];
+        sum += makespan;
+        if (worst == NONE || makespan > s.last_end[worst] - s.first_start[worst]) worst = e;
+    }
+    size_t wu_worker = NONE, wu_line = 0;
+    long long int wu_max = 0;
+    for (size_t w = 0; w < s.num_workers; w++) {
+        for (size_t pc = 0; pc < schedule.schedule_lengths[w]; pc++) {
+            if (s.workers[w].line_wait[pc] > wu_max) {
+                wu_max = s.workers[w].line_wait[pc];
+                wu_worker = w;
+                wu_line = pc;
+            }
+        }
+    }
+
+    printf("workers=%zu hyperperiods=%zu hyperperiod_ns=%lld makespan_mean_ns=%.0f makespan_max_ns=%lld "
+           "du_releases=%zu du_late=%zu du_max_lateness_ns=%lld wu_max_wait_ns=%lld simulate_ms=%.3f "
+           "hyperperiods_per_s=%.0f\n", s.num_workers, hyperperiods, hyperperiod, measured > 0 ? sum / measured : 0,
+           worst != NONE ? s.last_end[worst] - s.first_start[worst] : 0, s.releases, s.late, s.max_lateness, wu_max,
+           elapsed_ms, elapsed_ms > 0 ? s.num_epochs / (elapsed_ms / 1e3) : 0);
+    for (size_t w = 0; w < s.num_workers; w++) {
+        const worker_t* worker = &s.workers[w];
+        printf("worker %zu: utilization=%.3f reactions=%zu busy_ns=%lld wu_wait_ns=%lld du_idle_ns=%lld "
+               "sac_wait_ns=%lld\n", w, total > 0 ? (double)worker->busy / total : 0, worker->reactions,
+               worker->busy, worker->wu_wait, worker->du_idle, worker->sac_wait);
+    }
+    if (wu_worker != NONE) {
+        printf("longest WU wait: worker %zu line %zu, %lld ns\n", wu_worker, wu_line, wu_max);
+    }
+    if (s.late > 0) {
+        printf("latest DU: worker %zu line %zu, %lld ns after its release\n", s.late_worker, s.late_line,
+               s.max_lateness);
+    }
+    int status = s.late > 0 ? 2 : 0;
+    release(&s);
+
+    // Run again, recording the hyperperiod with the longest makespan. The
+    // draws are the same, so the run is.
+    if (worst != NONE) {
+        init(&s, &schedule, &model, advance, num_reactors, stop_time, worst);
+        run(&s);
+        print_critical_path(&s, worst);
+        if (argc > 4 && write_timeline(argv[4], &s, worst) != 0) {
+            fprintf(stderr, "Cannot write %s.\n", argv[4]);
+            status = 1;
+        }
+        release(&s);
+    }
+    free(advance);
+    free(model.wcet);
+    free(model.trigger);
+    free(model.inactive);
+    static_schedule_unmap(&schedule);
+    return status;
+}
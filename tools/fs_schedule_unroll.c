@@ -0,0 +1,78 @@
+/**
+ * @file fs_schedule_unroll.c
+ * @brief Unroll the hyperperiod of a schedule file.
+ *
+ * Writes the schedules of the input file with their hyperperiod unrolled
+ * (see static_schedule_unroll.h) and verifies the result. The factor is
+ * either given or, with `auto`, chosen from a measurement of the schedule:
+ * the time per hyperperiod that the workers spend in SAC, JMP, and BIT, and
+ * the total time per hyperperiod, both in nanoseconds, e.g., from a run with
+ * the FS_PROFILE build.
+ *
+ * Usage: fs_schedule_unroll <input file> <output file> <factor>
+ *        fs_schedule_unroll <input file> <output file> auto <barrier ns> <hyperperiod ns>
+ *                           [max overhead] [max instructions]
+ */
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "static_schedule_file.h"
+#include "static_schedule_unroll.h"
+#include "static_schedule_verify.h"
+
+static int usage(const char* name) {
+    fprintf(stderr, "Usage: %s <input file> <output file> <factor>\n", name);
+    fprintf(stderr, "       %s <input file> <output file> auto <barrier ns> <hyperperiod ns> "
+                    "[max overhead] [max instructions]\n", name);
+    return 1;
+}
+
+int main(int argc, const char* argv[]) {
+    if (argc < 4) return usage(argv[0]);
+    bool automatic = strcmp(argv[3], "auto") == 0;
+    if ((automatic && (argc < 6 || argc > 8)) || (!automatic && argc != 4)) return usage(argv[0]);
+
+    static_schedule_t schedule;
+    const char* error;
+    if (static_schedule_map(argv[1], &schedule, &error) != 0) {
+        fprintf(stderr, "Cannot load %s: %s.\n", argv[1], error);
+        return 1;
+    }
+
+    size_t factor;
+    if (automatic) {
+        static_schedule_unroll_profile_t profile = {
+            .barrier_ns = strtod(argv[4], NULL),
+            .hyperperiod_ns = strtod(argv[5], NULL),
+            .max_overhead = argc > 6 ? strtod(argv[6], NULL) : 0,
+            .max_instructions = argc > 7 ? strtoull(argv[7], NULL, 10) : 0,
+        };
+        factor = static_schedule_choose_unroll_factor(&schedule, &profile);
+        printf("Unrolling %s %zu times.\n", argv[1], factor);
+    } else {
+        factor = strtoull(argv[3], NULL, 10);
+        if (factor == 0) return usage(argv[0]);
+    }
+
+    static_schedule_t unrolled;
+    if (static_schedule_unroll(&schedule, factor, &unrolled, &error) != 0) {
+        fprintf(stderr, "Cannot unroll %s: %s.\n", argv[1], error);
+        static_schedule_unmap(&schedule);
+        return 1;
+    }
+
+    int status = 0;
+    int problems = static_schedule_verify(&unrolled, 0, 0, static_schedule_print_problem, (void*)argv[2]);
+    if (problems > 0) {
+        fprintf(stderr, "%s: %d problem(s) after unrolling.\n", argv[2], problems);
+        status = 1;
+    } else if (static_schedule_write(argv[2], &unrolled, &error) != 0) {
+        fprintf(stderr, "Cannot write %s: %s.\n", argv[2], error);
+        status = 1;
+    }
+    static_schedule_unroll_free(&unrolled);
+    static_schedule_unmap(&schedule);
+    return status;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file fs_schedule_verify.c
+ * @brief Verify schedule files before they are given to a program.
+ *
+ * Runs the same checks as the FS scheduler does at startup (see
+ * static_schedule_verify.h). The sizes of the program's reaction and reactor
+ * arrays are not known here, so reaction and reactor operands are only
+ * checked against the tables in the file.
+ *
+ * Usage: fs_schedule_verify <schedule file>...
+ *
+ * Exits with status 1 if any file cannot be read or has problems.
+ */
+#include <stdio.h>
+
+#include "static_schedule_file.h"
+#include "static_schedule_verify.h"
+
+int main(int argc, const char* argv[]) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s <schedule file>...\n", argv[0]);
+        return 1;
+    }
+
+    int status = 0;
+    for (int i = 1; i < argc; i++) {
+        static_schedule_t schedule;
+        const char* error;
+        if (static_schedule_map(argv[i], &schedule, &error) != 0) {
+            fprintf(stderr, "Cannot load %s: %s.\n", argv[i], error);
+            status = 1;
+            continue;
+        }
+        int problems = static_schedule_verify(&schedule, 0, 0, static_schedule_print_problem, (void*)argv[i]);
+        if (problems > 0) {
+            fprintf(stderr, "%s: %d problem(s).\n", argv[i], problems);
+            status = 1;
+        }
+        static_schedule_unmap(&schedule);
+    }
+    return status;
+}